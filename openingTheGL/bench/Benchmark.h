@@ -0,0 +1,257 @@
+#pragma once
+//A small harness for the benchmarks that want statistics and machine readable results instead of a single timing
+//
+//Every benchmark is timed as a number of samples (repetitions), each sample runs the body as many times as it takes
+//to last at least --min-sample-ms, so fast bodies aren't lost in timer resolution. The runs that find that count warm caches up and are thrown away.
+//Results are printed as a table and can be written as JSON (min, median, mean, standard deviation, p95, max in ns per iteration),
+//to compare runs against each other and catch regressions.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Benchmark {
+
+	//keeps the compiler from throwing away a result that is never used
+#if defined(__GNUC__)
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+#else
+	inline void UseCharPointer(const volatile char*) {}
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+		UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+		_ReadWriteBarrier();
+	}
+#endif
+
+	struct Result
+	{
+		std::string Group;
+		std::string Name;
+		//body runs per sample
+		unsigned long long Iterations;
+		//work items per body run (draws, quads, bytes, ...), for the throughput column, 0 for none
+		double Items;
+		std::string ItemName;
+		//ns per body run
+		std::vector<double> Samples;
+		double Min, Median, Mean, StdDev, P95, Max;
+	};
+
+	class Runner
+	{
+	public:
+		//usage: benchmark [--json file] [--filter text] [--repetitions N] [--min-sample-ms N]
+		Runner(int argc, char** argv)
+			: m_Repetitions(15), m_MinSampleMs(5.0)
+		{
+			for (int i = 1; i < argc; i++)
+			{
+				std::string argument = argv[i];
+				bool hasValue = i + 1 < argc;
+				if (argument == "--json" && hasValue)
+					m_JsonPath = argv[++i];
+				else if (argument == "--filter" && hasValue)
+					m_Filter = argv[++i];
+				else if (argument == "--repetitions" && hasValue)
+					m_Repetitions = std::max(1, atoi(argv[++i]));
+				else if (argument == "--min-sample-ms" && hasValue)
+					m_MinSampleMs = atof(argv[++i]);
+				else
+					std::cout << "Unknown option " << argument << '\n';
+			}
+
+			std::cout << std::left << std::setw(GroupWidth) << "group" << ' ' << std::setw(44) << "benchmark" << std::right << std::setw(12) << "median"
+				<< std::setw(12) << "mean" << std::setw(10) << "stddev" << std::setw(12) << "min" << std::setw(12) << "p95" << "  throughput\n";
+		}
+
+		//extra key/value pairs for the "context" of the JSON, the GL renderer for example
+		void AddContext(const std::string& key, const std::string& value) { m_Context.push_back({ key, value }); }
+
+		//body() is one iteration, sync() (optional) runs at the end of every sample, for example glFinish so the GPU work is counted
+		template<typename Body, typename Sync>
+		void Run(const std::string& group, const std::string& name, double items, const std::string& itemName, Body&& body, Sync&& sync)
+		{
+			if (!m_Filter.empty() && (group + "/" + name).find(m_Filter) == std::string::npos)
+				return;
+
+			Result result{};
+			result.Group = group;
+			result.Name = name;
+			result.Iterations = 1;
+			result.Items = items;
+			result.ItemName = itemName;
+
+			//find an iteration count that makes a sample long enough to time, this is also the warm up
+			while (true)
+			{
+				double ms = Time(result.Iterations, body, sync) / 1e6 * result.Iterations;
+				if (ms >= m_MinSampleMs || result.Iterations >= (1ull << 30))
+					break;
+				result.Iterations *= ms > 0.0 ? std::max(2ull, std::min(100ull, (unsigned long long)(m_MinSampleMs / ms) + 1)) : 100ull;
+			}
+
+			for (int i = 0; i < m_Repetitions; i++)
+				result.Samples.push_back(Time(result.Iterations, body, sync));
+
+			Summarize(result);
+			Print(result);
+			m_Results.push_back(result);
+		}
+
+		template<typename Body>
+		void Run(const std::string& group, const std::string& name, double items, const std::string& itemName, Body&& body)
+		{
+			Run(group, name, items, itemName, body, []() {});
+		}
+
+		template<typename Body, typename Sync>
+		void Run(const std::string& group, const std::string& name, Body&& body, Sync&& sync)
+		{
+			Run(group, name, 0.0, "", body, sync);
+		}
+
+		template<typename Body>
+		void Run(const std::string& group, const std::string& name, Body&& body)
+		{
+			Run(group, name, 0.0, "", body, []() {});
+		}
+
+		//the benchmarks run so far, the last one at the back (a filtered out Run adds nothing)
+		inline const std::vector<Result>& GetResults() const { return m_Results; }
+
+		//writes the JSON if --json was given, returns the exit code for main
+		int Finish() const
+		{
+			if (m_JsonPath.empty())
+				return 0;
+
+			std::ofstream stream(m_JsonPath);
+			if (!stream)
+			{
+				std::cout << "Could not write " << m_JsonPath << '\n';
+				return 1;
+			}
+
+			stream << std::setprecision(10) << "{\n  \"context\": {\n";
+			stream << "    \"repetitions\": " << m_Repetitions << ",\n    \"min_sample_ms\": " << m_MinSampleMs;
+			for (const auto& entry : m_Context)
+				stream << ",\n    \"" << Escape(entry.first) << "\": \"" << Escape(entry.second) << "\"";
+			stream << "\n  },\n  \"benchmarks\": [";
+
+			for (size_t i = 0; i < m_Results.size(); i++)
+			{
+				const Result& result = m_Results[i];
+				stream << (i > 0 ? ",\n" : "\n") << "    {\"group\": \"" << Escape(result.Group) << "\", \"name\": \"" << Escape(result.Name)
+					<< "\", \"unit\": \"ns\", \"iterations\": " << result.Iterations << ", \"repetitions\": " << result.Samples.size()
+					<< ", \"min\": " << result.Min << ", \"median\": " << result.Median << ", \"mean\": " << result.Mean
+					<< ", \"stddev\": " << result.StdDev << ", \"p95\": " << result.P95 << ", \"max\": " << result.Max;
+				if (result.Items > 0.0)
+					stream << ", \"items\": " << result.Items << ", \"item_name\": \"" << Escape(result.ItemName)
+					<< "\", \"items_per_second\": " << result.Items / result.Median * 1e9;
+				stream << "}";
+			}
+			stream << "\n  ]\n}\n";
+			std::cout << "Wrote " << m_JsonPath << '\n';
+			return stream ? 0 : 1;
+		}
+
+	private:
+		//the longest groups ("particles", "debugdraw") are 9 characters, a longer one is still kept apart by the space after it
+		static const int GroupWidth = 10;
+
+		int m_Repetitions;
+		double m_MinSampleMs;
+		std::string m_JsonPath;
+		std::string m_Filter;
+		std::vector<std::pair<std::string, std::string>> m_Context;
+		std::vector<Result> m_Results;
+
+		//ns per iteration
+		template<typename Body, typename Sync>
+		static double Time(unsigned long long iterations, Body& body, Sync& sync)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned long long i = 0; i < iterations; i++)
+				body();
+			sync();
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+		}
+
+		static void Summarize(Result& result)
+		{
+			std::vector<double> sorted = result.Samples;
+			std::sort(sorted.begin(), sorted.end());
+			size_t count = sorted.size();
+
+			result.Min = sorted.front();
+			result.Max = sorted.back();
+			result.Median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5;
+			//nearest rank
+			result.P95 = sorted[std::min(count - 1, (size_t)std::ceil(count * 0.95) - 1)];
+
+			double sum = 0.0;
+			for (double sample : sorted)
+				sum += sample;
+			result.Mean = sum / count;
+
+			double squares = 0.0;
+			for (double sample : sorted)
+				squares += (sample - result.Mean) * (sample - result.Mean);
+			result.StdDev = count > 1 ? std::sqrt(squares / (count - 1)) : 0.0;
+		}
+
+		//ns, us or ms, whichever keeps the number readable
+		static std::string FormatTime(double ns)
+		{
+			char text[32];
+			if (ns < 1e3)
+				snprintf(text, sizeof(text), "%.1f ns", ns);
+			else if (ns < 1e6)
+				snprintf(text, sizeof(text), "%.2f us", ns / 1e3);
+			else
+				snprintf(text, sizeof(text), "%.2f ms", ns / 1e6);
+			return text;
+		}
+
+		static void Print(const Result& result)
+		{
+			std::cout << std::left << std::setw(GroupWidth) << result.Group << ' ' << std::setw(44) << result.Name << std::right
+				<< std::setw(12) << FormatTime(result.Median) << std::setw(12) << FormatTime(result.Mean)
+				<< std::setw(9) << std::fixed << std::setprecision(1) << (result.Mean > 0.0 ? result.StdDev / result.Mean * 100.0 : 0.0) << "%"
+				<< std::setw(12) << FormatTime(result.Min) << std::setw(12) << FormatTime(result.P95);
+			if (result.Items > 0.0)
+				std::cout << "  " << std::setprecision(2) << result.Items / result.Median * 1e3 << " M" << result.ItemName << "/s";
+			std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+		}
+
+		static std::string Escape(const std::string& text)
+		{
+			std::string escaped;
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\')
+					escaped += '\\';
+				if ((unsigned char)c >= 0x20)
+					escaped += c;
+			}
+			return escaped;
+		}
+	};
+
+}
@@ -0,0 +1,96 @@
+//Frustum culling benchmark: Bvh (SIMD) against testing every object with the scalar Frustum::Intersects
+//Scales the scene from 1k to 1M objects, and measures the incremental refit when a part of the scene moves
+//
+//Not part of the application project (it has its own main), build it on its own, for example:
+//g++ -O2 -mavx -std=c++17 -I../src -I../src/vendor BvhCullingBenchmark.cpp ../src/Bvh.cpp -o BvhCullingBenchmark
+//cl /O2 /arch:AVX /std:c++17 /EHsc /I..\src /I..\src\vendor BvhCullingBenchmark.cpp ..\src\Bvh.cpp
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "Bvh.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main()
+{
+	const float worldSize = 2000.0f;
+	const int cullRuns = 20;
+
+	//a camera in the middle of the world looking down -z, sees roughly 1/8th of it
+	glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, worldSize);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum(proj * view);
+
+	std::cout << std::left << std::setw(10) << "objects" << std::setw(10) << "visible" << std::setw(12) << "build ms"
+		<< std::setw(14) << "bvh cull ms" << std::setw(16) << "brute force ms" << std::setw(10) << "speedup"
+		<< std::setw(22) << "refit (10% moved) ms" << std::endl;
+
+	for (unsigned int count = 1000; count <= 1000000; count *= 10)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> position(-worldSize * 0.5f, worldSize * 0.5f);
+		std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+		std::vector<BoundingBox> bounds(count);
+		for (auto& box : bounds)
+		{
+			glm::vec3 center(position(rng), position(rng), position(rng));
+			glm::vec3 extents(size(rng), size(rng), size(rng));
+			box = BoundingBox(center - extents, center + extents);
+		}
+
+		Bvh bvh;
+		auto start = Clock::now();
+		bvh.Build(bounds);
+		double buildMs = ElapsedMs(start);
+
+		std::vector<unsigned int> visible;
+		visible.reserve(count);
+		start = Clock::now();
+		for (int run = 0; run < cullRuns; run++)
+			bvh.Cull(frustum, visible);
+		double cullMs = ElapsedMs(start) / cullRuns;
+
+		std::vector<unsigned int> bruteVisible;
+		bruteVisible.reserve(count);
+		start = Clock::now();
+		for (int run = 0; run < cullRuns; run++)
+		{
+			bruteVisible.clear();
+			for (unsigned int i = 0; i < count; i++)
+				if (frustum.Intersects(bounds[i]))
+					bruteVisible.push_back(i);
+		}
+		double bruteMs = ElapsedMs(start) / cullRuns;
+
+		if (visible.size() != bruteVisible.size())
+			std::cout << "mismatch! bvh found " << visible.size() << " brute force found " << bruteVisible.size() << std::endl;
+
+		//move every 10th object a little, like a frame of simulation would
+		std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+		start = Clock::now();
+		for (unsigned int i = 0; i < count; i += 10)
+		{
+			glm::vec3 offset(step(rng), step(rng), step(rng));
+			bvh.Update(i, BoundingBox(bounds[i].Min + offset, bounds[i].Max + offset));
+		}
+		bvh.Refit();
+		double refitMs = ElapsedMs(start);
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(10) << count << std::setw(10) << visible.size() << std::setw(12) << buildMs
+			<< std::setw(14) << cullMs << std::setw(16) << bruteMs << std::setw(10) << bruteMs / cullMs
+			<< std::setw(22) << refitMs << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,139 @@
+//Debug draw benchmark: DebugDraw on a headless context with a perspective camera over a grid of 100k objects
+//record: the bounds of all 100k objects as boxes, CPU only
+//flush: the same boxes recorded and drawn (two draw calls), every sample ends with glFinish
+//per shape buffers: 10k boxes the way it was done before DebugDraw, a vertex buffer + vertex array per box and a draw call each,
+//against DebugDraw with the same 10k boxes
+//shapes: 10k spheres, 10k arrows and 1k labels recorded and drawn, the mix a debugging session has on screen
+//
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "DebugDraw.h"
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	auto finish = []() { glFinish(); };
+
+	//a 316 x 316 grid of unit boxes on the ground, seen from above one corner
+	const unsigned int side = 316;
+	std::vector<BoundingBox> bounds;
+	for (unsigned int z = 0; z < side; z++)
+		for (unsigned int x = 0; x < side; x++)
+			bounds.push_back(BoundingBox(glm::vec3(x * 2.0f, 0.0f, z * 2.0f), glm::vec3(x * 2.0f + 1.0f, 1.0f + (x * 7 + z * 3) % 5, z * 2.0f + 1.0f)));
+
+	glm::mat4 proj = glm::perspective(glm::radians(60.0f), (float)Width / Height, 0.5f, 2000.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(-40.0f, 120.0f, -40.0f), glm::vec3(side, 0.0f, side), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 viewProjection = proj * view;
+	glm::vec2 viewport((float)Width, (float)Height);
+
+	{
+		DebugDraw debug;
+		Renderer renderer;
+		glm::vec4 color(0.2f, 1.0f, 0.4f, 1.0f);
+		std::string objects = std::to_string(bounds.size() / 1000) + "k boxes";
+
+		runner.Run("debugdraw", "Record " + objects, (double)bounds.size(), "box", [&]() {
+			debug.Clear();
+			for (const BoundingBox& box : bounds)
+				debug.Box(box, color);
+		});
+		debug.Clear();
+
+		runner.Run("debugdraw", "Record + flush " + objects, (double)bounds.size(), "box", [&]() {
+			renderer.Clear();
+			for (const BoundingBox& box : bounds)
+				debug.Box(box, color);
+			debug.Flush(viewProjection, viewport);
+		}, finish);
+		std::cout << "        " << debug.GetLineCount() << " lines in 2 draw calls\n";
+
+		{
+			//the corners of every box, drawn as GL_LINES with the edge order of DebugDraw::Box
+			static const unsigned char edges[24] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 2, 1, 3, 4, 6, 5, 7, 0, 4, 1, 5, 2, 6, 3, 7 };
+			const unsigned int count = 10000;
+			std::vector<std::unique_ptr<VertexBuffer>> buffers;
+			std::vector<std::unique_ptr<VertexArray>> arrays;
+			VertexBufferLayout layout;
+			layout.Push<float>(3);
+			for (unsigned int i = 0; i < count; i++)
+			{
+				const BoundingBox& box = bounds[i];
+				float vertices[24 * 3];
+				for (unsigned int j = 0; j < 24; j++)
+				{
+					vertices[j * 3 + 0] = edges[j] & 1 ? box.Max.x : box.Min.x;
+					vertices[j * 3 + 1] = edges[j] & 2 ? box.Max.y : box.Min.y;
+					vertices[j * 3 + 2] = edges[j] & 4 ? box.Max.z : box.Min.z;
+				}
+				buffers.push_back(std::make_unique<VertexBuffer>(vertices, (unsigned int)sizeof(vertices)));
+				arrays.push_back(std::make_unique<VertexArray>());
+				arrays.back()->AddBuffer(*buffers.back(), layout);
+			}
+			Shader shader("res/shaders/DebugDraw.shader");
+
+			runner.Run("debugdraw", "Per shape buffers, 10k boxes", (double)count, "box", [&]() {
+				renderer.Clear();
+				shader.Bind();
+				shader.SetUniformMat4f("u_ViewProjection", viewProjection);
+				shader.SetUniform2f("u_ViewportSize", viewport.x, viewport.y);
+				GLCall(glVertexAttrib4f(2, color.r, color.g, color.b, color.a));
+				for (unsigned int i = 0; i < count; i++)
+				{
+					arrays[i]->Bind();
+					GLCall(glDrawArrays(GL_LINES, 0, 24));
+				}
+			}, finish);
+
+			runner.Run("debugdraw", "Record + flush 10k boxes", (double)count, "box", [&]() {
+				renderer.Clear();
+				for (unsigned int i = 0; i < count; i++)
+					debug.Box(bounds[i], color);
+				debug.Flush(viewProjection, viewport);
+			}, finish);
+		}
+
+		runner.Run("debugdraw", "Record + flush 10k spheres, 10k arrows, 1k labels", [&]() {
+			renderer.Clear();
+			for (unsigned int i = 0; i < 10000; i++)
+			{
+				glm::vec3 center = bounds[i * 10].GetCenter();
+				debug.Sphere(center, 0.5f, glm::vec4(1.0f, 0.6f, 0.2f, 1.0f));
+				debug.Arrow(center, center + glm::vec3(0.0f, 2.0f, 0.0f), glm::vec4(0.3f, 0.6f, 1.0f, 1.0f));
+			}
+			for (unsigned int i = 0; i < 1000; i++)
+				debug.Label(bounds[i * 100].Max, "object " + std::to_string(i * 100));
+			debug.Flush(viewProjection, viewport);
+		}, finish);
+		std::cout << "        " << debug.GetLineCount() << " lines in 2 draw calls\n";
+	}
+	return runner.Finish();
+}
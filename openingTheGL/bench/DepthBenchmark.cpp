@@ -0,0 +1,195 @@
+//Depth benchmark: Renderer::Submit on an overdraw heavy scene on a headless context, every sample ends with glFinish
+//the scene is 64 opaque quads of two thirds of the screen each stacked at different depths (about 30x overdraw in the middle)
+//and 8 transparent ones in front of them, drawn through CommandLists:
+//no depth test: painter's order, far to near, every fragment is shaded
+//depth test: opaque submitted far to near (the worst order) and near to far (the order MakeSortKey gives)
+//depth pre-pass: both orders again with the depth of the opaque quads laid down first
+//Next to every row the fragment shader invocations of one frame, from a GL_FRAGMENT_SHADER_INVOCATIONS query
+//(ARB_pipeline_statistics_query), and the samples that passed the depth test (GL_SAMPLES_PASSED) with how many of those
+//the mode saved against no depth test. Drivers may count invocations before the early depth test throws fragments away
+//(llvmpipe does, the pre-pass even adds to them), the samples passed are what is left to shade with early-Z.
+//The pre-pass rows count the color pass only: the pre-pass on its own (the opaque quads with color writes off) is counted
+//the same way and taken off.
+//
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "IndexBuffer.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+static const unsigned int OpaqueCount = 64;
+static const unsigned int TransparentCount = 8;
+
+struct Counts
+{
+	//0 without ARB_pipeline_statistics_query
+	unsigned long long Invocations;
+	unsigned long long SamplesPassed;
+};
+
+//of one Submit
+static Counts Count(Renderer& renderer, const std::vector<CommandList>& lists)
+{
+	bool statistics = GLEW_ARB_pipeline_statistics_query != 0;
+	unsigned int queries[2];
+	GLCall(glGenQueries(2, queries));
+	renderer.Clear();
+	if (statistics)
+		GLCall(glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, queries[0]));
+	GLCall(glBeginQuery(GL_SAMPLES_PASSED, queries[1]));
+	renderer.Submit(lists);
+	GLCall(glEndQuery(GL_SAMPLES_PASSED));
+	if (statistics)
+		GLCall(glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB));
+
+	GLuint64 invocations = 0, samples = 0;
+	if (statistics)
+		GLCall(glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &invocations));
+	GLCall(glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &samples));
+	GLCall(glDeleteQueries(2, queries));
+	return { invocations, samples };
+}
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+	if (!GLEW_ARB_pipeline_statistics_query)
+		std::cout << "No ARB_pipeline_statistics_query, fragment shader invocations aren't counted\n";
+
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	auto finish = []() { glFinish(); };
+
+	{
+		//a unit quad around the origin, every quad is a model matrix on it
+		float positions[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+		VertexArray va;
+		VertexBuffer vb(positions, sizeof(positions));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		va.AddBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		Shader shader("res/shaders/Basic.shader");
+		shader.Bind();
+		Texture texture("res/textures/screen.png");
+		texture.Bind(0);
+		shader.SetUniform1i("u_Texture", 0);
+		int mvpLocation = shader.GetUniformLocation("u_MVP");
+
+		//depth 0 is the near plane, the opaque quads go from near to far, the transparent ones are in front of all of them
+		glm::mat4 proj = glm::ortho(0.0f, (float)Width, 0.0f, (float)Height, 0.0f, 1.0f);
+		auto model = [](unsigned int i, unsigned int count, float depth) {
+			float x = Width * (0.35f + 0.3f * i / count), y = Height * (0.35f + 0.3f * (i * 7 % count) / count);
+			glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, -depth));
+			return glm::scale(translation, glm::vec3(Width * 0.66f, Height * 0.66f, 1.0f));
+		};
+
+		//nearToFar false records the opaque keys with their depth flipped, so they are submitted far to near
+		auto record = [&](std::vector<CommandList>& lists, bool nearToFar, bool transparent) {
+			lists.resize(1);
+			CommandList& list = lists[0];
+			list.Clear();
+			for (unsigned int i = 0; i < OpaqueCount; i++)
+			{
+				float depth = 0.1f + 0.8f * i / OpaqueCount;
+				list.SetUniformMat4f(mvpLocation, proj * model(i, OpaqueCount, depth));
+				list.Draw(CommandList::MakeSortKey(0, shader.GetRendererID(), va.GetRendererID(), nearToFar ? depth : 1.0f - depth), va, ib, shader);
+			}
+			for (unsigned int i = 0; transparent && i < TransparentCount; i++)
+			{
+				float depth = 0.01f + 0.08f * i / TransparentCount;
+				list.SetUniformMat4f(mvpLocation, proj * model(i * 8, OpaqueCount, depth));
+				list.Draw(CommandList::MakeTransparentSortKey(0, shader.GetRendererID(), va.GetRendererID(), depth), va, ib, shader);
+			}
+		};
+		std::vector<CommandList> farToNear, nearToFar, opaqueFarToNear, opaqueNearToFar;
+		record(farToNear, false, true);
+		record(nearToFar, true, true);
+		record(opaqueFarToNear, false, false);
+		record(opaqueNearToFar, true, false);
+
+		struct Mode
+		{
+			const char* Name;
+			bool DepthTest;
+			bool Prepass;
+			const std::vector<CommandList>* Lists;
+			//what the pre-pass draws
+			const std::vector<CommandList>* OpaqueLists;
+		};
+		Mode modes[] = {
+			{ "no depth test, far to near", false, false, &farToNear, &opaqueFarToNear },
+			{ "depth test, far to near", true, false, &farToNear, &opaqueFarToNear },
+			{ "depth test, near to far", true, false, &nearToFar, &opaqueNearToFar },
+			{ "depth pre-pass, far to near", true, true, &farToNear, &opaqueFarToNear },
+			{ "depth pre-pass, near to far", true, true, &nearToFar, &opaqueNearToFar }
+		};
+
+		Renderer renderer;
+		Counts baseline = { 0, 0 };
+		std::string suffix = ", " + std::to_string(OpaqueCount) + " opaque + " + std::to_string(TransparentCount) + " transparent quads";
+		for (const Mode& mode : modes)
+		{
+			renderer.SetDepthTest(mode.DepthTest);
+			renderer.SetDepthPrepass(mode.Prepass);
+			Counts counts = Count(renderer, *mode.Lists);
+			if (mode.Prepass)
+			{
+				//the pre-pass is a depth tested Submit of the opaque draws without color
+				renderer.SetDepthPrepass(false);
+				GLCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+				Counts prepass = Count(renderer, *mode.OpaqueLists);
+				GLCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+				renderer.SetDepthPrepass(true);
+				counts.Invocations -= prepass.Invocations;
+				counts.SamplesPassed -= prepass.SamplesPassed;
+			}
+			if (!mode.DepthTest)
+				baseline = counts;
+
+			runner.Run("depth", std::string("Submit, ") + mode.Name + suffix, [&]() {
+				renderer.Clear();
+				renderer.Submit(*mode.Lists);
+			}, finish);
+			long long saved = (long long)baseline.SamplesPassed - (long long)counts.SamplesPassed;
+			std::cout << "        " << counts.Invocations << " fragment shader invocations, " << counts.SamplesPassed << " samples passed, "
+				<< saved << " saved (" << (baseline.SamplesPassed ? 100.0 * saved / baseline.SamplesPassed : 0.0) << "%)\n";
+		}
+	}
+	return runner.Finish();
+}
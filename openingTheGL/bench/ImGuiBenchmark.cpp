@@ -0,0 +1,113 @@
+//ImGui benchmark: the OpenGL3 backend drawing a busy UI on a headless context, every sample ends with glFinish
+//the UI is 48 small windows with text, sliders and a plot plus the demo window, built once and drawn again each iteration:
+//backup/restore: ImGui_ImplOpenGL3_RenderDrawData as it comes, reading back the GL state and restoring it
+//declared state: with ImGui_ImplOpenGL3_SetRestoreState, nothing read back (what the application uses)
+//each also with GL_RASTERIZER_DISCARD, the submission without the pixels, which a software rasterizer would hide otherwise
+//
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <cmath>
+#include <string>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "Renderer.h"
+
+#include "imgui/imgui.h"
+#include "imgui/imgui_impl_opengl3.h"
+
+static const unsigned int Width = 1280;
+static const unsigned int Height = 720;
+
+static void BuildUi(unsigned int windows)
+{
+	ImGui::NewFrame();
+	static float values[64];
+	for (unsigned int i = 0; i < 64; i++)
+		values[i] = std::sin(i * 0.2f);
+
+	for (unsigned int i = 0; i < windows; i++)
+	{
+		//an 8 x 6 grid over the screen
+		ImGui::SetNextWindowPos(ImVec2((i % 8) * 160.0f, (i / 8) * 120.0f));
+		ImGui::SetNextWindowSize(ImVec2(155.0f, 115.0f));
+		std::string name = "Window " + std::to_string(i);
+		ImGui::Begin(name.c_str());
+		ImGui::Text("Object %u", i);
+		float value = i * 0.1f;
+		ImGui::SliderFloat("Value", &value, 0.0f, 10.0f);
+		ImGui::PlotLines("##plot", values, 64);
+		ImGui::End();
+	}
+	ImGui::ShowDemoWindow();
+	ImGui::Render();
+}
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+	auto finish = []() { glFinish(); };
+
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2((float)Width, (float)Height);
+	io.DeltaTime = 1.0f / 60.0f;
+	ImGui_ImplOpenGL3_Init("#version 330 core");
+	ImGui_ImplOpenGL3_NewFrame();
+
+	{
+		Renderer renderer;
+		const unsigned int windows = 48;
+		//windows size themselves over the first frames
+		for (unsigned int i = 0; i < 3; i++)
+			BuildUi(windows);
+		ImDrawData* drawData = ImGui::GetDrawData();
+
+		unsigned int commands = 0;
+		for (int i = 0; i < drawData->CmdListsCount; i++)
+			commands += drawData->CmdLists[i]->CmdBuffer.Size;
+		std::cout << drawData->CmdListsCount << " draw lists, " << commands << " draw commands, "
+			<< drawData->TotalVtxCount << " vertices, " << drawData->TotalIdxCount << " indices\n";
+
+		ImGui_ImplOpenGL3_RestoreState state = { true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+			GL_FUNC_ADD, GL_FUNC_ADD, false, false, false, GL_TEXTURE0, 0, 0, 0, 0 };
+		std::string suffix = std::to_string(drawData->CmdListsCount) + " draw lists";
+		for (bool discard : { false, true })
+		{
+			if (discard)
+				GLCall(glEnable(GL_RASTERIZER_DISCARD));
+			std::string mode = discard ? ", no rasterization" : "";
+
+			ImGui_ImplOpenGL3_SetRestoreState(nullptr);
+			runner.Run("imgui", "RenderDrawData, backup/restore, " + suffix + mode, [&]() {
+				renderer.Clear();
+				ImGui_ImplOpenGL3_RenderDrawData(drawData);
+			}, finish);
+
+			ImGui_ImplOpenGL3_SetRestoreState(&state);
+			runner.Run("imgui", "RenderDrawData, declared state, " + suffix + mode, [&]() {
+				renderer.Clear();
+				ImGui_ImplOpenGL3_RenderDrawData(drawData);
+			}, finish);
+		}
+		GLCall(glDisable(GL_RASTERIZER_DISCARD));
+	}
+
+	ImGui_ImplOpenGL3_Shutdown();
+	ImGui::DestroyContext();
+	return runner.Finish();
+}
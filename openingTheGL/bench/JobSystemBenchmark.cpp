@@ -0,0 +1,88 @@
+//JobSystem scaling benchmark: job overhead, ParallelFor throughput and dependency chains from 1 worker up to 64
+//Run it with the highest worker count to try as the first argument, by default it stops at the hardware thread count
+//
+//Not part of the application project (it has its own main), build it on its own, for example:
+//g++ -O2 -std=c++17 -pthread -I../src -I../src/vendor JobSystemBenchmark.cpp ../src/JobSystem.cpp -o JobSystemBenchmark
+//cl /O2 /std:c++17 /EHsc /I..\src /I..\src\vendor JobSystemBenchmark.cpp ..\src\JobSystem.cpp
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "JobSystem.h"
+#include "glm/glm.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int maxWorkers = argc > 1 ? (unsigned int)atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+	if (maxWorkers > 64)
+		maxWorkers = 64;
+
+	const unsigned int emptyJobs = 100000;
+	const unsigned int pointCount = 1 << 22;
+	const unsigned int stages = 64, jobsPerStage = 64;
+
+	std::vector<glm::vec4> points(pointCount, glm::vec4(1.0f, 2.0f, 3.0f, 1.0f));
+	glm::mat4 matrix(1.5f);
+
+	std::cout << std::left << std::setw(10) << "workers" << std::setw(18) << "empty jobs/ms" << std::setw(18) << "parallel for ms"
+		<< std::setw(10) << "speedup" << std::setw(20) << "dependency chain ms" << std::endl;
+
+	double singleWorkerMs = 0.0;
+	for (unsigned int workers = 1; workers <= maxWorkers; workers *= 2)
+	{
+		JobSystem jobs(workers);
+
+		//raw overhead: many jobs that do nothing
+		JobSystem::Counter counter;
+		auto start = Clock::now();
+		for (unsigned int i = 0; i < emptyJobs; i++)
+			jobs.Run([]() {}, &counter);
+		jobs.Wait(counter);
+		double emptyMs = ElapsedMs(start);
+
+		//throughput: transform 4M points a few times
+		start = Clock::now();
+		for (int run = 0; run < 4; run++)
+			jobs.ParallelFor(pointCount, 16384, [&points, &matrix](unsigned int first, unsigned int end) {
+				for (unsigned int i = first; i < end; i++)
+					points[i] = matrix * points[i] * 0.5f;
+			});
+		double forMs = ElapsedMs(start) / 4;
+		if (workers == 1)
+			singleWorkerMs = forMs;
+
+		//dependencies: every stage fans out and only starts once the stage before it is done
+		std::vector<JobSystem::Counter> stageCounters(stages);
+		std::atomic<unsigned int> finished(0);
+		start = Clock::now();
+		//a stage's counter holds all of its jobs before the first one is queued, so it only reaches zero once the whole stage ran
+		for (unsigned int stage = 0; stage < stages; stage++)
+			jobs.RunBatch(jobsPerStage, [&finished](unsigned int) {
+				volatile float work = 0.0f;
+				for (int k = 0; k < 2000; k++)
+					work = work + k * 0.5f;
+				finished++;
+			}, &stageCounters[stage], stage ? &stageCounters[stage - 1] : nullptr);
+		jobs.Wait(stageCounters[stages - 1]);
+		for (auto& stageCounter : stageCounters)
+			jobs.Wait(stageCounter);
+		double chainMs = ElapsedMs(start);
+
+		if (finished != stages * jobsPerStage)
+			std::cout << "dependency chain ran " << finished << " jobs instead of " << stages * jobsPerStage << std::endl;
+
+		std::cout << std::fixed << std::setprecision(3) << std::setw(10) << workers << std::setw(18) << emptyJobs / emptyMs
+			<< std::setw(18) << forMs << std::setw(10) << singleWorkerMs / forMs << std::setw(20) << chainMs << std::endl;
+	}
+
+	return 0;
+}
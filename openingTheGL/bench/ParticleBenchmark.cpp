@@ -0,0 +1,88 @@
+//Particle benchmark: ParticleSystem on a headless context, every sample ends with glFinish
+//for each update mode (transform feedback, compute if the context has it, CPU + upload) at 100k and 1M particles:
+//update: Update (1/60 s) alone, the simulation and for the CPU the upload
+//frame: Update + Draw, followed by how many particles that throughput would fit in a 16 ms frame
+//
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <string>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "ParticleSystem.h"
+#include "Renderer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+	runner.AddContext("compute_shaders", ParticleSystem::IsComputeSupported() ? "yes" : "no");
+
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE));
+	auto finish = []() { glFinish(); };
+
+	Renderer renderer;
+	glm::mat4 proj = glm::ortho(-2.4f, 2.4f, -1.35f, 1.35f, -1.0f, 1.0f);
+
+	ParticleSystem::Settings settings = ParticleSystem::DefaultSettings();
+	settings.Emitter = glm::vec2(0.0f, 0.5f);
+	settings.Size = 0.004f;
+
+	struct Mode
+	{
+		ParticleSystem::UpdateMode Update;
+		const char* Name;
+	};
+	const Mode modes[] = {
+		{ ParticleSystem::UpdateMode::TransformFeedback, "transform feedback" },
+		{ ParticleSystem::UpdateMode::Compute, "compute" },
+		{ ParticleSystem::UpdateMode::Cpu, "CPU + upload" }
+	};
+
+	for (unsigned int count : { 100000u, 1000000u })
+	{
+		ParticleSystem particles(count, settings);
+		std::string suffix = std::to_string(count / 1000) + "k particles";
+		for (const Mode& mode : modes)
+		{
+			if (particles.SetUpdateMode(mode.Update) != mode.Update)
+				continue;
+
+			runner.Run("particles", std::string("Update, ") + mode.Name + ", " + suffix, (double)count, "particle", [&]() {
+				particles.Update(1.0f / 60.0f);
+			}, finish);
+
+			size_t before = runner.GetResults().size();
+			runner.Run("particles", std::string("Frame, ") + mode.Name + ", " + suffix, (double)count, "particle", [&]() {
+				renderer.Clear();
+				particles.Update(1.0f / 60.0f);
+				particles.Draw(proj);
+			}, finish);
+
+			if (runner.GetResults().size() > before)
+			{
+				double frameNs = runner.GetResults().back().Median;
+				std::cout << "        ~" << (unsigned long long)(count * 16e6 / frameNs) << " particles in 16 ms\n";
+			}
+		}
+	}
+	return runner.Finish();
+}
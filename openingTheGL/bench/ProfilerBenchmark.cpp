@@ -0,0 +1,75 @@
+//CPU profiler overhead: cost of one PROFILE_SCOPE with profiling on, against the same loop with an empty scope
+//Also records from a few threads at once and writes profiler_benchmark.json, to check the trace opens in Perfetto
+//
+//Not part of the application project (it has its own main), build it on its own, for example:
+//g++ -O2 -std=c++17 -pthread -DPROFILING -I../src ProfilerBenchmark.cpp ../src/Profiler.cpp -o ProfilerBenchmark
+//cl /O2 /std:c++17 /EHsc /DPROFILING /I..\src ProfilerBenchmark.cpp ..\src\Profiler.cpp
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Profiler.h"
+
+using Clock = std::chrono::high_resolution_clock;
+
+//keeps the compiler from removing the loops
+static volatile unsigned int s_Sink = 0;
+
+static double NsPerIteration(Clock::time_point start, unsigned int iterations)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+int main()
+{
+	const unsigned int iterations = 10000000;
+	Profiler::SetThreadName("Benchmark");
+
+	auto start = Clock::now();
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		s_Sink = i;
+	}
+	double baseline = NsPerIteration(start, iterations);
+
+	start = Clock::now();
+	for (unsigned int i = 0; i < iterations; i++)
+	{
+		PROFILE_SCOPE("Zone");
+		s_Sink = i;
+	}
+	double profiled = NsPerIteration(start, iterations);
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "empty loop      " << baseline << " ns/iteration" << std::endl;
+	std::cout << "PROFILE_SCOPE   " << profiled << " ns/iteration" << std::endl;
+	std::cout << "zone overhead   " << profiled - baseline << " ns" << std::endl;
+
+	//a few threads with nested zones, so the trace has something to show
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < 4; t++)
+		threads.emplace_back([t]() {
+			PROFILE_THREAD("Worker " + std::to_string(t));
+			for (unsigned int frame = 0; frame < 100; frame++)
+			{
+				PROFILE_SCOPE("Frame");
+				for (unsigned int pass = 0; pass < 4; pass++)
+				{
+					PROFILE_SCOPE("Pass");
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+				}
+			}
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	if (!Profiler::ExportChromeTrace("profiler_benchmark.json"))
+	{
+		std::cout << "could not write profiler_benchmark.json" << std::endl;
+		return 1;
+	}
+	std::cout << "wrote profiler_benchmark.json" << std::endl;
+	return 0;
+}
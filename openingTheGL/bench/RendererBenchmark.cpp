@@ -0,0 +1,258 @@
+//Renderer benchmark suite: the CPU side hot paths of the renderer (micro) and whole submissions on a headless context (macro)
+//micro: Shader::GetUniformLocation, VertexBufferLayout, Shader::ParseShader, stb_image decode of screen.png, glm mat4 products
+//macro: N draws one call each, N draws through a CommandList, N quads batched into one draw, texture uploads
+//Every sample of a macro benchmark ends with glFinish, so what the GPU (llvmpipe without one) does is part of the time.
+//
+//Run it from openingTheGL/ so res/ is found, with --json results.json to keep the numbers (see Benchmark.h for all options).
+//Builds with the CMakeLists.txt next to it on Linux (EGL, Mesa), for example:
+//cmake -S bench -B bench/build -DCMAKE_BUILD_TYPE=Release && cmake --build bench/build && bench/build/RendererBenchmark --json results.json
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "IndexBuffer.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "stb_image/stb_image.h"
+
+using Benchmark::DoNotOptimize;
+
+static const char* ShaderPath = "res/shaders/Basic.shader";
+static const char* TexturePath = "res/textures/screen.png";
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+
+static std::vector<unsigned char> ReadFile(const char* filepath)
+{
+	std::ifstream stream(filepath, std::ios::binary);
+	return std::vector<unsigned char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+//a model matrix per quad, spread over the screen
+//the quads are scaled down to 10x10 pixels, at the application's size llvmpipe spends all its time filling them and every way of submitting looks the same
+static std::vector<glm::mat4> MakeModels(unsigned int count)
+{
+	std::vector<glm::mat4> models(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f + (i * 37 % 940), 10.0f + (i * 53 % 520), 0.0f));
+		models[i] = glm::scale(translation, glm::vec3(0.1f, 0.1f, 1.0f));
+	}
+	return models;
+}
+
+static void MicroBenchmarks(Benchmark::Runner& runner, Shader& shader)
+{
+	{
+		std::string name = "u_MVP";
+		runner.Run("micro", "Shader::GetUniformLocation (cached)", [&]() {
+			DoNotOptimize(shader.GetUniformLocation(name));
+		});
+		//what most callers do, a std::string is made from the literal every time
+		runner.Run("micro", "Shader::GetUniformLocation (literal)", [&]() {
+			DoNotOptimize(shader.GetUniformLocation("u_MVP"));
+		});
+	}
+
+	runner.Run("micro", "VertexBufferLayout position + uv", [&]() {
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		DoNotOptimize(layout.GetStride());
+		DoNotOptimize(layout.GetElements().data());
+	});
+
+	runner.Run("micro", "Shader::ParseShader Basic.shader", [&]() {
+		ShaderProgramSource source = Shader::ParseShader(ShaderPath);
+		DoNotOptimize(source.VertexSource.data());
+		DoNotOptimize(source.FragmentSource.data());
+	});
+
+	{
+		//decode only, the file is read once
+		std::vector<unsigned char> file = ReadFile(TexturePath);
+		int width = 0, height = 0, channels = 0;
+		stbi_info_from_memory(file.data(), (int)file.size(), &width, &height, &channels);
+		stbi_set_flip_vertically_on_load(1);
+		runner.Run("micro", "stb_image decode screen.png", (double)width * height, "pixel", [&]() {
+			int w, h, c;
+			unsigned char* pixels = stbi_load_from_memory(file.data(), (int)file.size(), &w, &h, &c, 4);
+			DoNotOptimize(pixels);
+			stbi_image_free(pixels);
+		});
+	}
+
+	{
+		glm::mat4 proj = glm::ortho(0.0f, (float)Width, 0.0f, (float)Height, -1.0f, 1.0f);
+		glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(-100.0f, 0.0f, 0.0f));
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(200.0f, 200.0f, 0.0f));
+		runner.Run("micro", "glm mat4 * mat4", [&]() {
+			//the inputs are "changed" every time so the product isn't computed once and hoisted out of the loop
+			DoNotOptimize(view);
+			glm::mat4 result = view * model;
+			DoNotOptimize(result);
+		});
+		runner.Run("micro", "glm proj * view * model", [&]() {
+			DoNotOptimize(view);
+			glm::mat4 result = proj * view * model;
+			DoNotOptimize(result);
+		});
+
+		//the record loop of the application: one MVP per visible object
+		std::vector<glm::mat4> models = MakeModels(1024);
+		std::vector<glm::mat4> mvps(models.size());
+		runner.Run("micro", "glm viewProj * model x1024", (double)models.size(), "matrix", [&]() {
+			DoNotOptimize(view);
+			glm::mat4 viewProj = proj * view;
+			for (size_t i = 0; i < models.size(); i++)
+				mvps[i] = viewProj * models[i];
+			DoNotOptimize(mvps.data());
+		});
+	}
+}
+
+static void MacroBenchmarks(Benchmark::Runner& runner, Shader& shader)
+{
+	Renderer renderer;
+	auto finish = []() { glFinish(); };
+
+	//the application's textured quad
+	float positions[] = {
+		-50.0f, -50.0f, 0.0f, 0.0f,
+		 50.0f, -50.0f, 1.0f, 0.0f,
+		 50.0f,  50.0f, 1.0f, 0.5f,
+		-50.0f,  50.0f, 0.0f, 0.5f
+	};
+	unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+	VertexArray va;
+	VertexBuffer vb(positions, sizeof(positions));
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(2);
+	va.AddBuffer(vb, layout);
+	IndexBuffer ib(indices, 6);
+
+	Texture texture(TexturePath);
+	texture.Bind(0);
+	shader.Bind();
+	shader.SetUniform1i("u_Texture", 0);
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+	glm::mat4 proj = glm::ortho(0.0f, (float)Width, 0.0f, (float)Height, -1.0f, 1.0f);
+	int mvpLocation = shader.GetUniformLocation("u_MVP");
+
+	for (unsigned int count : { 100u, 1000u, 10000u })
+	{
+		std::vector<glm::mat4> models = MakeModels(count);
+		std::string suffix = std::to_string(count) + " quads";
+
+		runner.Run("macro", "Renderer::Draw, " + suffix, (double)count, "draw", [&]() {
+			renderer.Clear();
+			for (const glm::mat4& model : models)
+			{
+				shader.SetUniformMat4f("u_MVP", proj * model);
+				renderer.Draw(va, ib, shader);
+			}
+		}, finish);
+
+		std::vector<CommandList> lists(1);
+		uint64_t key = CommandList::MakeSortKey(0, shader.GetRendererID(), va.GetRendererID(), 0.0f);
+		runner.Run("macro", "CommandList + Submit, " + suffix, (double)count, "draw", [&]() {
+			renderer.Clear();
+			lists[0].Clear();
+			for (const glm::mat4& model : models)
+			{
+				lists[0].SetUniformMat4f(mvpLocation, proj * model);
+				lists[0].Draw(key, va, ib, shader);
+			}
+			renderer.Submit(lists);
+		}, finish);
+
+		//the same quads transformed on the CPU into one buffer and drawn with a single call,
+		//VertexBuffer has no way to update its data, so the buffer is created again every frame
+		std::vector<unsigned int> batchIndices(count * 6);
+		for (unsigned int i = 0; i < count; i++)
+			for (unsigned int j = 0; j < 6; j++)
+				batchIndices[i * 6 + j] = i * 4 + indices[j];
+		IndexBuffer batchIb(batchIndices.data(), count * 6);
+		std::vector<float> vertices(count * 16);
+		runner.Run("macro", "Batched into one draw, " + suffix, (double)count, "quad", [&]() {
+			renderer.Clear();
+			for (unsigned int i = 0; i < count; i++)
+				for (unsigned int v = 0; v < 4; v++)
+				{
+					glm::vec4 position = models[i] * glm::vec4(positions[v * 4], positions[v * 4 + 1], 0.0f, 1.0f);
+					float* vertex = &vertices[(i * 4 + v) * 4];
+					vertex[0] = position.x;
+					vertex[1] = position.y;
+					vertex[2] = positions[v * 4 + 2];
+					vertex[3] = positions[v * 4 + 3];
+				}
+			VertexArray batchVa;
+			VertexBuffer batchVb(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+			batchVa.AddBuffer(batchVb, layout);
+			shader.SetUniformMat4f("u_MVP", proj);
+			renderer.Draw(batchVa, batchIb, shader);
+		}, finish);
+	}
+
+	for (unsigned int size : { 256u, 1024u, 2048u })
+	{
+		std::vector<unsigned char> pixels((size_t)size * size * 4, 0x80);
+		unsigned int id;
+		GLCall(glGenTextures(1, &id));
+		GLCall(glBindTexture(GL_TEXTURE_2D, id));
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)size, (GLsizei)size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+		std::string name = "glTexSubImage2D RGBA8 " + std::to_string(size) + "x" + std::to_string(size);
+		runner.Run("macro", name, (double)pixels.size(), "B", [&]() {
+			GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)size, (GLsizei)size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+		}, finish);
+		GLCall(glDeleteTextures(1, &id));
+	}
+
+	//load, decode, create and upload, everything a Texture does
+	runner.Run("macro", "Texture screen.png", [&]() {
+		Texture loaded(TexturePath);
+		DoNotOptimize(loaded.GetWidth());
+	}, finish);
+}
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+	runner.AddContext("gl_version", (const char*)glGetString(GL_VERSION));
+#ifdef DEBUG
+	//GLCall checks every call in debug builds, those numbers are not comparable to release ones
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+
+	{
+		Shader shader(ShaderPath);
+		MicroBenchmarks(runner, shader);
+		MacroBenchmarks(runner, shader);
+	}
+	return runner.Finish();
+}
@@ -0,0 +1,131 @@
+//SimdMath benchmark: the bulk kernels at every level this CPU supports against the naive glm loops they replace
+//points: N vec4 by one mat4, matrices: N mat4 * mat4, MVPs: one view projection times N model matrices
+//Every level is checked against glm first, a kernel that is fast and wrong isn't worth timing.
+//
+//Not part of the application project (it has its own main), build it on its own, for example:
+//g++ -O2 -std=c++17 -I../src -I../src/vendor SimdMathBenchmark.cpp ../src/SimdMath.cpp -o SimdMathBenchmark
+//cl /O2 /std:c++17 /EHsc /I..\src /I..\src\vendor SimdMathBenchmark.cpp ..\src\SimdMath.cpp
+//No -march or /arch is needed, the kernels pick their instruction set at runtime.
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "SimdMath.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+using Benchmark::DoNotOptimize;
+
+static std::vector<glm::mat4> MakeMatrices(size_t count, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+	std::vector<glm::mat4> matrices(count);
+	for (glm::mat4& matrix : matrices)
+	{
+		matrix = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random)));
+		matrix = glm::rotate(matrix, angle(random), glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f)));
+		matrix = glm::scale(matrix, glm::vec3(0.5f, 2.0f, 1.0f));
+	}
+	return matrices;
+}
+
+static bool Near(const float* a, const float* b, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		if (std::fabs(a[i] - b[i]) > 1e-4f * std::max(1.0f, std::fabs(b[i])))
+			return false;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+	SimdMath::Level supported = SimdMath::GetSupportedLevel();
+	runner.AddContext("supported_level", SimdMath::GetLevelName(supported));
+
+	const size_t count = 4096;
+	std::mt19937 random(42);
+	std::vector<glm::mat4> a = MakeMatrices(count, random);
+	std::vector<glm::mat4> b = MakeMatrices(count, random);
+	glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f)
+		* glm::lookAt(glm::vec3(0.0f, 50.0f, 200.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+	std::vector<glm::vec4> points(count);
+	for (glm::vec4& point : points)
+		point = glm::vec4(coordinate(random), coordinate(random), coordinate(random), 1.0f);
+	std::vector<SimdMath::Vec4x8> blocks(SimdMath::GetBlockCount(count));
+	std::vector<SimdMath::Vec4x8> transformed(blocks.size());
+	SimdMath::Pack(points.data(), count, blocks.data());
+
+	std::vector<glm::mat4> products(count), expectedProducts(count), mvps(count), expectedMvps(count);
+	std::vector<glm::vec4> transformedPoints(count), expectedPoints(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		expectedProducts[i] = a[i] * b[i];
+		expectedMvps[i] = viewProjection * a[i];
+		expectedPoints[i] = a[0] * points[i];
+	}
+
+	std::string suffix = " x" + std::to_string(count);
+
+	runner.Run("glm", "mat4 * vec4" + suffix, (double)count, "point", [&]() {
+		DoNotOptimize(a[0]);
+		for (size_t i = 0; i < count; i++)
+			transformedPoints[i] = a[0] * points[i];
+		DoNotOptimize(transformedPoints.data());
+	});
+	runner.Run("glm", "mat4 * mat4" + suffix, (double)count, "matrix", [&]() {
+		for (size_t i = 0; i < count; i++)
+			products[i] = a[i] * b[i];
+		DoNotOptimize(products.data());
+	});
+	runner.Run("glm", "viewProj * model" + suffix, (double)count, "matrix", [&]() {
+		DoNotOptimize(viewProjection);
+		for (size_t i = 0; i < count; i++)
+			mvps[i] = viewProjection * a[i];
+		DoNotOptimize(mvps.data());
+	});
+
+	int failures = 0;
+	for (int level = 0; level <= (int)supported; level++)
+	{
+		SimdMath::SetLevel((SimdMath::Level)level);
+		std::string group = SimdMath::GetLevelName((SimdMath::Level)level);
+
+		SimdMath::TransformPoints(a[0], blocks.data(), transformed.data(), blocks.size());
+		SimdMath::Unpack(transformed.data(), count, transformedPoints.data());
+		SimdMath::MultiplyMatrices(a.data(), b.data(), products.data(), count);
+		SimdMath::ComputeMvps(viewProjection, a.data(), mvps.data(), count);
+		bool correct = Near(&transformedPoints[0].x, &expectedPoints[0].x, count * 4)
+			&& Near(&products[0][0][0], &expectedProducts[0][0][0], count * 16)
+			&& Near(&mvps[0][0][0], &expectedMvps[0][0][0], count * 16);
+		if (!correct)
+		{
+			std::cout << group << " results don't match glm, not timed\n";
+			failures++;
+			continue;
+		}
+
+		runner.Run(group, "TransformPoints" + suffix, (double)count, "point", [&]() {
+			DoNotOptimize(a[0]);
+			SimdMath::TransformPoints(a[0], blocks.data(), transformed.data(), blocks.size());
+			DoNotOptimize(transformed.data());
+		});
+		runner.Run(group, "MultiplyMatrices" + suffix, (double)count, "matrix", [&]() {
+			SimdMath::MultiplyMatrices(a.data(), b.data(), products.data(), count);
+			DoNotOptimize(products.data());
+		});
+		runner.Run(group, "ComputeMvps" + suffix, (double)count, "matrix", [&]() {
+			DoNotOptimize(viewProjection);
+			SimdMath::ComputeMvps(viewProjection, a.data(), mvps.data(), count);
+			DoNotOptimize(mvps.data());
+		});
+	}
+
+	int result = runner.Finish();
+	return failures > 0 ? 1 : result;
+}
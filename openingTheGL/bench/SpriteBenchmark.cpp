@@ -0,0 +1,125 @@
+//SpriteRenderer benchmark: recording, radix sorting and submitting 100k to 1M sprites on a headless context
+//record: Begin + Draw for every sprite, sort: record + Sort, end: record + Sort + Flush (with glFinish)
+//keys: the radix sort on its own against std::sort of the same keys, both copy the unsorted keys in first
+//Two scenes: one atlas with random depths (batches only end when full), and 4 textures on 16 depth levels, the way
+//2D scenes are usually layered, where the texture in the key groups each level into 4 batches.
+//(4 textures at random depths can't batch at all, nearly every sprite becomes a draw call: that is what atlases are for)
+//
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "SpriteRenderer.h"
+#include "Texture.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+using Benchmark::DoNotOptimize;
+
+static const char* TexturePath = "res/textures/screen.png";
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+
+struct BenchSprite
+{
+	glm::vec2 Position;
+	float Depth;
+	unsigned int Texture;
+};
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	auto finish = []() { glFinish(); };
+
+	{
+		std::vector<std::unique_ptr<Texture>> textures;
+		for (unsigned int i = 0; i < 4; i++)
+			textures.push_back(std::make_unique<Texture>(TexturePath));
+
+		SpriteRenderer sprites;
+		Renderer renderer;
+		glm::mat4 proj = glm::ortho(0.0f, (float)Width, 0.0f, (float)Height, -1.0f, 1.0f);
+		//small enough that llvmpipe isn't only filling pixels
+		glm::vec2 size(4.0f, 4.0f);
+
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> x(0.0f, Width - size.x), y(0.0f, Height - size.y), depth(0.0f, 1.0f);
+
+		for (unsigned int count : { 100000u, 300000u, 1000000u })
+			for (unsigned int textureCount : { 1u, 4u })
+			{
+				std::vector<BenchSprite> scene(count);
+				for (unsigned int i = 0; i < count; i++)
+				{
+					float spriteDepth = textureCount > 1 ? (float)(i * 7 % 16) / 15.0f : depth(random);
+					scene[i] = { glm::vec2(x(random), y(random)), spriteDepth, i % textureCount };
+				}
+
+				auto record = [&]() {
+					sprites.Begin(proj);
+					for (const BenchSprite& sprite : scene)
+						sprites.Draw(*textures[sprite.Texture], sprite.Position, size, sprite.Depth);
+				};
+				std::string suffix = std::to_string(count / 1000) + "k sprites, " + (textureCount > 1 ? "4 textures, 16 depths" : "1 atlas, random depths");
+
+				runner.Run("record", suffix, (double)count, "sprite", [&]() {
+					record();
+					DoNotOptimize(sprites.GetSpriteCount());
+				});
+				runner.Run("sort", suffix, (double)count, "sprite", [&]() {
+					record();
+					sprites.Sort();
+				});
+				runner.Run("end", suffix, (double)count, "sprite", [&]() {
+					renderer.Clear();
+					record();
+					sprites.End();
+				}, finish);
+				std::cout << "        " << sprites.GetBatchCount() << " draw calls\n";
+			}
+
+		//the sort on its own, keys shaped like the sprite renderer's: 16 bits of depth, a texture, the index
+		for (unsigned int count : { 100000u, 300000u, 1000000u })
+		{
+			std::vector<uint64_t> keys(count), values, scratch;
+			for (unsigned int i = 0; i < count; i++)
+				keys[i] = (uint64_t)((uint32_t)(depth(random) * 65535.0f) << 8 | (i % 4)) << 32 | i;
+
+			std::string suffix = std::to_string(count / 1000) + "k";
+			runner.Run("keys", "SpriteRenderer::RadixSort " + suffix, (double)count, "key", [&]() {
+				values = keys;
+				SpriteRenderer::RadixSort(values, scratch);
+				DoNotOptimize(values.data());
+			});
+			runner.Run("keys", "std::sort " + suffix, (double)count, "key", [&]() {
+				values = keys;
+				std::sort(values.begin(), values.end());
+				DoNotOptimize(values.data());
+			});
+		}
+	}
+	return runner.Finish();
+}
@@ -0,0 +1,118 @@
+//Text benchmark: SdfFont + TextRenderer on a headless context, glyphs per second for pages of 100k characters
+//page: Begin + Draw of a 100k character page (1000 lines) + End, at 8 and 32 pixel font sizes, every sample ends with glFinish
+//layout: the same page laid out into the batch without drawing it, the CPU side of the above
+//glyph cache: a font loaded again and the distance fields of the 95 printable ASCII glyphs made, what cache misses cost
+//
+//Uses the first system font it finds (DejaVu, Liberation, Arial, Segoe UI) or ImGui's built in ProggyClean.
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <string>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "SdfFont.h"
+#include "TextRenderer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+using Benchmark::DoNotOptimize;
+
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+
+static const char* FontPaths[] = {
+	"/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+	"/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf",
+	"C:/Windows/Fonts/arial.ttf",
+	"C:/Windows/Fonts/segoeui.ttf"
+};
+
+//the first font that loads, the path goes into name
+static bool LoadFont(SdfFont& font, std::string& name)
+{
+	for (const char* path : FontPaths)
+	{
+		std::ifstream exists(path);
+		if (exists && font.Load(path))
+		{
+			name = path;
+			return true;
+		}
+	}
+	name = "ProggyClean (ImGui)";
+	return font.LoadDefault();
+}
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+
+	GLCall(glEnable(GL_BLEND));
+	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	auto finish = []() { glFinish(); };
+
+	{
+		SdfFont font;
+		std::string fontName;
+		if (!LoadFont(font, fontName))
+		{
+			std::cout << "No font could be loaded\n";
+			return 1;
+		}
+		runner.AddContext("font", fontName);
+
+		//1000 lines of 100 characters, the printable ASCII range over and over
+		std::string page;
+		for (unsigned int line = 0; line < 1000; line++)
+		{
+			for (unsigned int i = 0; i < 99; i++)
+				page += (char)(' ' + (line * 31 + i * 7) % 95);
+			page += '\n';
+		}
+
+		TextRenderer text;
+		Renderer renderer;
+		glm::mat4 proj = glm::ortho(0.0f, (float)Width, 0.0f, (float)Height, -1.0f, 1.0f);
+
+		for (float size : { 8.0f, 32.0f })
+		{
+			std::string suffix = "100k characters, " + std::to_string((int)size) + " px";
+			runner.Run("text", "Page " + suffix, (double)page.size(), "glyph", [&]() {
+				renderer.Clear();
+				text.Begin(proj);
+				text.Draw(font, page, glm::vec2(0.0f, Height - size), size, glm::vec4(1.0f));
+				text.End();
+			}, finish);
+			std::cout << "        " << text.GetGlyphCount() << " glyph quads in " << text.GetBatchCount() << " draw calls\n";
+		}
+
+		//Begin resets the batch, so nothing is drawn, apart from the batches filled up on the way
+		runner.Run("text", "Layout 100k characters (batch drawn when full)", (double)page.size(), "glyph", [&]() {
+			text.Begin(proj);
+			DoNotOptimize(text.Draw(font, page, glm::vec2(0.0f, Height - 8.0f), 8.0f));
+		}, finish);
+
+		runner.Run("text", "Font load + 95 glyph cache misses", [&]() {
+			SdfFont fresh;
+			std::string name;
+			LoadFont(fresh, name);
+			for (unsigned int codepoint = ' '; codepoint < 127; codepoint++)
+				DoNotOptimize(fresh.GetGlyph(codepoint).Advance);
+		});
+	}
+	return runner.Finish();
+}
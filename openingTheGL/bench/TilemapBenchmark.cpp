@@ -0,0 +1,107 @@
+//Tilemap benchmark: a 4096 x 4096 tile map on a headless context, what a frame costs with a few edits against uploading everything
+//upload: every chunk marked and uploaded (32 MB), what a map without dirty chunks would send every time it changes
+//frame: tile edits + Upload + Draw of the chunks the camera sees, the camera pans a little every frame
+//Every sample ends with glFinish. The numbers of chunks uploaded and drawn per frame are printed under each line.
+//
+//Run it from openingTheGL/ so res/ is found, build it with the CMakeLists.txt next to it (see RendererBenchmark.cpp).
+#include <random>
+
+#include "Benchmark.h"
+
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "Tilemap.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+static const char* TexturePath = "res/textures/screen.png";
+static const unsigned int Width = 960;
+static const unsigned int Height = 540;
+static const unsigned int MapSize = 4096;
+static const float TileSize = 16.0f;
+
+int main(int argc, char** argv)
+{
+	Benchmark::Runner runner(argc, argv);
+
+	HeadlessContext context;
+	if (!context.Create(Width, Height))
+	{
+		std::cout << "No OpenGL context, nothing to benchmark\n";
+		return 1;
+	}
+	runner.AddContext("gl_renderer", (const char*)glGetString(GL_RENDERER));
+#ifdef DEBUG
+	runner.AddContext("build", "debug");
+#else
+	runner.AddContext("build", "release");
+#endif
+	auto finish = []() { glFinish(); };
+
+	{
+		//screen.png cut in 4 x 4 tiles
+		Texture tileset(TexturePath);
+		Tilemap map(MapSize, MapSize, TileSize);
+		map.SetTileset(&tileset, 4, 4);
+		for (unsigned int y = 0; y < MapSize; y++)
+			for (unsigned int x = 0; x < MapSize; x++)
+				map.SetTile(x, y, (uint16_t)(1 + (x * 7 + y * 3) % 16));
+		map.Upload();
+
+		Renderer renderer;
+		glm::mat4 proj = glm::ortho(0.0f, (float)Width, 0.0f, (float)Height, -1.0f, 1.0f);
+		std::mt19937 random(3);
+		std::uniform_int_distribution<unsigned int> coordinate(0, MapSize - 1);
+		std::uniform_int_distribution<unsigned int> tile(0, 16);
+
+		//the camera walks diagonally over the map, a pixel per frame
+		unsigned int frame = 0;
+		auto draw = [&]() {
+			float offset = (float)(frame++ % (MapSize * (unsigned int)TileSize - Width));
+			glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(-offset, -offset * 0.5f, 0.0f));
+			renderer.Clear();
+			map.Upload();
+			map.Draw(proj * view);
+		};
+		auto report = [&]() {
+			std::cout << "        " << map.GetUploadedChunks() << " chunks (" << map.GetUploadedBytes() / 1024 << " KB) uploaded, "
+				<< map.GetDrawnChunks() << " of " << map.GetChunkCount() << " drawn\n";
+		};
+
+		runner.Run("tilemap", "Upload all chunks 4096x4096", (double)MapSize * MapSize * sizeof(uint16_t), "B", [&]() {
+			map.Invalidate();
+			map.Upload();
+		}, finish);
+		report();
+
+		runner.Run("tilemap", "Frame, no edits", [&]() {
+			draw();
+		}, finish);
+		report();
+
+		runner.Run("tilemap", "Frame, 64 scattered edits", [&]() {
+			for (unsigned int i = 0; i < 64; i++)
+				map.SetTile(coordinate(random), coordinate(random), (uint16_t)tile(random));
+			draw();
+		}, finish);
+		report();
+
+		runner.Run("tilemap", "Frame, 16x16 brush", [&]() {
+			unsigned int brushX = coordinate(random) % (MapSize - 16), brushY = coordinate(random) % (MapSize - 16);
+			for (unsigned int y = 0; y < 16; y++)
+				for (unsigned int x = 0; x < 16; x++)
+					map.SetTile(brushX + x, brushY + y, (uint16_t)tile(random));
+			draw();
+		}, finish);
+		report();
+
+		//the whole map sent again every frame, as if there was no dirty tracking
+		runner.Run("tilemap", "Frame, everything re-uploaded", [&]() {
+			map.Invalidate();
+			draw();
+		}, finish);
+		report();
+	}
+	return runner.Finish();
+}
@@ -0,0 +1,118 @@
+//Transform hierarchy benchmark: TransformSystem dirty-flag updates on a 100k node scene
+//against rebuilding every world matrix from scratch each frame
+//
+//Not part of the application project (it has its own main), build it on its own, for example:
+//g++ -O2 -std=c++17 -pthread -I../src -I../src/vendor TransformBenchmark.cpp ../src/TransformSystem.cpp ../src/JobSystem.cpp -o TransformBenchmark
+//cl /O2 /std:c++17 /EHsc /I..\src /I..\src\vendor TransformBenchmark.cpp ..\src\TransformSystem.cpp ..\src\JobSystem.cpp
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "TransformSystem.h"
+#include "JobSystem.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main()
+{
+	const unsigned int nodeCount = 100000;
+	const int runs = 20;
+
+	//random tree: every node picks a parent among the nodes created before it, 1% are roots
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+	TransformSystem transforms;
+	std::vector<TransformSystem::Handle> handles;
+	std::vector<int> parents;
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		bool root = i == 0 || rng() % 100 == 0;
+		int parent = root ? -1 : (int)(rng() % i);
+		TransformSystem::Handle handle = transforms.Create(root ? TransformSystem::InvalidHandle : handles[parent]);
+		transforms.SetPosition(handle, glm::vec3(value(rng), value(rng), value(rng)));
+		transforms.SetRotation(handle, glm::angleAxis(value(rng), glm::normalize(glm::vec3(value(rng), value(rng), 1.0f))));
+		handles.push_back(handle);
+		parents.push_back(parent);
+	}
+	transforms.Update();
+
+	//baseline: what the main loop does today, a fresh model matrix per object per frame (plus the parent chain)
+	std::vector<glm::mat4> naive(nodeCount);
+	auto start = Clock::now();
+	for (int run = 0; run < runs; run++)
+		for (unsigned int i = 0; i < nodeCount; i++)
+		{
+			glm::mat4 local = glm::translate(glm::mat4(1.0f), transforms.GetPosition(handles[i])) * glm::mat4_cast(transforms.GetRotation(handles[i]))
+				* glm::scale(glm::mat4(1.0f), transforms.GetScale(handles[i]));
+			naive[i] = parents[i] < 0 ? local : naive[parents[i]] * local;
+		}
+	double naiveMs = ElapsedMs(start) / runs;
+
+	std::cout << nodeCount << " nodes, naive full rebuild: " << std::fixed << std::setprecision(3) << naiveMs << " ms" << std::endl;
+	std::cout << std::left << std::setw(10) << "threads" << std::setw(16) << "all dirty ms" << std::setw(16) << "1% dirty ms"
+		<< std::setw(16) << "clean ms" << std::setw(12) << "updated" << std::endl;
+
+	unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		JobSystem jobs(threads);
+		transforms.SetJobSystem(&jobs);
+
+		start = Clock::now();
+		for (int run = 0; run < runs; run++)
+		{
+			for (unsigned int i = 0; i < nodeCount; i++)
+				if (parents[i] < 0)
+					transforms.SetScale(handles[i], glm::vec3(1.0f + run * 0.01f));
+			transforms.Update();
+		}
+		double allMs = ElapsedMs(start) / runs;
+
+		unsigned int updated = 0;
+		start = Clock::now();
+		for (int run = 0; run < runs; run++)
+		{
+			for (unsigned int i = 0; i < nodeCount / 100; i++)
+			{
+				TransformSystem::Handle handle = handles[rng() % nodeCount];
+				transforms.SetPosition(handle, transforms.GetPosition(handle) + glm::vec3(0.1f));
+			}
+			transforms.Update();
+			updated += transforms.GetUpdatedCount();
+		}
+		double someMs = ElapsedMs(start) / runs;
+
+		start = Clock::now();
+		for (int run = 0; run < runs; run++)
+			transforms.Update();
+		double cleanMs = ElapsedMs(start) / runs;
+
+		std::cout << std::setw(10) << threads << std::setw(16) << allMs << std::setw(16) << someMs
+			<< std::setw(16) << cleanMs << std::setw(12) << updated / runs << std::endl;
+		transforms.SetJobSystem(nullptr);
+	}
+
+	//the incremental result has to match a full rebuild
+	float maxError = 0.0f;
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		glm::mat4 local = glm::translate(glm::mat4(1.0f), transforms.GetPosition(handles[i])) * glm::mat4_cast(transforms.GetRotation(handles[i]))
+			* glm::scale(glm::mat4(1.0f), transforms.GetScale(handles[i]));
+		naive[i] = parents[i] < 0 ? local : naive[parents[i]] * local;
+		for (int c = 0; c < 4; c++)
+			maxError = std::max(maxError, glm::length(naive[i][c] - transforms.GetWorldMatrix(handles[i])[c]));
+	}
+	std::cout << "max difference to full rebuild: " << maxError << std::endl;
+
+	return 0;
+}
@@ -26,11 +26,12 @@ layout(location = 0) out vec4 color;
 in vec2 v_TexCoord;
 
 //u_ defines a uniform variable
-uniform vec4 u_Color;
+//tint, white unless a draw sets it
+uniform vec4 u_Color = vec4(1.0);
 uniform sampler2D u_Texture;
 
 void main()
 {
 	vec4 texColor = texture(u_Texture, v_TexCoord);
-	color = texColor;// vec4(0.2, 0.0, 0.8, 1.0);
+	color = texColor * u_Color;// vec4(0.2, 0.0, 0.8, 1.0);
 };
\ No newline at end of file
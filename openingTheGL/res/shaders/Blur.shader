@@ -0,0 +1,37 @@
+#shader vertex
+#version 330 core
+
+//one triangle that covers the screen, no vertex buffer, see RenderThread::DrawBlur
+out vec2 v_TexCoord;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0;
+	gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+	v_TexCoord = corner;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+//one texel along the axis that is blurred, the other component is 0
+uniform vec2 u_Step;
+
+//9 tap gaussian, blurring along x and then along y is the same as blurring in 2D
+const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+void main()
+{
+	vec4 sum = texture(u_Texture, v_TexCoord) * weights[0];
+	for (int i = 1; i < 5; i++)
+	{
+		sum += texture(u_Texture, v_TexCoord + u_Step * float(i)) * weights[i];
+		sum += texture(u_Texture, v_TexCoord - u_Step * float(i)) * weights[i];
+	}
+	color = sum;
+};
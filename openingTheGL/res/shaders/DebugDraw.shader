@@ -0,0 +1,38 @@
+#shader vertex
+#version 330 core
+
+//one end of a debug line, see DebugDraw
+layout(location = 0) in vec3 position;
+//pixels from position, label strokes only
+layout(location = 1) in vec2 offset;
+layout(location = 2) in vec4 color;
+
+out vec4 v_Color;
+
+uniform mat4 u_ViewProjection;
+uniform vec2 u_ViewportSize;
+
+void main()
+{
+	vec4 clip = u_ViewProjection * vec4(position, 1.0);
+	if (offset != vec2(0.0))
+	{
+		//the labelled point rounded to a pixel, the strokes on pixel centers from there, so the font stays crisp
+		vec2 pixel = floor((clip.xy / clip.w * 0.5 + 0.5) * u_ViewportSize) + offset + 0.5;
+		clip.xy = (pixel / u_ViewportSize * 2.0 - 1.0) * clip.w;
+	}
+	gl_Position = clip;
+	v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+};
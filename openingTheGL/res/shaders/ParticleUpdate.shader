@@ -0,0 +1,62 @@
+#shader vertex
+#version 330 core
+
+//one particle in, the same particle a time step later out, captured with transform feedback (see ParticleSystem)
+layout(location = 0) in vec4 positionVelocity;
+layout(location = 1) in vec4 state;
+
+out vec4 o_PositionVelocity;
+out vec4 o_State;
+
+uniform float u_DeltaTime;
+uniform vec2 u_Emitter;
+uniform vec2 u_Gravity;
+uniform float u_Speed;
+uniform vec2 u_Lifetime;
+
+//the same hash and respawn as ParticleSystem::Respawn and ParticleUpdateCompute.shader
+uint Hash(uint x)
+{
+	x ^= x >> 16u;
+	x *= 0x7feb352du;
+	x ^= x >> 15u;
+	x *= 0x846ca68bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+float Random(inout uint seed)
+{
+	seed = Hash(seed);
+	return float(seed >> 8u) / 16777216.0;
+}
+
+void main()
+{
+	vec2 position = positionVelocity.xy;
+	vec2 velocity = positionVelocity.zw;
+	float age = state.x + u_DeltaTime;
+	float lifetime = state.y;
+	float seed = state.z;
+
+	if (age >= lifetime)
+	{
+		//the seed is kept below 2^24 so it stays exact as a float
+		uint next = uint(seed);
+		float angle = Random(next) * 6.2831853;
+		float speed = u_Speed * (0.25 + 0.75 * Random(next));
+		lifetime = mix(u_Lifetime.x, u_Lifetime.y, Random(next));
+		position = u_Emitter;
+		velocity = vec2(cos(angle), sin(angle)) * speed;
+		age = 0.0;
+		seed = float(next & 0xffffffu);
+	}
+	else
+	{
+		velocity += u_Gravity * u_DeltaTime;
+		position += velocity * u_DeltaTime;
+	}
+
+	o_PositionVelocity = vec4(position, velocity);
+	o_State = vec4(age, lifetime, seed, 0.0);
+};
@@ -0,0 +1,78 @@
+#shader compute
+#version 330 core
+//ParticleSystem::IsComputeSupported accepts GL 4.3 or the two extensions, a 430 shader wouldn't compile with only the extensions
+#extension GL_ARB_compute_shader : require
+#extension GL_ARB_shader_storage_buffer_object : require
+
+//ParticleUpdate.shader as a compute shader, the particles are updated in place
+layout(local_size_x = 256) in;
+
+struct Particle
+{
+	vec4 PositionVelocity;
+	//age, lifetime, seed, unused
+	vec4 State;
+};
+
+//no binding qualifier before GLSL 420, the block uses storage buffer binding 0 by default
+layout(std430) buffer Particles
+{
+	Particle particles[];
+};
+
+uniform int u_Count;
+uniform float u_DeltaTime;
+uniform vec2 u_Emitter;
+uniform vec2 u_Gravity;
+uniform float u_Speed;
+uniform vec2 u_Lifetime;
+
+uint Hash(uint x)
+{
+	x ^= x >> 16u;
+	x *= 0x7feb352du;
+	x ^= x >> 15u;
+	x *= 0x846ca68bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+float Random(inout uint seed)
+{
+	seed = Hash(seed);
+	return float(seed >> 8u) / 16777216.0;
+}
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= uint(u_Count))
+		return;
+
+	Particle particle = particles[index];
+	vec2 position = particle.PositionVelocity.xy;
+	vec2 velocity = particle.PositionVelocity.zw;
+	float age = particle.State.x + u_DeltaTime;
+	float lifetime = particle.State.y;
+	float seed = particle.State.z;
+
+	if (age >= lifetime)
+	{
+		uint next = uint(seed);
+		float angle = Random(next) * 6.2831853;
+		float speed = u_Speed * (0.25 + 0.75 * Random(next));
+		lifetime = mix(u_Lifetime.x, u_Lifetime.y, Random(next));
+		position = u_Emitter;
+		velocity = vec2(cos(angle), sin(angle)) * speed;
+		age = 0.0;
+		seed = float(next & 0xffffffu);
+	}
+	else
+	{
+		velocity += u_Gravity * u_DeltaTime;
+		position += velocity * u_DeltaTime;
+	}
+
+	particles[index].PositionVelocity = vec4(position, velocity);
+	particles[index].State = vec4(age, lifetime, seed, 0.0);
+};
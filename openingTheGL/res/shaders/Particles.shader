@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+
+//one particle per instance, straight from the buffer the update wrote (see ParticleSystem)
+layout(location = 0) in vec4 positionVelocity;
+layout(location = 1) in vec4 state;
+
+out vec2 v_Corner;
+out vec4 v_Color;
+
+uniform mat4 u_ViewProjection;
+uniform float u_Size;
+
+void main()
+{
+	//triangle strip corners (-1,-1) (1,-1) (-1,1) (1,1)
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	float t = clamp(state.x / state.y, 0.0, 1.0);
+	float size = u_Size * (1.0 - 0.5 * t);
+	gl_Position = u_ViewProjection * vec4(positionVelocity.xy + corner * size, 0.0, 1.0);
+	v_Corner = corner;
+	v_Color = mix(vec4(1.0, 0.85, 0.35, 1.0), vec4(0.85, 0.2, 0.1, 0.0), t);
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_Corner;
+in vec4 v_Color;
+
+void main()
+{
+	float distance = dot(v_Corner, v_Corner);
+	if (distance > 1.0)
+		discard;
+	color = vec4(v_Color.rgb, v_Color.a * (1.0 - distance));
+};
@@ -0,0 +1,36 @@
+#shader vertex
+#version 330 core
+
+//one vertex of a sprite quad, see SpriteRenderer
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+//the sprites are already in world space, only the camera is left
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+	gl_Position = u_ViewProjection * vec4(position, 0.0, 1.0);
+	v_TexCoord = texCoord;
+	v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	//the tint multiplies the texture, alpha included
+	color = texture(u_Texture, v_TexCoord) * v_Color;
+};
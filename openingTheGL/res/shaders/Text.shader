@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+
+//one corner of a glyph quad, see TextRenderer
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_ViewProjection;
+
+void main()
+{
+	gl_Position = u_ViewProjection * vec4(position, 0.0, 1.0);
+	v_TexCoord = texCoord;
+	v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+//distance to the outline, 0.5 on it (see SdfFont)
+uniform sampler2D u_Atlas;
+
+void main()
+{
+	float distance = texture(u_Atlas, v_TexCoord).r;
+	//how much the distance changes over one screen pixel, so the edge is a pixel wide at any scale
+	float smoothing = max(fwidth(distance) * 0.5, 1e-4);
+	float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+	color = vec4(v_Color.rgb, v_Color.a * coverage);
+};
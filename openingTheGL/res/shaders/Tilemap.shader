@@ -0,0 +1,50 @@
+#shader vertex
+#version 330 core
+
+//one instance per tile of a chunk, drawn as a 4 vertex triangle strip, the tile index is the only vertex data (see Tilemap)
+layout(location = 0) in float tile;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_ViewProjection;
+//world position of the lower left corner of the chunk
+uniform vec2 u_ChunkOrigin;
+uniform float u_TileSize;
+//tiles per chunk side
+uniform int u_ChunkSize;
+//columns and rows of tiles in the tileset
+uniform vec2 u_TilesetGrid;
+
+void main()
+{
+	//tile 0 is empty: all 4 vertices on one point outside the clip volume, nothing is rasterized
+	if (tile == 0.0)
+	{
+		gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+		v_TexCoord = vec2(0.0);
+		return;
+	}
+
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	vec2 cell = vec2(gl_InstanceID % u_ChunkSize, gl_InstanceID / u_ChunkSize);
+	gl_Position = u_ViewProjection * vec4(u_ChunkOrigin + (cell + corner) * u_TileSize, 0.0, 1.0);
+
+	//tile 1 is the top left of the tileset, counted in rows, Texture flips images so the top is at v = 1
+	float index = tile - 1.0;
+	vec2 tilesetCell = vec2(mod(index, u_TilesetGrid.x), u_TilesetGrid.y - 1.0 - floor(index / u_TilesetGrid.x));
+	v_TexCoord = (tilesetCell + corner) / u_TilesetGrid;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord);
+};
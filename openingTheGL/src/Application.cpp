@@ -11,6 +11,7 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <chrono>
 #include "Renderer.h"
 
 #include "VertexBuffer.h"
@@ -19,6 +20,14 @@
 #include "Shader.h"
 #include "VertexBufferLayout.h"
 #include "Texture.h"
+#include "Bvh.h"
+#include "TransformSystem.h"
+#include "JobSystem.h"
+#include "RenderThread.h"
+#include "Profiler.h"
+#include "HeadlessContext.h"
+#include "SimdMath.h"
+#include "FrameSkipper.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -27,43 +36,164 @@
 #include "imgui/imgui_impl_opengl3.h"
 #include "imgui/imgui_impl_glfw.h"
 
-int main(void)
+//Options:
+//--headless            render offscreen without a window, for machines with no display (and no GPU, through Mesa llvmpipe)
+//--frames N            headless: how many frames to render, 600 by default
+//--size WxH            headless: framebuffer size, 960x540 by default
+//--output file.ppm     headless: save the last frame
+//--msaa N              start with N times MSAA (the checkbox in the UI toggles it)
+//--blur N              N post-process blur passes over the scene, 0 (default) for none
+//--dump-graph          print the render graph of the first frame, its passes and transient memory
+//--capture file.y4m    write every frame to a video file, raw RGBA frames for any other extension
+//--depth               depth test the scene (the checkbox in the UI toggles it)
+//--depth-prepass       with --depth: lay down the depth of the opaque draws first, so only visible pixels get shaded
+//--event-driven        only render a frame when something changed, sleep on events in between (the checkbox in the UI toggles it)
+//--animation-fps N     event driven: the most frames a second while something animates without input, 30 by default
+//--pacing MODE         vsync (default), adaptive (vsync that tears late frames) or uncapped
+//--frames-in-flight N  1 to 3, how many frames the CPU may be ahead of the GPU finishing them, 2 by default
+//--fps-limit N         uncapped: the frame rate the limiter keeps to, 0 (default) for none
+struct Options
 {
-	GLFWwindow* window;
-
-	/* Initialize the library */
-	if (!glfwInit())
-		return -1;
+	bool Headless = false;
+	unsigned int Frames = 600;
+	unsigned int Width = 960;
+	unsigned int Height = 540;
+	std::string Output;
+	unsigned int Samples = 1;
+	unsigned int BlurPasses = 0;
+	bool DumpGraph = false;
+	std::string Capture;
+	bool DepthTest = false;
+	bool DepthPrepass = false;
+	bool EventDriven = false;
+	float AnimationFps = 30.0f;
+	FramePacer::Settings Pacing;
+};
+
+static Options ParseOptions(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (argument == "--headless")
+			options.Headless = true;
+		else if (argument == "--frames" && hasValue)
+			options.Frames = (unsigned int)std::stoul(argv[++i]);
+		else if (argument == "--size" && hasValue)
+		{
+			std::string size = argv[++i];
+			size_t x = size.find('x');
+			if (x != std::string::npos)
+			{
+				options.Width = (unsigned int)std::stoul(size.substr(0, x));
+				options.Height = (unsigned int)std::stoul(size.substr(x + 1));
+			}
+		}
+		else if (argument == "--output" && hasValue)
+			options.Output = argv[++i];
+		else if (argument == "--msaa" && hasValue)
+			options.Samples = (unsigned int)std::stoul(argv[++i]);
+		else if (argument == "--blur" && hasValue)
+			options.BlurPasses = (unsigned int)std::stoul(argv[++i]);
+		else if (argument == "--dump-graph")
+			options.DumpGraph = true;
+		else if (argument == "--capture" && hasValue)
+			options.Capture = argv[++i];
+		else if (argument == "--depth")
+			options.DepthTest = true;
+		else if (argument == "--depth-prepass")
+			options.DepthPrepass = true;
+		else if (argument == "--event-driven")
+			options.EventDriven = true;
+		else if (argument == "--animation-fps" && hasValue)
+			options.AnimationFps = std::stof(argv[++i]);
+		else if (argument == "--pacing" && hasValue)
+		{
+			std::string mode = argv[++i];
+			if (mode == "vsync")
+				options.Pacing.SwapMode = FramePacer::Mode::Vsync;
+			else if (mode == "adaptive")
+				options.Pacing.SwapMode = FramePacer::Mode::AdaptiveVsync;
+			else if (mode == "uncapped")
+				options.Pacing.SwapMode = FramePacer::Mode::Uncapped;
+			else
+				std::cout << "Unknown pacing mode " << mode << '\n';
+		}
+		else if (argument == "--frames-in-flight" && hasValue)
+			options.Pacing.MaxFramesInFlight = (unsigned int)std::stoul(argv[++i]);
+		else if (argument == "--fps-limit" && hasValue)
+			options.Pacing.TargetFps = std::stof(argv[++i]);
+		else
+			std::cout << "Unknown option " << argument << '\n';
+	}
+	return options;
+}
 
-	//setting opengl version to 3.3
-	//https://www.glfw.org/docs/latest/window_guide.html#window_hints_ctx
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+int main(int argc, char** argv)
+{
+	Options options = ParseOptions(argc, argv);
 
-	//Note: u cant set the GLFW_OPENGL_PROFILE to CORE without having a vertex array setup
-	//https://www.khronos.org/opengl/wiki/Vertex_Specification#Vertex_Array_Object
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = nullptr;
+	//declared before every GL object, so the context outlives them
+	HeadlessContext headless;
 
-	/* Create a windowed mode window and its OpenGL context */
-	//window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-	window = glfwCreateWindow(960, 540, "Hello World", NULL, NULL);
-	if (!window)
+	if (options.Headless)
 	{
-		glfwTerminate();
-		return -1;
+		if (!headless.Create(options.Width, options.Height))
+			return -1;
 	}
+	else
+	{
+		/* Initialize the library */
+		if (!glfwInit())
+			return -1;
+
+		//setting opengl version to 3.3
+		//https://www.glfw.org/docs/latest/window_guide.html#window_hints_ctx
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+		//Note: u cant set the GLFW_OPENGL_PROFILE to CORE without having a vertex array setup
+		//https://www.khronos.org/opengl/wiki/Vertex_Specification#Vertex_Array_Object
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		//the scene can be depth tested straight into the window (the MSAA path brings its own depth target)
+		glfwWindowHint(GLFW_DEPTH_BITS, 24);
+
+#ifdef DEBUG
+		//lets the driver report errors through GLDebug instead of GLCall polling glGetError
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+
+		/* Create a windowed mode window and its OpenGL context */
+		//window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
+		window = glfwCreateWindow(960, 540, "Hello World", NULL, NULL);
+		if (!window)
+		{
+			glfwTerminate();
+			return -1;
+		}
 
-	/* Make the window's context current */
-	glfwMakeContextCurrent(window);
+		/* Make the window's context current */
+		glfwMakeContextCurrent(window);
 
-	//enable vsync
-	glfwSwapInterval(1);
+		//vsync (or not) is up to the FramePacer, it sets the swap interval on whichever thread renders
 
-	if (glewInit() != GLEW_OK)
-		std::cout << "Error!" << std::endl;
+		if (glewInit() != GLEW_OK)
+			std::cout << "Error!" << std::endl;
+	}
+	PROFILE_THREAD("Main");
 
 	std::cout << glGetString(GL_VERSION) << std::endl;
 
+#ifdef DEBUG
+	//pass true as the second argument to break on the exact GLCall that failed, at the cost of speed
+	if (!GLDebug::Init(GLDebug::Severity::Low, false))
+		std::cout << "No GL debug output, falling back to glGetError" << '\n';
+#endif
+
 	{
 		float positions[] = {
 			-50.0f, -50.0f, 0.0f, 0.0f,//0 => bottom left
@@ -122,37 +252,202 @@ int main(void)
 		// Setup Dear ImGui style
 		ImGui::StyleColorsDark();
 		//ImGui::StyleColorsClassic();
-		ImGui_ImplGlfw_InitForOpenGL(window, true);
+		//headless there is no input, ImGui only needs to know how big the screen is
+		if (options.Headless)
+			ImGui::GetIO().DisplaySize = ImVec2((float)options.Width, (float)options.Height);
+		else
+			ImGui_ImplGlfw_InitForOpenGL(window, true);
+
+		//worker threads shared by everything that can run off the main thread, the main thread is worker 0
+		JobSystem jobs;
+
+		//every object in the scene is a node in the transform system, the quads are children of one scene root
+		//so moving the root moves both of them
+		TransformSystem transforms;
+		transforms.SetJobSystem(&jobs);
+		TransformSystem::Handle sceneRoot = transforms.Create();
+		TransformSystem::Handle objects[] = { transforms.Create(sceneRoot), transforms.Create(sceneRoot) };
+		transforms.SetPosition(objects[0], glm::vec3(200, 200, 0));
+		//in front of the first one (z towards the camera, the projection keeps -1 to 1), and drawn half transparent
+		transforms.SetPosition(objects[1], glm::vec3(400, 200, 0.5f));
+		const unsigned int transparentObject = 1;
+
+		//bounds of the quad in model space, straight from its vertex data
+		//every object gets its own bounds in the bvh, moved to where the object is each frame
+		BoundingBox quadBounds = BoundingBox::FromVertices(positions, 4, layout.GetStride(), 2);
+		Bvh bvh;
+		bvh.Build(std::vector<BoundingBox>(2, quadBounds));
+		std::vector<unsigned int> visibleObjects;
+
+		//draws are recorded on the job system, one command list per chunk of visible objects,
+		//the uniform location is looked up once here since only this thread may talk to GL
+		const unsigned int drawsPerList = 256;
+		int mvpLocation = shader.GetUniformLocation("u_MVP");
+		int colorLocation = shader.GetUniformLocation("u_Color");
+
+		//creates the imgui shaders and font texture now, while this thread still owns the context
+		ImGui_ImplOpenGL3_Init("#version 330 core");
+		ImGui_ImplOpenGL3_NewFrame();
+		//the state every pass starts from: the blending set up above, no depth test, culling or scissor, and the quad's texture
+		//on unit 0 (it is only bound once), ImGui leaves exactly that instead of reading back and restoring the GL state every frame
+		ImGui_ImplOpenGL3_RestoreState imguiState = { true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+			GL_FUNC_ADD, GL_FUNC_ADD, false, false, false, GL_TEXTURE0, 0, 0, 0, texture.GetRendererID() };
+		ImGui_ImplOpenGL3_SetRestoreState(&imguiState);
+
+		//GL submission either runs inline at the end of every frame, or on its own thread one frame behind the game thread
+		//declared after every GL object, so it gives the context back to this thread before they are destroyed
+		RenderThread renderThread(window, renderer, 2);
+		bool useRenderThread = false;
+		bool useMsaa = options.Samples > 1;
+		bool depthTest = options.DepthTest;
+		bool depthPrepass = options.DepthPrepass;
+		int blurPasses = (int)options.BlurPasses;
+		bool capture = !options.Capture.empty();
+		std::string captureFile = capture ? options.Capture : "capture.y4m";
+		unsigned int msaaSamples = options.Samples > 1 ? options.Samples : 4;
+		FramePacer::Settings pacing = options.Pacing;
+		int framesInFlight = (int)pacing.MaxFramesInFlight;
+		auto lastFrameStart = std::chrono::steady_clock::now();
+		float frameTime = 0.0f;
+		if (options.DumpGraph)
+			renderThread.RequestGraphDump();
+
+		//event driven, frames that would look the same as the last one are neither rendered nor swapped
+		//the readouts below measure the frames themselves, they only change on frames input woke up, otherwise every frame differs
+		FrameSkipper frameSkipper(window, options.AnimationFps);
+		bool eventDriven = options.EventDriven;
+		float animationFps = options.AnimationFps;
+		bool refreshReadouts = true;
+		struct
+		{
+			float Framerate = 0.0f, FrameTime = 0.0f, RenderTime = 0.0f, Latency = 0.0f;
+			float FrameInterval = 0.0f, Jitter = 0.0f, GpuLatency = 0.0f, FenceWait = 0.0f, LimiterWait = 0.0f;
+			unsigned long long RenderedFrames = 0, SkippedFrames = 0;
+		} readouts;
 
-		glm::vec3 translationA(200, 200, 0);
-		glm::vec3 translationB(400, 200, 0);
 		float r = 0.0f;
 		float increment = 0.05f;
+		unsigned int frameCount = 0;
+		auto runStart = std::chrono::steady_clock::now();
 		/* Loop until the user closes the window */
-		while (!glfwWindowShouldClose(window))
+		while (options.Headless ? frameCount < options.Frames : !glfwWindowShouldClose(window))
 		{
-			renderer.Clear();
+			PROFILE_SCOPE("Frame");
 
-			// Start the Dear ImGui frame
-			ImGui_ImplOpenGL3_NewFrame();
-			ImGui_ImplGlfw_NewFrame();
-			ImGui::NewFrame();
+			if (useRenderThread != renderThread.IsRunning())
+			{
+				if (useRenderThread)
+					renderThread.Start();
+				else
+					renderThread.Stop();
+			}
 
-			shader.Bind();
+			FrameData& frame = renderThread.BeginFrame();
+
+			//time spent by the game thread per frame, including waiting on the render side
+			auto frameStart = std::chrono::steady_clock::now();
+			frameTime = frameTime * 0.95f + std::chrono::duration<float, std::milli>(frameStart - lastFrameStart).count() * 0.05f;
+			lastFrameStart = frameStart;
+
+			/* Poll for and process events */
+			//not wrapped in GLCall, this thread has no context to check errors on while the render thread runs
+			if (eventDriven)
+			{
+				//an InputText's blinking cursor, or frames going into a video
+				bool animating = ImGui::GetIO().WantTextInput || capture;
+				frameSkipper.SetMaxAnimationFps(animationFps);
+				refreshReadouts = frameSkipper.WaitForEvents(animating) || frameCount == 0;
+				//sleeping on events isn't part of the frame
+				lastFrameStart = std::chrono::steady_clock::now();
+			}
+			else
 			{
-				glm::mat4 model = glm::translate(glm::mat4(1.0f), translationA); //Control model's position
-				glm::mat4 mvp = proj * view * model;
-				shader.SetUniformMat4f("u_MVP", mvp);
+				if (!options.Headless)
+					glfwPollEvents();
+				refreshReadouts = true;
+			}
+			//held still with the readouts, or the GPU profiler's results alone would keep every frame different
+			renderThread.GetGpuProfiler().SetPaused(!refreshReadouts);
+			frame.InputTime = std::chrono::steady_clock::now();
 
-				renderer.Draw(va, ib, shader);
+			//the framebuffer size is read here, glfw only allows it on the main thread
+			if (options.Headless)
+			{
+				frame.Width = options.Width;
+				frame.Height = options.Height;
 			}
+			else
 			{
-				glm::mat4 model = glm::translate(glm::mat4(1.0f), translationB); //Control model's position
-				glm::mat4 mvp = proj * view * model;
-				shader.SetUniformMat4f("u_MVP", mvp);
+				int width, height;
+				glfwGetFramebufferSize(window, &width, &height);
+				frame.Width = (unsigned int)width;
+				frame.Height = (unsigned int)height;
+			}
+			frame.Samples = useMsaa ? msaaSamples : 1;
+			frame.DepthTest = depthTest;
+			frame.DepthPrepass = depthPrepass;
+			frame.BlurPasses = (unsigned int)blurPasses;
+			pacing.MaxFramesInFlight = (unsigned int)framesInFlight;
+			frame.Pacing = pacing;
+			if (capture)
+				frame.CaptureFile = captureFile;
+			else
+				frame.CaptureFile.clear();
+			//headless frames are not shown to anyone, the file is all that matters
+			frame.CaptureEveryFrame = options.Headless;
+
+			// Start the Dear ImGui frame
+			//headless frames advance at a fixed 60 Hz, so every run renders the same images
+			if (options.Headless)
+				ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+			else
+				ImGui_ImplGlfw_NewFrame();
+			ImGui::NewFrame();
 
-				renderer.Draw(va, ib, shader);
+			//recompute the world matrices of whatever moved, update the bounds of those objects and only draw what the camera can see
+			{
+				PROFILE_SCOPE("Transforms");
+				transforms.Update();
 			}
+			{
+				PROFILE_SCOPE("Culling");
+				for (unsigned int i = 0; i < 2; i++)
+					if (transforms.WasUpdated(objects[i]))
+						bvh.Update(i, quadBounds.Transformed(transforms.GetWorldMatrix(objects[i])));
+				bvh.Refit();
+				bvh.Cull(Frustum(proj * view), visibleObjects);
+			}
+
+			//build the draws in parallel into the frame, they are merged and replayed on whichever thread owns GL
+			std::vector<CommandList>& commandLists = frame.CommandLists;
+			unsigned int visibleCount = (unsigned int)visibleObjects.size();
+			commandLists.resize((visibleCount + drawsPerList - 1) / drawsPerList);
+			glm::mat4 viewProjection = proj * view;
+			jobs.ParallelFor(visibleCount, drawsPerList, [&](unsigned int first, unsigned int end) {
+				PROFILE_SCOPE("Record");
+				CommandList& list = commandLists[first / drawsPerList];
+				list.Clear();
+				//the MVPs of up to drawsPerList objects in one SIMD pass, then their draws
+				glm::mat4 models[drawsPerList];
+				glm::mat4 mvps[drawsPerList];
+				unsigned int count = end - first;
+				for (unsigned int i = 0; i < count; i++)
+					models[i] = transforms.GetWorldMatrix(objects[visibleObjects[first + i]]); //Control model's position
+				SimdMath::ComputeMvps(viewProjection, models, mvps, count);
+				for (unsigned int i = 0; i < count; i++)
+				{
+					//the depth of the quad's center in [0, 1], the projection is orthographic so w is 1
+					float depth = mvps[i][3][2] * 0.5f + 0.5f;
+					bool transparent = visibleObjects[first + i] == transparentObject;
+					list.SetUniformMat4f(mvpLocation, mvps[i]);
+					//every draw sets the tint, the program keeps whatever the last draw left
+					list.SetUniform4f(colorLocation, 1.0f, 1.0f, 1.0f, transparent ? 0.5f : 1.0f);
+					if (transparent)
+						list.Draw(CommandList::MakeTransparentSortKey(0, shader.GetRendererID(), va.GetRendererID(), depth), va, ib, shader);
+					else
+						list.Draw(CommandList::MakeSortKey(0, shader.GetRendererID(), va.GetRendererID(), depth), va, ib, shader);
+				}
+			});
 
 
 
@@ -167,28 +462,150 @@ int main(void)
 
 			// 2. Show a simple window that we create ourselves. We use a Begin/End pair to created a named window.
 			{
-				//sending the address of translationA.x, so that y and z are one hop each away
-				ImGui::SliderFloat3("Translation A", &translationA.x, 0.0f, 960.0f);            // Edit 1 float using a slider from 0.0f to 1.0f
-				ImGui::SliderFloat3("Translation B", &translationB.x, 0.0f, 960.0f); 
-
-				ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+				PROFILE_SCOPE("UI");
+
+				//sending the address of translation.x, so that y and z are one hop each away
+				//the transform is only marked dirty when the slider actually changed it
+				const char* labels[] = { "Translation A", "Translation B" };
+				for (unsigned int i = 0; i < 2; i++)
+				{
+					glm::vec3 translation = transforms.GetPosition(objects[i]);
+					if (ImGui::SliderFloat3(labels[i], &translation.x, 0.0f, 960.0f))            // Edit 3 floats using a slider from 0.0f to 960.0f
+						transforms.SetPosition(objects[i], translation);
+				}
+				glm::vec3 sceneOffset = transforms.GetPosition(sceneRoot);
+				if (ImGui::SliderFloat3("Scene offset", &sceneOffset.x, -480.0f, 480.0f))
+					transforms.SetPosition(sceneRoot, sceneOffset);
+
+				if (refreshReadouts)
+				{
+					readouts.Framerate = ImGui::GetIO().Framerate;
+					readouts.FrameTime = frameTime;
+					readouts.RenderTime = renderThread.GetRenderTime();
+					readouts.Latency = renderThread.GetLatency();
+					const FramePacer& pacer = renderThread.GetFramePacer();
+					readouts.FrameInterval = pacer.GetFrameInterval();
+					readouts.Jitter = pacer.GetJitter();
+					readouts.GpuLatency = pacer.GetLatency();
+					readouts.FenceWait = pacer.GetFenceWait();
+					readouts.LimiterWait = pacer.GetLimiterWait();
+					readouts.RenderedFrames = frameSkipper.GetRenderedFrames();
+					readouts.SkippedFrames = frameSkipper.GetSkippedFrames();
+				}
+
+				ImGui::Text("Visible objects: %d / %d", (int)visibleObjects.size(), (int)bvh.GetObjectCount());
+				ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / readouts.Framerate, readouts.Framerate);
+				if (ImGui::CollapsingHeader("Render stats"))
+					RenderStats::DrawPanel();
+
+				ImGui::Checkbox("Render thread", &useRenderThread);
+				ImGui::SameLine();
+				ImGui::Checkbox("MSAA", &useMsaa);
+				ImGui::SameLine();
+				ImGui::Checkbox("Depth test", &depthTest);
+				if (depthTest)
+				{
+					ImGui::SameLine();
+					ImGui::Checkbox("Depth pre-pass", &depthPrepass);
+				}
+				ImGui::SameLine();
+				ImGui::Checkbox("Capture video", &capture);
+				if (capture)
+				{
+					ImGui::SameLine();
+					ImGui::Text("%s: %u frames, %u dropped", captureFile.c_str(), renderThread.GetCapturedFrames(), renderThread.GetDroppedCaptureFrames());
+					//resizing the window starts a new file
+					if (renderThread.GetCaptureFiles() > 1)
+					{
+						ImGui::SameLine();
+						ImGui::Text("in %u files", renderThread.GetCaptureFiles());
+					}
+				}
+				ImGui::SliderInt("Blur passes", &blurPasses, 0, 4);
+				ImGui::Text("Pooled render targets: %u (%.1f MB)", renderThread.GetPooledTargets(), renderThread.GetPooledBytes() / (1024.0f * 1024.0f));
+				ImGui::Text("Transient targets: %.1f MB, %.1f MB without aliasing",
+					renderThread.GetTransientBytes() / (1024.0f * 1024.0f), renderThread.GetTransientBytesWithoutAliasing() / (1024.0f * 1024.0f));
+				ImGui::SameLine();
+				if (ImGui::Button("Dump render graph"))
+					renderThread.RequestGraphDump();
+				ImGui::Text("Game thread %.3f ms/frame, GL submit %.3f ms, input to swap latency %.3f ms",
+					readouts.FrameTime, readouts.RenderTime, readouts.Latency);
+
+				//frame pacing: the swap interval, the limiter and how many frames may wait on the GPU
+				if (ImGui::CollapsingHeader("Frame pacing"))
+				{
+					const char* modes[] = { FramePacer::GetName(FramePacer::Mode::Vsync), FramePacer::GetName(FramePacer::Mode::AdaptiveVsync),
+						FramePacer::GetName(FramePacer::Mode::Uncapped) };
+					int mode = (int)pacing.SwapMode;
+					if (ImGui::Combo("Mode", &mode, modes, 3))
+						pacing.SwapMode = (FramePacer::Mode)mode;
+					ImGui::SliderInt("Frames in flight", &framesInFlight, 1, (int)FramePacer::MaxSlots);
+					if (pacing.SwapMode == FramePacer::Mode::Uncapped)
+						ImGui::SliderFloat("FPS limit", &pacing.TargetFps, 0.0f, 480.0f, pacing.TargetFps > 0.0f ? "%.0f" : "none");
+					//the render side applies the mode a frame later, so this can show for a frame after switching
+					if (pacing.SwapMode == FramePacer::Mode::AdaptiveVsync && renderThread.GetFramePacer().GetActiveMode() == FramePacer::Mode::Vsync)
+						ImGui::Text("No EXT_swap_control_tear here, using plain vsync");
+					ImGui::Text("Frame interval %.3f ms, jitter %.3f ms", readouts.FrameInterval, readouts.Jitter);
+					ImGui::Text("Input to GPU done latency %.3f ms", readouts.GpuLatency);
+					ImGui::Text("Waiting on fences %.3f ms, limiter %.3f ms per frame", readouts.FenceWait, readouts.LimiterWait);
+				}
+
+				ImGui::Checkbox("Event driven", &eventDriven);
+				if (eventDriven)
+				{
+					ImGui::SameLine();
+					ImGui::PushItemWidth(120.0f);
+					ImGui::SliderFloat("Animation FPS cap", &animationFps, 0.0f, 120.0f, animationFps > 0.0f ? "%.0f" : "uncapped");
+					ImGui::PopItemWidth();
+					ImGui::Text("%llu frames rendered, %llu skipped", readouts.RenderedFrames, readouts.SkippedFrames);
+				}
+
+				//where the GPU time goes, a few frames behind since the queries are read back without waiting
+				if (ImGui::CollapsingHeader("GPU profiler", ImGuiTreeNodeFlags_DefaultOpen))
+				{
+					renderThread.GetGpuProfiler().DrawOverlay();
+					if (ImGui::Button("Export CSV"))
+						renderThread.GetGpuProfiler().ExportCsv("gpu_profile.csv");
+				}
+#ifdef PROFILING
+				//the last few seconds of every thread, open it in ui.perfetto.dev
+				if (ImGui::Button("Export CPU trace"))
+					Profiler::ExportChromeTrace("cpu_trace.json");
+#endif
 				//ImGui::End();
 			}
 
-			// Rendering
+			// Rendering: draw it right here, or hand it to the render thread
 			ImGui::Render();
-			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-			/* Swap front and back buffers */
-			GLCall(glfwSwapBuffers(window));
+			//the scene isn't in ImGui's draw data, a transform that moved forces the frame
+			if (!eventDriven || frameSkipper.ShouldRender(*ImGui::GetDrawData(), transforms.GetUpdatedCount() > 0 || capture))
+				renderThread.EndFrame();
+			else
+				renderThread.SkipFrame();
+			frameCount++;
+		}
 
-			/* Poll for and process events */
-			GLCall(glfwPollEvents());
+		if (options.Headless)
+		{
+			//nothing waits for the GPU without a swap, finish so the time covers the rendering too
+			GLCall(glFinish());
+			float totalTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+			if (eventDriven)
+				std::cout << "Event driven: " << frameSkipper.GetRenderedFrames() << " frames rendered, " << frameSkipper.GetSkippedFrames() << " skipped\n";
+			std::cout << "Rendered " << frameCount << " frames at " << options.Width << "x" << options.Height << " in " << totalTime << " ms ("
+				<< totalTime / frameCount << " ms/frame) on " << glGetString(GL_RENDERER) << '\n';
+			const FramePacer& pacer = renderThread.GetFramePacer();
+			std::cout << "Frame pacing: " << FramePacer::GetName(pacer.GetActiveMode()) << ", " << pacing.MaxFramesInFlight << " frames in flight, interval "
+				<< pacer.GetFrameInterval() << " ms, jitter " << pacer.GetJitter() << " ms, input to GPU done latency " << pacer.GetLatency() << " ms\n";
+
+			if (!options.Output.empty() && !headless.WritePpm(options.Output))
+				std::cout << "Could not write " << options.Output << '\n';
 		}
 	}
 	// Cleanup
 	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
+	if (!options.Headless)
+		ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
 	/*GLCall(*/glfwTerminate()/*)*/;
 	return 0;
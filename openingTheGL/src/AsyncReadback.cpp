@@ -0,0 +1,102 @@
+#include "AsyncReadback.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+AsyncReadback::AsyncReadback(unsigned int slots)
+	: m_SlotCount(slots < 2 ? 2 : (slots > MaxSlots ? MaxSlots : slots)), m_Oldest(0), m_Pending(0), m_Stalls(0)
+{
+	for (Slot& slot : m_Slots)
+		slot = { 0, 0, nullptr, 0, 0, 0 };
+}
+
+AsyncReadback::~AsyncReadback()
+{
+	for (unsigned int i = 0; i < m_SlotCount; i++)
+	{
+		Slot& slot = m_Slots[i];
+		if (slot.Fence)
+			GLCall(glDeleteSync((GLsync)slot.Fence));
+		if (slot.Buffer)
+			GLCall(glDeleteBuffers(1, &slot.Buffer));
+	}
+}
+
+void AsyncReadback::Read(unsigned int framebuffer, unsigned int width, unsigned int height, unsigned long long frame)
+{
+	PROFILE_FUNCTION();
+	if (m_Pending == m_SlotCount)
+	{
+		m_Stalls++;
+		Deliver(true);
+	}
+
+	Slot& slot = m_Slots[(m_Oldest + m_Pending) % m_SlotCount];
+	unsigned int size = width * height * 4;
+	if (!slot.Buffer)
+		GLCall(glGenBuffers(1, &slot.Buffer));
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer));
+	if (slot.Size != size)
+	{
+		//STREAM_READ: written by GL once, read by the application once
+		GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+		slot.Size = size;
+	}
+
+	//with a pack buffer bound the last argument is an offset into it and glReadPixels returns right away
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GLCall(glReadPixels(0, 0, (GLsizei)width, (GLsizei)height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	//http://docs.gl/gl4/glFenceSync
+	GLsync fence;
+	GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	slot.Fence = fence;
+	slot.Width = width;
+	slot.Height = height;
+	slot.Frame = frame;
+	m_Pending++;
+}
+
+bool AsyncReadback::Deliver(bool wait)
+{
+	Slot& slot = m_Slots[m_Oldest];
+
+	//http://docs.gl/gl4/glClientWaitSync, a timeout of 0 only asks
+	//the flush bit makes sure the fence gets to the GPU at all, or a wait for it could never end
+	GLenum status;
+	GLCall(status = glClientWaitSync((GLsync)slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0));
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+
+	GLCall(glDeleteSync((GLsync)slot.Fence));
+	slot.Fence = nullptr;
+
+	//the data is in the buffer by now, mapping it doesn't wait anymore
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer));
+	const void* pixels;
+	GLCall(pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.Size, GL_MAP_READ_BIT));
+	if (pixels && m_Callback)
+		m_Callback((const unsigned char*)pixels, slot.Width, slot.Height, slot.Frame);
+	if (pixels)
+		GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	m_Oldest = (m_Oldest + 1) % m_SlotCount;
+	m_Pending--;
+	return true;
+}
+
+void AsyncReadback::Poll()
+{
+	PROFILE_FUNCTION();
+	//fences signal in order, once one isn't done the ones after it aren't either
+	while (m_Pending > 0 && Deliver(false))
+		;
+}
+
+void AsyncReadback::Flush()
+{
+	while (m_Pending > 0)
+		Deliver(true);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <functional>
+
+//Reads framebuffers back to the CPU without waiting for the GPU
+//
+//Read() only queues a glReadPixels into a pixel pack buffer and a fence behind it, the copy happens whenever the GPU gets there.
+//Poll() checks the fences of the oldest reads and hands every finished one to the callback, normally that is a few frames later.
+//With glReadPixels into client memory the CPU would wait for the whole frame to finish drawing instead.
+//
+//The buffers are a ring of Slots, if a read is started while all of them are still in flight the oldest one is waited for (a stall).
+//GL thread only, the callback runs on it too and only gets the pixels while it runs.
+class AsyncReadback
+{
+public:
+	static const unsigned int MaxSlots = 8;
+
+	//RGBA8, bottom row first, frame is whatever was passed to Read()
+	typedef std::function<void(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned long long frame)> Callback;
+
+	AsyncReadback(unsigned int slots = 3);
+	~AsyncReadback();
+
+	AsyncReadback(const AsyncReadback&) = delete;
+	AsyncReadback& operator=(const AsyncReadback&) = delete;
+
+	inline void SetCallback(const Callback& callback) { m_Callback = callback; }
+
+	//starts copying the bottom left width x height pixels of a framebuffer (0 or Framebuffer::GetRendererID())
+	void Read(unsigned int framebuffer, unsigned int width, unsigned int height, unsigned long long frame);
+	//delivers the reads that are done, never waits
+	void Poll();
+	//waits for every read in flight and delivers it
+	void Flush();
+
+	inline unsigned int GetPending() const { return m_Pending; }
+	//reads that had to wait because every slot was busy
+	inline unsigned int GetStalls() const { return m_Stalls; }
+
+private:
+	struct Slot
+	{
+		unsigned int Buffer;
+		unsigned int Size;
+		//a GLsync, kept opaque so this header doesn't need GL
+		void* Fence;
+		unsigned int Width;
+		unsigned int Height;
+		unsigned long long Frame;
+	};
+
+	Slot m_Slots[MaxSlots];
+	unsigned int m_SlotCount;
+	//the oldest read in flight, and how many there are
+	unsigned int m_Oldest;
+	unsigned int m_Pending;
+	unsigned int m_Stalls;
+	Callback m_Callback;
+
+	//true when the oldest read was delivered
+	bool Deliver(bool wait);
+};
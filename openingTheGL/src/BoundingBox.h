@@ -0,0 +1,64 @@
+#pragma once
+#include <cfloat>
+
+#include "glm/glm.hpp"
+
+//Axis aligned bounding box, used as the bounding volume of a mesh for culling
+//An "empty" box has min > max so that merging anything into it just gives back the other box
+struct BoundingBox
+{
+	glm::vec3 Min;
+	glm::vec3 Max;
+
+	BoundingBox()
+		: Min(FLT_MAX), Max(-FLT_MAX) {}
+
+	BoundingBox(const glm::vec3& min, const glm::vec3& max)
+		: Min(min), Max(max) {}
+
+	inline bool IsEmpty() const { return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z; }
+	inline glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+	inline glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+	inline void Merge(const glm::vec3& point)
+	{
+		Min = glm::min(Min, point);
+		Max = glm::max(Max, point);
+	}
+
+	inline void Merge(const BoundingBox& other)
+	{
+		Min = glm::min(Min, other.Min);
+		Max = glm::max(Max, other.Max);
+	}
+
+	//Returns the box that encloses this box after it is moved by "transform"
+	//Uses the center/extents form (Arvo's method), so it is exact for translation and a conservative fit for rotation
+	BoundingBox Transformed(const glm::mat4& transform) const
+	{
+		if (IsEmpty())
+			return *this;
+
+		glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+		glm::vec3 extents = GetExtents();
+		glm::vec3 newExtents(
+			glm::abs(transform[0][0]) * extents.x + glm::abs(transform[1][0]) * extents.y + glm::abs(transform[2][0]) * extents.z,
+			glm::abs(transform[0][1]) * extents.x + glm::abs(transform[1][1]) * extents.y + glm::abs(transform[2][1]) * extents.z,
+			glm::abs(transform[0][2]) * extents.x + glm::abs(transform[1][2]) * extents.y + glm::abs(transform[2][2]) * extents.z);
+		return { center - newExtents, center + newExtents };
+	}
+
+	//Builds the bounds of a mesh straight from the vertex data that is handed to the VertexBuffer
+	//stride is in bytes (same as VertexBufferLayout::GetStride()), components is 2 or 3 for the position attribute at offset 0
+	static BoundingBox FromVertices(const void* data, unsigned int vertexCount, unsigned int stride, unsigned int components = 3)
+	{
+		BoundingBox box;
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* p = (const float*)(bytes + i * stride);
+			box.Merge(glm::vec3(p[0], p[1], components > 2 ? p[2] : 0.0f));
+		}
+		return box;
+	}
+};
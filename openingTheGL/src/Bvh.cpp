@@ -0,0 +1,336 @@
+#include "Bvh.h"
+#include <algorithm>
+
+//Tests 4 boxes (structure of arrays) against the frustum
+//returns bit i set when box i is at least partly inside, and sets bit i of "inside" when box i is completely inside
+//For each plane the "positive" corner (furthest along the normal) decides if the box is outside,
+//and the "negative" corner decides if the box is completely inside.
+//The plane is the same for all lanes, so picking min or max is a scalar branch instead of a per lane blend
+static int TestBoxes4(const Frustum& frustum, const float* minX, const float* minY, const float* minZ,
+	const float* maxX, const float* maxY, const float* maxZ, int& inside)
+{
+#if defined(SIMD_SSE)
+	__m128 x0 = _mm_loadu_ps(minX), y0 = _mm_loadu_ps(minY), z0 = _mm_loadu_ps(minZ);
+	__m128 x1 = _mm_loadu_ps(maxX), y1 = _mm_loadu_ps(maxY), z1 = _mm_loadu_ps(maxZ);
+	__m128 zero = _mm_setzero_ps();
+	__m128 outside = zero;
+	__m128 crossing = zero;
+
+	for (int i = 0; i < Frustum::Count; i++)
+	{
+		const glm::vec4& p = frustum.Planes[i];
+		__m128 nx = _mm_set1_ps(p.x), ny = _mm_set1_ps(p.y), nz = _mm_set1_ps(p.z), d = _mm_set1_ps(p.w);
+
+		__m128 positive = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, p.x > 0.0f ? x1 : x0), _mm_mul_ps(ny, p.y > 0.0f ? y1 : y0)),
+			_mm_add_ps(_mm_mul_ps(nz, p.z > 0.0f ? z1 : z0), d));
+		__m128 negative = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, p.x > 0.0f ? x0 : x1), _mm_mul_ps(ny, p.y > 0.0f ? y0 : y1)),
+			_mm_add_ps(_mm_mul_ps(nz, p.z > 0.0f ? z0 : z1), d));
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(positive, zero));
+		crossing = _mm_or_ps(crossing, _mm_cmplt_ps(negative, zero));
+	}
+
+	int outsideMask = _mm_movemask_ps(outside);
+	inside = ~(outsideMask | _mm_movemask_ps(crossing)) & 0xF;
+	return ~outsideMask & 0xF;
+#else
+	int visibleMask = 0;
+	inside = 0;
+	for (int lane = 0; lane < 4; lane++)
+	{
+		bool isOutside = false, isCrossing = false;
+		for (int i = 0; i < Frustum::Count && !isOutside; i++)
+		{
+			const glm::vec4& p = frustum.Planes[i];
+			float positive = p.x * (p.x > 0.0f ? maxX : minX)[lane] + p.y * (p.y > 0.0f ? maxY : minY)[lane] + p.z * (p.z > 0.0f ? maxZ : minZ)[lane] + p.w;
+			float negative = p.x * (p.x > 0.0f ? minX : maxX)[lane] + p.y * (p.y > 0.0f ? minY : maxY)[lane] + p.z * (p.z > 0.0f ? minZ : maxZ)[lane] + p.w;
+			isOutside = positive < 0.0f;
+			isCrossing |= negative < 0.0f;
+		}
+		if (!isOutside)
+		{
+			visibleMask |= 1 << lane;
+			if (!isCrossing)
+				inside |= 1 << lane;
+		}
+	}
+	return visibleMask;
+#endif
+}
+
+#if defined(SIMD_AVX)
+//Same as TestBoxes4 but 8 boxes at a time, only the outside test since leaves are not split any further
+static int TestBoxes8(const Frustum& frustum, const float* minX, const float* minY, const float* minZ,
+	const float* maxX, const float* maxY, const float* maxZ)
+{
+	__m256 x0 = _mm256_loadu_ps(minX), y0 = _mm256_loadu_ps(minY), z0 = _mm256_loadu_ps(minZ);
+	__m256 x1 = _mm256_loadu_ps(maxX), y1 = _mm256_loadu_ps(maxY), z1 = _mm256_loadu_ps(maxZ);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 outside = zero;
+
+	for (int i = 0; i < Frustum::Count; i++)
+	{
+		const glm::vec4& p = frustum.Planes[i];
+		__m256 positive = _mm256_add_ps(
+			_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.x), p.x > 0.0f ? x1 : x0), _mm256_mul_ps(_mm256_set1_ps(p.y), p.y > 0.0f ? y1 : y0)),
+			_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.z), p.z > 0.0f ? z1 : z0), _mm256_set1_ps(p.w)));
+		outside = _mm256_or_ps(outside, _mm256_cmp_ps(positive, zero, _CMP_LT_OQ));
+	}
+
+	return ~_mm256_movemask_ps(outside) & 0xFF;
+}
+#endif
+
+Bvh::Bvh()
+{
+}
+
+void Bvh::Build(const std::vector<BoundingBox>& bounds)
+{
+	m_Bounds = bounds;
+	m_Nodes.clear();
+	m_Parents.clear();
+	m_Dirty.clear();
+
+	unsigned int count = (unsigned int)bounds.size();
+	m_Indices.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+		m_Indices[i] = i;
+
+	m_Positions.assign(count, 0);
+	m_Leaves.assign(count, 0);
+
+	if (count == 0)
+		return;
+
+	//a tree of 4-wide nodes with LeafSize objects per leaf has roughly count / (LeafSize * 3) nodes
+	m_Nodes.reserve(count / (LeafSize * 3) + 1);
+	BuildNode(0, count, -1);
+	m_Dirty.assign(m_Nodes.size(), 0);
+
+	//lay the object bounds out in tree order for the batched leaf test
+	unsigned int padded = count + LeafSize;
+	m_MinX.assign(padded, FLT_MAX); m_MinY.assign(padded, FLT_MAX); m_MinZ.assign(padded, FLT_MAX);
+	m_MaxX.assign(padded, -FLT_MAX); m_MaxY.assign(padded, -FLT_MAX); m_MaxZ.assign(padded, -FLT_MAX);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		m_Positions[m_Indices[i]] = i;
+		WriteLeafBounds(i, m_Bounds[m_Indices[i]]);
+	}
+}
+
+int Bvh::BuildNode(unsigned int first, unsigned int count, int parent)
+{
+	int nodeIndex = (int)m_Nodes.size();
+	m_Nodes.emplace_back();
+	m_Parents.push_back(parent);
+
+	//split the range in two, then each half in two again, giving up to 4 children
+	//every split sorts the objects around the median centroid of the longest axis
+	unsigned int ranges[4][2];
+	unsigned int rangeCount = 0;
+
+	auto split = [this](unsigned int first, unsigned int count) -> unsigned int
+	{
+		BoundingBox centroids;
+		for (unsigned int i = first; i < first + count; i++)
+			centroids.Merge(m_Bounds[m_Indices[i]].GetCenter());
+
+		glm::vec3 size = centroids.Max - centroids.Min;
+		int axis = (size.x > size.y && size.x > size.z) ? 0 : (size.y > size.z ? 1 : 2);
+
+		unsigned int half = count / 2;
+		std::nth_element(m_Indices.begin() + first, m_Indices.begin() + first + half, m_Indices.begin() + first + count,
+			[this, axis](unsigned int a, unsigned int b) {
+				return m_Bounds[a].Min[axis] + m_Bounds[a].Max[axis] < m_Bounds[b].Min[axis] + m_Bounds[b].Max[axis];
+			});
+		return half;
+	};
+
+	if (count <= LeafSize)
+	{
+		ranges[rangeCount][0] = first;
+		ranges[rangeCount++][1] = count;
+	}
+	else
+	{
+		unsigned int half = split(first, count);
+		unsigned int halves[2][2] = { { first, half }, { first + half, count - half } };
+		for (auto& h : halves)
+		{
+			if (h[1] <= LeafSize)
+			{
+				ranges[rangeCount][0] = h[0];
+				ranges[rangeCount++][1] = h[1];
+				continue;
+			}
+			unsigned int quarter = split(h[0], h[1]);
+			ranges[rangeCount][0] = h[0];
+			ranges[rangeCount++][1] = quarter;
+			ranges[rangeCount][0] = h[0] + quarter;
+			ranges[rangeCount++][1] = h[1] - quarter;
+		}
+	}
+
+	for (unsigned int slot = 0; slot < 4; slot++)
+	{
+		//m_Nodes can reallocate while building children, so index it again every time
+		if (slot >= rangeCount)
+		{
+			Node& node = m_Nodes[nodeIndex];
+			node.Child[slot] = -1;
+			node.First[slot] = 0;
+			node.Count[slot] = 0;
+			SetSlotBounds(node, slot, BoundingBox());
+			continue;
+		}
+
+		unsigned int childFirst = ranges[slot][0];
+		unsigned int childCount = ranges[slot][1];
+		int child = -1;
+		if (childCount > LeafSize)
+			child = BuildNode(childFirst, childCount, nodeIndex * 4 + (int)slot);
+		else
+			for (unsigned int i = childFirst; i < childFirst + childCount; i++)
+				m_Leaves[m_Indices[i]] = nodeIndex * 4 + slot;
+
+		Node& node = m_Nodes[nodeIndex];
+		node.Child[slot] = child;
+		node.First[slot] = childFirst;
+		node.Count[slot] = childCount;
+		SetSlotBounds(node, slot, ComputeRangeBounds(childFirst, childCount));
+	}
+
+	return nodeIndex;
+}
+
+void Bvh::Update(unsigned int object, const BoundingBox& bounds)
+{
+	m_Bounds[object] = bounds;
+	WriteLeafBounds(m_Positions[object], bounds);
+
+	//mark the leaf's node and its ancestors, stop at the first one that is already dirty
+	int node = (int)(m_Leaves[object] / 4);
+	while (node >= 0 && !m_Dirty[node])
+	{
+		m_Dirty[node] = 1;
+		int parent = m_Parents[node];
+		node = parent < 0 ? -1 : parent / 4;
+	}
+}
+
+void Bvh::Refit()
+{
+	//children are always created after their parent, so walking the nodes backwards refits bottom up
+	for (int i = (int)m_Nodes.size() - 1; i >= 0; i--)
+	{
+		if (!m_Dirty[i])
+			continue;
+
+		Node& node = m_Nodes[i];
+		for (unsigned int slot = 0; slot < 4; slot++)
+		{
+			if (node.Count[slot] == 0)
+				continue;
+
+			BoundingBox box;
+			if (node.Child[slot] < 0)
+				box = ComputeRangeBounds(node.First[slot], node.Count[slot]);
+			else
+			{
+				const Node& child = m_Nodes[node.Child[slot]];
+				for (unsigned int c = 0; c < 4; c++)
+					if (child.Count[c])
+						box.Merge(GetSlotBounds(child, c));
+			}
+			SetSlotBounds(node, slot, box);
+		}
+		m_Dirty[i] = 0;
+	}
+}
+
+void Bvh::Cull(const Frustum& frustum, std::vector<unsigned int>& visible) const
+{
+	visible.clear();
+	if (m_Nodes.empty())
+		return;
+
+	//depth is about log4(objects / LeafSize), 64 entries is plenty for any scene that fits in memory
+	int stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = m_Nodes[stack[--stackSize]];
+
+		int inside;
+		int mask = TestBoxes4(frustum, node.MinX, node.MinY, node.MinZ, node.MaxX, node.MaxY, node.MaxZ, inside);
+
+		for (unsigned int slot = 0; slot < 4; slot++)
+		{
+			if (!(mask & (1 << slot)) || node.Count[slot] == 0)
+				continue;
+
+			//the whole subtree is inside, no need to test anything below it
+			if (inside & (1 << slot))
+				visible.insert(visible.end(), m_Indices.begin() + node.First[slot], m_Indices.begin() + node.First[slot] + node.Count[slot]);
+			else if (node.Child[slot] < 0)
+				CullLeaf(frustum, node.First[slot], node.Count[slot], visible);
+			else
+				stack[stackSize++] = node.Child[slot];
+		}
+	}
+}
+
+void Bvh::CullLeaf(const Frustum& frustum, unsigned int first, unsigned int count, std::vector<unsigned int>& visible) const
+{
+#if defined(SIMD_AVX)
+	const unsigned int batch = 8;
+#else
+	const unsigned int batch = 4;
+#endif
+
+	for (unsigned int offset = 0; offset < count; offset += batch)
+	{
+		unsigned int i = first + offset;
+#if defined(SIMD_AVX)
+		int mask = TestBoxes8(frustum, &m_MinX[i], &m_MinY[i], &m_MinZ[i], &m_MaxX[i], &m_MaxY[i], &m_MaxZ[i]);
+#else
+		int inside;
+		int mask = TestBoxes4(frustum, &m_MinX[i], &m_MinY[i], &m_MinZ[i], &m_MaxX[i], &m_MaxY[i], &m_MaxZ[i], inside);
+#endif
+		//drop the lanes past the end of the leaf
+		unsigned int lanes = count - offset < batch ? count - offset : batch;
+		mask &= (1 << lanes) - 1;
+
+		for (unsigned int lane = 0; lane < lanes; lane++)
+			if (mask & (1 << lane))
+				visible.push_back(m_Indices[i + lane]);
+	}
+}
+
+void Bvh::SetSlotBounds(Node& node, unsigned int slot, const BoundingBox& box)
+{
+	node.MinX[slot] = box.Min.x; node.MinY[slot] = box.Min.y; node.MinZ[slot] = box.Min.z;
+	node.MaxX[slot] = box.Max.x; node.MaxY[slot] = box.Max.y; node.MaxZ[slot] = box.Max.z;
+}
+
+BoundingBox Bvh::GetSlotBounds(const Node& node, unsigned int slot) const
+{
+	return { glm::vec3(node.MinX[slot], node.MinY[slot], node.MinZ[slot]), glm::vec3(node.MaxX[slot], node.MaxY[slot], node.MaxZ[slot]) };
+}
+
+BoundingBox Bvh::ComputeRangeBounds(unsigned int first, unsigned int count) const
+{
+	BoundingBox box;
+	for (unsigned int i = first; i < first + count; i++)
+		box.Merge(m_Bounds[m_Indices[i]]);
+	return box;
+}
+
+void Bvh::WriteLeafBounds(unsigned int position, const BoundingBox& box)
+{
+	m_MinX[position] = box.Min.x; m_MinY[position] = box.Min.y; m_MinZ[position] = box.Min.z;
+	m_MaxX[position] = box.Max.x; m_MaxY[position] = box.Max.y; m_MaxZ[position] = box.Max.z;
+}
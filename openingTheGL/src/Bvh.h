@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+
+#include "Simd.h"
+#include "BoundingBox.h"
+#include "Frustum.h"
+
+//A 4-wide bounding volume hierarchy over the objects of a scene, used to frustum cull them before they reach Renderer::Draw
+//Every node stores the bounds of its 4 children as a structure of arrays, so a single SSE test checks all 4 children at once,
+//and leaves are tested 8 (AVX) or 4 (SSE) objects at a time from the same SoA layout
+//
+//Objects are referred to by the index they had in the vector handed to Build()
+class Bvh
+{
+public:
+	//objects per leaf, a leaf is tested in one or two SIMD batches
+	static const unsigned int LeafSize = 8;
+
+	Bvh();
+
+	//(Re)builds the whole tree, top down with a median split on the longest axis
+	void Build(const std::vector<BoundingBox>& bounds);
+
+	//Moves an object, the tree is only marked dirty here, call Refit() once all objects of the frame have been updated
+	void Update(unsigned int object, const BoundingBox& bounds);
+
+	//Recomputes the bounds of the nodes above objects that moved since the last refit, bottom up
+	//The topology is kept, so a refit is much cheaper than a Build() but the tree gets looser if objects move far
+	void Refit();
+
+	//Fills "visible" with the indices of every object intersecting the frustum (the list is cleared first)
+	void Cull(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_Bounds.size(); }
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+	inline const BoundingBox& GetBounds(unsigned int object) const { return m_Bounds[object]; }
+
+private:
+	struct SIMD_ALIGN Node
+	{
+		//child bounds as structure of arrays, one lane per child
+		float MinX[4], MinY[4], MinZ[4];
+		float MaxX[4], MaxY[4], MaxZ[4];
+		//>= 0: index of the child node, -1: the child is a leaf
+		int Child[4];
+		//range of m_Indices covered by the child (the whole subtree for an inner child), Count 0 is an empty slot
+		unsigned int First[4];
+		unsigned int Count[4];
+	};
+
+	std::vector<Node> m_Nodes;
+	//parent of each node, as parent * 4 + slot, -1 for the root
+	std::vector<int> m_Parents;
+	std::vector<unsigned char> m_Dirty;
+
+	//object bounds in the order they were handed in
+	std::vector<BoundingBox> m_Bounds;
+	//objects sorted so that every leaf (and every subtree) covers a contiguous range
+	std::vector<unsigned int> m_Indices;
+	//position of every object in m_Indices, and the leaf (node * 4 + slot) holding it
+	std::vector<unsigned int> m_Positions;
+	std::vector<unsigned int> m_Leaves;
+	//object bounds in m_Indices order, as structure of arrays for the batched leaf test
+	//padded by LeafSize so a full batch can always be loaded
+	std::vector<float> m_MinX, m_MinY, m_MinZ;
+	std::vector<float> m_MaxX, m_MaxY, m_MaxZ;
+
+	int BuildNode(unsigned int first, unsigned int count, int parent);
+	void SetSlotBounds(Node& node, unsigned int slot, const BoundingBox& box);
+	BoundingBox GetSlotBounds(const Node& node, unsigned int slot) const;
+	BoundingBox ComputeRangeBounds(unsigned int first, unsigned int count) const;
+	void WriteLeafBounds(unsigned int position, const BoundingBox& box);
+	void CullLeaf(const Frustum& frustum, unsigned int first, unsigned int count, std::vector<unsigned int>& visible) const;
+};
@@ -0,0 +1,68 @@
+#include "CommandList.h"
+#include <cstring>
+
+void CommandList::Clear()
+{
+	//clear keeps the capacity, so a list reused every frame stops allocating after the first few frames
+	m_Draws.clear();
+	m_Uniforms.clear();
+	m_UniformData.clear();
+	m_PendingUniforms = 0;
+}
+
+void CommandList::PushUniform(int location, UniformType type, const float* data, unsigned int count)
+{
+	m_Uniforms.push_back({ location, type, (unsigned int)m_UniformData.size() });
+	m_UniformData.insert(m_UniformData.end(), data, data + count);
+}
+
+void CommandList::SetUniform1i(int location, int value)
+{
+	float bits;
+	memcpy(&bits, &value, sizeof(int));
+	PushUniform(location, UniformType::Int, &bits, 1);
+}
+
+void CommandList::SetUniform1f(int location, float value)
+{
+	PushUniform(location, UniformType::Float, &value, 1);
+}
+
+void CommandList::SetUniform4f(int location, float v0, float v1, float v2, float v3)
+{
+	float values[] = { v0, v1, v2, v3 };
+	PushUniform(location, UniformType::Vec4, values, 4);
+}
+
+void CommandList::SetUniformMat4f(int location, const glm::mat4& matrix)
+{
+	PushUniform(location, UniformType::Mat4, &matrix[0][0], 16);
+}
+
+void CommandList::Draw(uint64_t sortKey, const VertexArray& va, const IndexBuffer& ib, const Shader& shader)
+{
+	unsigned int uniformCount = (unsigned int)m_Uniforms.size() - m_PendingUniforms;
+	m_Draws.push_back({ sortKey, &va, &ib, &shader, m_PendingUniforms, uniformCount });
+	m_PendingUniforms = (unsigned int)m_Uniforms.size();
+}
+
+//depth in [0, 1] as 24 bits
+static uint64_t QuantizeDepth(float depth)
+{
+	if (depth < 0.0f) depth = 0.0f;
+	if (depth > 1.0f) depth = 1.0f;
+	return (uint64_t)(depth * 16777215.0f);
+}
+
+uint64_t CommandList::MakeSortKey(unsigned int layer, unsigned int shaderID, unsigned int meshID, float depth)
+{
+	//| layer 8 bits | transparent 1 bit (0) | shader 15 bits | mesh 16 bits | depth 24 bits |
+	return ((uint64_t)(layer & 0xFF) << 56) | ((uint64_t)(shaderID & 0x7FFF) << 40) | ((uint64_t)(meshID & 0xFFFF) << 24) | QuantizeDepth(depth);
+}
+
+uint64_t CommandList::MakeTransparentSortKey(unsigned int layer, unsigned int shaderID, unsigned int meshID, float depth)
+{
+	//| layer 8 bits | transparent 1 bit (1) | far to near depth 24 bits | shader 15 bits | mesh 16 bits |
+	return ((uint64_t)(layer & 0xFF) << 56) | TransparentBit | ((0xFFFFFF - QuantizeDepth(depth)) << 31) |
+		((uint64_t)(shaderID & 0x7FFF) << 16) | (uint64_t)(meshID & 0xFFFF);
+}
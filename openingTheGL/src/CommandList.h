@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+
+//A CPU side list of draws that can be recorded on any thread, it never touches OpenGL
+//Worker threads each record into their own list (culling, sort keys, uniform packing), then the thread owning
+//the GL context hands all of them to Renderer::Submit, which merges them by sort key and replays them
+//
+//Uniforms are recorded by location (get it once on the GL thread with Shader::GetUniformLocation),
+//every uniform set before a Draw belongs to that draw and is uploaded right before it
+class CommandList
+{
+public:
+	enum class UniformType : unsigned char
+	{
+		Int, Float, Vec4, Mat4
+	};
+
+	struct UniformCommand
+	{
+		int Location;
+		UniformType Type;
+		//index of the first float (or int) of the value in the uniform data
+		unsigned int Offset;
+	};
+
+	struct DrawCommand
+	{
+		uint64_t SortKey;
+		const VertexArray* VA;
+		const IndexBuffer* IB;
+		const Shader* Program;
+		unsigned int FirstUniform;
+		unsigned int UniformCount;
+	};
+
+	void Clear();
+
+	void SetUniform1i(int location, int value);
+	void SetUniform1f(int location, float value);
+	void SetUniform4f(int location, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(int location, const glm::mat4& matrix);
+
+	void Draw(uint64_t sortKey, const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+
+	//Draws are submitted in ascending key order, first by layer and within a layer the opaque draws before the transparent ones
+	//depth is expected in [0, 1] (0 is nearest), anything outside is clamped
+	//opaque: grouped by shader and mesh to save binds, then front to back, so with depth testing hidden pixels fail early
+	static uint64_t MakeSortKey(unsigned int layer, unsigned int shaderID, unsigned int meshID, float depth);
+	//transparent: back to front before anything else, they blend over what is behind them and don't write depth (see Renderer)
+	static uint64_t MakeTransparentSortKey(unsigned int layer, unsigned int shaderID, unsigned int meshID, float depth);
+	static inline bool IsTransparent(uint64_t sortKey) { return (sortKey & TransparentBit) != 0; }
+	static inline unsigned int GetLayer(uint64_t sortKey) { return (unsigned int)(sortKey >> 56); }
+
+	inline const std::vector<DrawCommand>& GetDraws() const { return m_Draws; }
+	inline const std::vector<UniformCommand>& GetUniforms() const { return m_Uniforms; }
+	inline const std::vector<float>& GetUniformData() const { return m_UniformData; }
+
+private:
+	static const uint64_t TransparentBit = 1ull << 55;
+
+	std::vector<DrawCommand> m_Draws;
+	std::vector<UniformCommand> m_Uniforms;
+	//all uniform values packed one after the other, ints are stored bit for bit in the floats
+	std::vector<float> m_UniformData;
+	//first uniform not yet claimed by a draw
+	unsigned int m_PendingUniforms = 0;
+
+	void PushUniform(int location, UniformType type, const float* data, unsigned int count);
+};
@@ -0,0 +1,288 @@
+#include "DebugDraw.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+
+#include "imgui/imgui.h"
+
+static uint32_t PackColor(const glm::vec4& color)
+{
+	glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+	return (uint32_t)clamped.r | (uint32_t)clamped.g << 8 | (uint32_t)clamped.b << 16 | (uint32_t)clamped.a << 24;
+}
+
+//corner i of a box has bit 0 for max x, bit 1 for max y, bit 2 for max z, an edge joins corners one bit apart
+static const unsigned char BoxEdges[12][2] = {
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+	{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+};
+
+DebugDraw::DebugDraw(const std::string& shaderPath)
+	: m_Capacity(MinCapacity), m_LineCount(0), m_LineHeight(0)
+{
+	m_Shader = std::make_unique<Shader>(shaderPath);
+	m_VertexBuffer = std::make_unique<VertexBuffer>((unsigned int)(m_Capacity * sizeof(LineVertex)));
+	m_VertexArray = std::make_unique<VertexArray>();
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	layout.Push<short>(2);
+	layout.Push<unsigned char>(4);
+	m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
+
+	for (unsigned int i = 0; i <= CircleSegments; i++)
+	{
+		float angle = 6.2831853f * i / CircleSegments;
+		m_Circle[i] = glm::vec2(std::cos(angle), std::sin(angle));
+	}
+	LoadFont();
+}
+
+DebugDraw::~DebugDraw()
+{
+}
+
+void DebugDraw::LoadFont()
+{
+	//ProggyClean is a pixel font, at its own 13 px every glyph pixel is either set or not
+	ImFontAtlas atlas;
+	ImFont* font = atlas.AddFontDefault();
+	unsigned char* pixels;
+	int width, height;
+	atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+	m_LineHeight = (int16_t)std::ceil(font->FontSize);
+
+	for (unsigned int i = 0; i < GlyphCount; i++)
+	{
+		Glyph& glyph = m_Glyphs[i];
+		glyph.FirstRun = (unsigned int)m_Runs.size();
+		glyph.RunCount = 0;
+		glyph.Advance = 0;
+
+		const ImFontGlyph* source = font->FindGlyphNoFallback((ImWchar)(FirstGlyph + i));
+		if (!source)
+			continue;
+		glyph.Advance = (int16_t)std::lround(source->AdvanceX);
+
+		int x0 = (int)std::lround(source->U0 * width), y0 = (int)std::lround(source->V0 * height);
+		int x1 = (int)std::lround(source->U1 * width), y1 = (int)std::lround(source->V1 * height);
+		for (int y = y0; y < y1; y++)
+		{
+			const unsigned char* row = pixels + (size_t)y * width;
+			for (int x = x0; x < x1;)
+			{
+				if (row[x] < 128)
+				{
+					x++;
+					continue;
+				}
+				int start = x;
+				while (x < x1 && row[x] >= 128)
+					x++;
+				int16_t left = (int16_t)std::lround(source->X0) + (int16_t)(start - x0);
+				int16_t top = (int16_t)std::lround(source->Y0) + (int16_t)(y - y0);
+				m_Runs.push_back({ left, (int16_t)(left + x - start), top });
+				glyph.RunCount++;
+			}
+		}
+	}
+}
+
+DebugDraw::LineVertex* DebugDraw::Append(bool depthTest, size_t count)
+{
+	std::vector<LineVertex>& lines = m_Lines[depthTest ? 0 : 1];
+	size_t size = lines.size();
+	lines.resize(size + count);
+	return lines.data() + size;
+}
+
+void DebugDraw::Line(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, bool depthTest)
+{
+	uint32_t packed = PackColor(color);
+	LineVertex* vertex = Append(depthTest, 2);
+	vertex[0] = { from.x, from.y, from.z, 0, 0, packed };
+	vertex[1] = { to.x, to.y, to.z, 0, 0, packed };
+}
+
+void DebugDraw::Box(const BoundingBox& box, const glm::vec4& color, bool depthTest)
+{
+	if (box.IsEmpty())
+		return;
+
+	uint32_t packed = PackColor(color);
+	LineVertex* vertex = Append(depthTest, 24);
+	for (unsigned int i = 0; i < 12; i++)
+	{
+		for (unsigned int j = 0; j < 2; j++)
+		{
+			unsigned char corner = BoxEdges[i][j];
+			*vertex++ = { corner & 1 ? box.Max.x : box.Min.x, corner & 2 ? box.Max.y : box.Min.y, corner & 4 ? box.Max.z : box.Min.z, 0, 0, packed };
+		}
+	}
+}
+
+void DebugDraw::Sphere(const glm::vec3& center, float radius, const glm::vec4& color, bool depthTest)
+{
+	uint32_t packed = PackColor(color);
+	LineVertex* vertex = Append(depthTest, 3 * CircleSegments * 2);
+	for (unsigned int axis = 0; axis < 3; axis++)
+	{
+		for (unsigned int i = 0; i < CircleSegments; i++)
+		{
+			for (unsigned int j = 0; j < 2; j++)
+			{
+				glm::vec2 point = m_Circle[i + j] * radius;
+				glm::vec3 position = center;
+				position[(axis + 1) % 3] += point.x;
+				position[(axis + 2) % 3] += point.y;
+				*vertex++ = { position.x, position.y, position.z, 0, 0, packed };
+			}
+		}
+	}
+}
+
+void DebugDraw::Frustum(const glm::mat4& viewProjection, const glm::vec4& color, bool depthTest)
+{
+	//the corners of the clip space cube back in world space, in the same bit order as Box
+	glm::mat4 inverse = glm::inverse(viewProjection);
+	glm::vec3 corners[8];
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner = inverse * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+		corners[i] = glm::vec3(corner) / corner.w;
+	}
+
+	uint32_t packed = PackColor(color);
+	LineVertex* vertex = Append(depthTest, 24);
+	for (unsigned int i = 0; i < 12; i++)
+	{
+		for (unsigned int j = 0; j < 2; j++)
+		{
+			const glm::vec3& corner = corners[BoxEdges[i][j]];
+			*vertex++ = { corner.x, corner.y, corner.z, 0, 0, packed };
+		}
+	}
+}
+
+void DebugDraw::Arrow(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, bool depthTest)
+{
+	glm::vec3 direction = to - from;
+	float length = glm::length(direction);
+	if (length <= 0.0f)
+		return;
+	direction /= length;
+
+	//two directions across the arrow, for a head of four lines a fifth of its length
+	glm::vec3 helper = std::abs(direction.y) < 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+	glm::vec3 side = glm::normalize(glm::cross(direction, helper));
+	glm::vec3 up = glm::cross(side, direction);
+	float head = length * 0.2f;
+	glm::vec3 base = to - direction * head;
+	glm::vec3 tips[4] = { base + side * head * 0.5f, base - side * head * 0.5f, base + up * head * 0.5f, base - up * head * 0.5f };
+
+	uint32_t packed = PackColor(color);
+	LineVertex* vertex = Append(depthTest, 10);
+	vertex[0] = { from.x, from.y, from.z, 0, 0, packed };
+	vertex[1] = { to.x, to.y, to.z, 0, 0, packed };
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		vertex[2 + i * 2] = { to.x, to.y, to.z, 0, 0, packed };
+		vertex[3 + i * 2] = { tips[i].x, tips[i].y, tips[i].z, 0, 0, packed };
+	}
+}
+
+void DebugDraw::Label(const glm::vec3& position, const std::string& text, const glm::vec4& color, bool depthTest)
+{
+	uint32_t packed = PackColor(color);
+	int16_t penX = 1, penY = 1;
+	for (char c : text)
+	{
+		if (c == '\n')
+		{
+			penX = 1;
+			penY += m_LineHeight;
+			continue;
+		}
+		unsigned int index = (unsigned char)c - FirstGlyph;
+		if (index >= GlyphCount)
+			index = '?' - FirstGlyph;
+		const Glyph& glyph = m_Glyphs[index];
+
+		//pixel y goes up, the text down from the point, so every offset is below it and none is (0, 0) like a line's
+		LineVertex* vertex = Append(depthTest, glyph.RunCount * 2);
+		for (unsigned int i = 0; i < glyph.RunCount; i++)
+		{
+			const Run& run = m_Runs[glyph.FirstRun + i];
+			int16_t y = -(penY + run.Y);
+			vertex[i * 2] = { position.x, position.y, position.z, (int16_t)(penX + run.X0), y, packed };
+			vertex[i * 2 + 1] = { position.x, position.y, position.z, (int16_t)(penX + run.X1), y, packed };
+		}
+		penX += glyph.Advance;
+	}
+}
+
+void DebugDraw::Flush(const glm::mat4& viewProjection, const glm::vec2& viewportSize, bool depthTest)
+{
+	size_t depthCount = m_Lines[0].size(), overlayCount = m_Lines[1].size();
+	m_LineCount = (unsigned int)((depthCount + overlayCount) / 2);
+	if (depthCount + overlayCount == 0)
+		return;
+
+	//SetData orphans the whole buffer, so after a busy frame it shrinks again, not before it is 4 times too big
+	size_t needed = depthCount + overlayCount;
+	if (needed > m_Capacity || (m_Capacity > MinCapacity && needed * 4 <= m_Capacity))
+	{
+		m_Capacity = MinCapacity;
+		while (m_Capacity < needed)
+			m_Capacity *= 2;
+		m_VertexBuffer = std::make_unique<VertexBuffer>((unsigned int)(m_Capacity * sizeof(LineVertex)));
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		layout.Push<short>(2);
+		layout.Push<unsigned char>(4);
+		m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
+	}
+
+	//both lists into the one buffer, the depth tested ones first
+	m_VertexBuffer->SetData(m_Lines[0].data(), (unsigned int)(depthCount * sizeof(LineVertex)));
+	if (overlayCount)
+		m_VertexBuffer->SetSubData((unsigned int)(depthCount * sizeof(LineVertex)), m_Lines[1].data(), (unsigned int)(overlayCount * sizeof(LineVertex)));
+
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4f("u_ViewProjection", viewProjection);
+	m_Shader->SetUniform2f("u_ViewportSize", viewportSize.x, viewportSize.y);
+	m_VertexArray->Bind();
+
+	GLCall(glDepthMask(GL_FALSE));
+	if (depthCount)
+	{
+		GLCall(glEnable(GL_DEPTH_TEST));
+		GLCall(glDrawArrays(GL_LINES, 0, (GLsizei)depthCount));
+		RenderStats::Add(RenderStats::DrawCalls);
+	}
+	if (overlayCount)
+	{
+		GLCall(glDisable(GL_DEPTH_TEST));
+		GLCall(glDrawArrays(GL_LINES, (GLint)depthCount, (GLsizei)overlayCount));
+		RenderStats::Add(RenderStats::DrawCalls);
+	}
+	//back to the state the caller declared, the overlay draw left depth testing off
+	if (depthTest)
+		GLCall(glEnable(GL_DEPTH_TEST));
+	else if (depthCount && !overlayCount)
+		GLCall(glDisable(GL_DEPTH_TEST));
+	GLCall(glDepthMask(GL_TRUE));
+
+	Clear();
+}
+
+void DebugDraw::Clear()
+{
+	//keeps the memory, the next frame has about as many lines
+	m_Lines[0].clear();
+	m_Lines[1].clear();
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "BoundingBox.h"
+
+class Shader;
+class VertexArray;
+class VertexBuffer;
+
+//Immediate mode debug drawing: lines, boxes, spheres, frusta, arrows and text labels, called from anywhere in a frame
+//
+//Every shape is appended as line segments to one of two lists, the depth tested one or the overlay, and Flush draws
+//both out of a single streaming vertex buffer: two draw calls however many shapes there are.
+//Labels are ImGui's built in pixel font turned into horizontal line runs, so they go into the same lists. They stay
+//the same size on screen and start a pixel right of and below the point they label.
+//
+//Recording is CPU only but not thread safe, Flush needs the GL thread. Expects alpha blending to be enabled.
+class DebugDraw
+{
+public:
+	DebugDraw(const std::string& shaderPath = "res/shaders/DebugDraw.shader");
+	~DebugDraw();
+
+	//depthTest false: drawn over the scene
+	void Line(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, bool depthTest = true);
+	void Box(const BoundingBox& box, const glm::vec4& color, bool depthTest = true);
+	//a circle around each axis
+	void Sphere(const glm::vec3& center, float radius, const glm::vec4& color, bool depthTest = true);
+	//the volume a camera sees, the edges of its clip space box
+	void Frustum(const glm::mat4& viewProjection, const glm::vec4& color, bool depthTest = true);
+	void Arrow(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, bool depthTest = true);
+	//ASCII, '\n' starts a new line
+	void Label(const glm::vec3& position, const std::string& text, const glm::vec4& color = glm::vec4(1.0f), bool depthTest = false);
+
+	//GL thread, draws what was recorded since the last Flush and starts over
+	//the depth tested lines don't write depth. depthTest is whether the caller has depth testing enabled, it is left
+	//that way with depth writes on, the state isn't read back with glGet every frame
+	void Flush(const glm::mat4& viewProjection, const glm::vec2& viewportSize, bool depthTest = false);
+	//drops what was recorded without drawing it, for a frame that is skipped
+	void Clear();
+
+	//line segments in the last Flush
+	inline unsigned int GetLineCount() const { return m_LineCount; }
+
+private:
+	//a label vertex has an offset in pixels from its position, a line vertex has none
+	struct LineVertex
+	{
+		float X, Y, Z;
+		int16_t OffsetX, OffsetY;
+		uint32_t Color;
+	};
+
+	//a row of set pixels in a glyph, from its top left
+	struct Run
+	{
+		int16_t X0, X1, Y;
+	};
+
+	struct Glyph
+	{
+		unsigned int FirstRun, RunCount;
+		int16_t Advance;
+	};
+
+	std::unique_ptr<Shader> m_Shader;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<VertexArray> m_VertexArray;
+	//vertices the buffer has room for, a power of two times MinCapacity that fits the last frame
+	static const size_t MinCapacity = 65536;
+	size_t m_Capacity;
+
+	std::vector<LineVertex> m_Lines[2];
+	unsigned int m_LineCount;
+
+	//the unit circle the spheres are made of
+	static const unsigned int CircleSegments = 32;
+	glm::vec2 m_Circle[CircleSegments + 1];
+
+	static const unsigned int FirstGlyph = 32, GlyphCount = 95;
+	Glyph m_Glyphs[GlyphCount];
+	std::vector<Run> m_Runs;
+	int16_t m_LineHeight;
+
+	//room for count more vertices, returns the first of them
+	LineVertex* Append(bool depthTest, size_t count);
+	void LoadFont();
+};
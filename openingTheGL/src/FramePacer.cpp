@@ -0,0 +1,183 @@
+#include "FramePacer.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+//running average, so the numbers shown in the UI don't flicker every frame
+static void Accumulate(std::atomic<float>& average, float value)
+{
+	average.store(average.load(std::memory_order_relaxed) * 0.95f + value * 0.05f, std::memory_order_relaxed);
+}
+
+static long long Nanoseconds(std::chrono::steady_clock::time_point time)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+FramePacer::FramePacer(GLFWwindow* window)
+	: m_Window(window), m_ModeApplied(false), m_ActiveMode(Mode::Vsync), m_Oldest(0), m_Pending(0), m_IntervalCount(0), m_IntervalNext(0),
+	m_FrameInterval(0.0f), m_Jitter(0.0f), m_Latency(0.0f), m_FenceWait(0.0f), m_LimiterWait(0.0f)
+{
+	for (Slot& slot : m_Slots)
+		slot = { nullptr, 0, std::chrono::steady_clock::time_point() };
+}
+
+FramePacer::~FramePacer()
+{
+	for (Slot& slot : m_Slots)
+	{
+		if (slot.Fence)
+			GLCall(glDeleteSync((GLsync)slot.Fence));
+		if (slot.TimestampQuery)
+			GLCall(glDeleteQueries(1, &slot.TimestampQuery));
+	}
+}
+
+const char* FramePacer::GetName(Mode mode)
+{
+	switch (mode)
+	{
+	case Mode::Vsync: return "Vsync";
+	case Mode::AdaptiveVsync: return "Adaptive vsync";
+	case Mode::Uncapped: return "Uncapped";
+	}
+	return "";
+}
+
+void FramePacer::SetSettings(const Settings& settings)
+{
+	bool modeChanged = !m_ModeApplied || settings.SwapMode != m_Settings.SwapMode;
+	m_Settings = settings;
+	m_Settings.MaxFramesInFlight = settings.MaxFramesInFlight < 1 ? 1 : (settings.MaxFramesInFlight > MaxSlots ? MaxSlots : settings.MaxFramesInFlight);
+	if (modeChanged)
+		ApplyMode();
+}
+
+void FramePacer::ApplyMode()
+{
+	Mode mode = m_Settings.SwapMode;
+	if (m_Window)
+	{
+		//a negative interval is adaptive vsync, only allowed with the extension
+		//https://www.glfw.org/docs/latest/group__context.html#ga6d4e0cdf151b5e579bd67f13202994ed
+		if (mode == Mode::AdaptiveVsync && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+			mode = Mode::Vsync;
+		glfwSwapInterval(mode == Mode::Vsync ? 1 : (mode == Mode::AdaptiveVsync ? -1 : 0));
+	}
+	m_ActiveMode.store(mode, std::memory_order_relaxed);
+	m_ModeApplied = true;
+	m_NextDeadline = std::chrono::steady_clock::now();
+}
+
+void FramePacer::EndFrame(std::chrono::steady_clock::time_point inputTime, bool afterSkip)
+{
+	PROFILE_FUNCTION();
+	RecordInterval(afterSkip);
+
+	//there is always a free slot here, the waits below leave at most MaxSlots - 1 frames in flight
+	Slot& slot = m_Slots[(m_Oldest + m_Pending) % MaxSlots];
+	if (!slot.TimestampQuery)
+		GLCall(glGenQueries(1, &slot.TimestampQuery));
+	//the GPU writes the time when it gets here, after everything the frame drew
+	GLCall(glQueryCounter(slot.TimestampQuery, GL_TIMESTAMP));
+	GLsync fence;
+	GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	slot.Fence = fence;
+	slot.InputTime = inputTime;
+	m_Pending++;
+
+	//the GPU's clock against the CPU's, to turn the timestamps into latencies
+	GLint64 gpuNow = 0;
+	GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuNow));
+	long long gpuToCpu = Nanoseconds(std::chrono::steady_clock::now()) - gpuNow;
+
+	auto waitStart = std::chrono::steady_clock::now();
+	while (m_Pending > 0 && Retire(false, gpuToCpu))
+		;
+	while (m_Pending >= m_Settings.MaxFramesInFlight)
+		Retire(true, gpuToCpu);
+	auto waitEnd = std::chrono::steady_clock::now();
+	Accumulate(m_FenceWait, std::chrono::duration<float, std::milli>(waitEnd - waitStart).count());
+
+	Limit();
+	Accumulate(m_LimiterWait, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - waitEnd).count());
+}
+
+bool FramePacer::Retire(bool wait, long long gpuToCpu)
+{
+	Slot& slot = m_Slots[m_Oldest];
+
+	//the flush bit makes sure the fence gets to the GPU at all, or a wait for it could never end
+	GLenum status;
+	GLCall(status = glClientWaitSync((GLsync)slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0));
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+	GLCall(glDeleteSync((GLsync)slot.Fence));
+	slot.Fence = nullptr;
+
+	//nothing is known about the frame then, reading its timestamp could block forever
+	if (status == GL_WAIT_FAILED)
+		std::cout << "FramePacer: waiting for a frame's fence failed, its latency isn't recorded\n";
+	else
+	{
+		//the timestamp is in front of the fence, it is there by now
+		GLuint64 done = 0;
+		GLCall(glGetQueryObjectui64v(slot.TimestampQuery, GL_QUERY_RESULT, &done));
+		long long latency = (long long)done + gpuToCpu - Nanoseconds(slot.InputTime);
+		Accumulate(m_Latency, latency > 0 ? latency / 1000000.0f : 0.0f);
+	}
+
+	m_Oldest = (m_Oldest + 1) % MaxSlots;
+	m_Pending--;
+	return true;
+}
+
+void FramePacer::Limit()
+{
+	if (m_ActiveMode.load(std::memory_order_relaxed) != Mode::Uncapped || m_Settings.TargetFps <= 0.0f)
+		return;
+
+	PROFILE_SCOPE("Limiter");
+	auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_Settings.TargetFps));
+	auto now = std::chrono::steady_clock::now();
+	//a frame that came in late moves the schedule instead of the next ones catching up on it
+	if (m_NextDeadline + period < now)
+		m_NextDeadline = now;
+
+	//sleeping is only good to a millisecond or so, the rest is spent yielding
+	auto spinFrom = m_NextDeadline - std::chrono::milliseconds(2);
+	if (now < spinFrom)
+		std::this_thread::sleep_until(spinFrom);
+	while (std::chrono::steady_clock::now() < m_NextDeadline)
+		std::this_thread::yield();
+	m_NextDeadline += period;
+}
+
+void FramePacer::RecordInterval(bool afterSkip)
+{
+	auto now = std::chrono::steady_clock::now();
+	bool first = m_LastSwap == std::chrono::steady_clock::time_point();
+	auto last = m_LastSwap;
+	m_LastSwap = now;
+	if (first || afterSkip)
+		return;
+
+	m_Intervals[m_IntervalNext] = std::chrono::duration<float, std::milli>(now - last).count();
+	m_IntervalNext = (m_IntervalNext + 1) % IntervalHistory;
+	if (m_IntervalCount < IntervalHistory)
+		m_IntervalCount++;
+
+	float mean = 0.0f;
+	for (unsigned int i = 0; i < m_IntervalCount; i++)
+		mean += m_Intervals[i];
+	mean /= m_IntervalCount;
+	float variance = 0.0f;
+	for (unsigned int i = 0; i < m_IntervalCount; i++)
+		variance += (m_Intervals[i] - mean) * (m_Intervals[i] - mean);
+	m_FrameInterval.store(mean, std::memory_order_relaxed);
+	m_Jitter.store(std::sqrt(variance / m_IntervalCount), std::memory_order_relaxed);
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+
+struct GLFWwindow;
+
+//Decides when frames go out and keeps the CPU from running ahead of the GPU
+//
+//After every swap the frame gets a fence, and EndFrame waits until fewer than MaxFramesInFlight frames are still unfinished
+//on the GPU before the next input is read. The driver would otherwise queue several frames, and every queued frame is
+//a frame more between input and the screen. 1 is the lowest latency, CPU and GPU never work on different frames then,
+//3 the smoothest when frame times vary.
+//The swap interval comes from the mode:
+//	Vsync: every swap waits for the vertical blank
+//	AdaptiveVsync: like Vsync, but a late frame is swapped right away and tears instead of waiting a whole refresh
+//		(EXT_swap_control_tear, Vsync without it)
+//	Uncapped: no waiting on the display, the limiter sleeps after the swap to keep to TargetFps (0 for no limit)
+//Without a window (headless) there is no swap interval, the fences and the limiter still work.
+//
+//Frame to frame jitter is the standard deviation of the time between swaps over the last IntervalHistory frames.
+//Latency is from when the input was read to when the GPU finished the frame, from a GL_TIMESTAMP query next to the fence.
+//GL thread only, apart from the getters.
+class FramePacer
+{
+public:
+	enum class Mode
+	{
+		Vsync, AdaptiveVsync, Uncapped
+	};
+
+	struct Settings
+	{
+		Mode SwapMode = Mode::Vsync;
+		//1 to MaxSlots
+		unsigned int MaxFramesInFlight = 2;
+		float TargetFps = 0.0f;
+	};
+
+	static const unsigned int MaxSlots = 3;
+	static const unsigned int IntervalHistory = 120;
+
+	FramePacer(GLFWwindow* window);
+	~FramePacer();
+
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	//sets the swap interval when the mode changed, GL thread
+	void SetSettings(const Settings& settings);
+	inline const Settings& GetSettings() const { return m_Settings; }
+	//the mode the swap interval is set for, Vsync when adaptive vsync was asked for but isn't supported
+	inline Mode GetActiveMode() const { return m_ActiveMode.load(std::memory_order_relaxed); }
+
+	//right after the swap (or where it would be): fences the frame, waits for the GPU and runs the limiter
+	//inputTime is when the input this frame reacts to was read
+	//afterSkip: frames were skipped since the last EndFrame, the idle gap isn't counted as a frame interval
+	void EndFrame(std::chrono::steady_clock::time_point inputTime, bool afterSkip = false);
+
+	//in ms, averaged over the last frames
+	inline float GetFrameInterval() const { return m_FrameInterval.load(std::memory_order_relaxed); }
+	inline float GetJitter() const { return m_Jitter.load(std::memory_order_relaxed); }
+	inline float GetLatency() const { return m_Latency.load(std::memory_order_relaxed); }
+	//time spent waiting on fences and in the limiter, per frame
+	inline float GetFenceWait() const { return m_FenceWait.load(std::memory_order_relaxed); }
+	inline float GetLimiterWait() const { return m_LimiterWait.load(std::memory_order_relaxed); }
+
+	static const char* GetName(Mode mode);
+
+private:
+	struct Slot
+	{
+		//a GLsync, kept opaque so this header doesn't need GL
+		void* Fence;
+		unsigned int TimestampQuery;
+		std::chrono::steady_clock::time_point InputTime;
+	};
+
+	GLFWwindow* m_Window;
+	Settings m_Settings;
+	bool m_ModeApplied;
+	std::atomic<Mode> m_ActiveMode;
+
+	//frames the GPU hasn't finished yet, oldest first in the ring
+	Slot m_Slots[MaxSlots];
+	unsigned int m_Oldest;
+	unsigned int m_Pending;
+
+	std::chrono::steady_clock::time_point m_LastSwap;
+	std::chrono::steady_clock::time_point m_NextDeadline;
+	float m_Intervals[IntervalHistory];
+	unsigned int m_IntervalCount;
+	unsigned int m_IntervalNext;
+
+	std::atomic<float> m_FrameInterval;
+	std::atomic<float> m_Jitter;
+	std::atomic<float> m_Latency;
+	std::atomic<float> m_FenceWait;
+	std::atomic<float> m_LimiterWait;
+
+	void ApplyMode();
+	//waits for the oldest frame in flight and records its latency, or only checks on it when wait is false
+	//true when it was done (or the wait failed, the frame is retired without a latency then)
+	bool Retire(bool wait, long long gpuToCpuOffset);
+	void Limit();
+	//only starts a new interval when afterSkip
+	void RecordInterval(bool afterSkip);
+};
@@ -0,0 +1,127 @@
+#include "FrameSkipper.h"
+
+#include <cstring>
+
+#include <GLFW/glfw3.h>
+#include "imgui/imgui.h"
+
+//8 bytes at a time, the draw data of a busy UI is a few hundred KB every frame
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+		hash ^= hash >> 29;
+	}
+	uint64_t tail = 0;
+	if (i < size)
+		std::memcpy(&tail, bytes + i, size - i);
+	hash = (hash ^ tail ^ size) * 0x9e3779b97f4a7c15ull;
+	return hash ^ (hash >> 29);
+}
+
+FrameSkipper::FrameSkipper(GLFWwindow* window, float maxAnimationFps)
+	: m_Window(window), m_MaxAnimationFps(maxAnimationFps), m_LastHash(0), m_LastRendered(false), m_Damaged(true),
+	m_LastRenderTime(std::chrono::steady_clock::now()), m_RenderedFrames(0), m_SkippedFrames(0)
+{
+	if (m_Window)
+	{
+		glfwSetWindowUserPointer(m_Window, this);
+		glfwSetWindowRefreshCallback(m_Window, OnRefresh);
+	}
+}
+
+FrameSkipper::~FrameSkipper()
+{
+	if (m_Window)
+	{
+		glfwSetWindowRefreshCallback(m_Window, nullptr);
+		glfwSetWindowUserPointer(m_Window, nullptr);
+	}
+}
+
+void FrameSkipper::OnRefresh(GLFWwindow* window)
+{
+	if (FrameSkipper* skipper = (FrameSkipper*)glfwGetWindowUserPointer(window))
+		skipper->m_Damaged = true;
+}
+
+bool FrameSkipper::WaitForEvents(bool animating)
+{
+	if (!m_Window)
+		return false;
+
+	//settling after a rendered frame, or due for the next animation frame
+	if (m_LastRendered && !animating)
+	{
+		glfwPollEvents();
+		return false;
+	}
+	if (!animating)
+	{
+		glfwWaitEvents();
+		return true;
+	}
+
+	double interval = m_MaxAnimationFps > 0.0f ? 1.0 / m_MaxAnimationFps : 0.0;
+	double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_LastRenderTime).count();
+	if (waited >= interval)
+	{
+		glfwPollEvents();
+		return false;
+	}
+	glfwWaitEventsTimeout(interval - waited);
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_LastRenderTime).count() < interval;
+}
+
+bool FrameSkipper::ShouldRender(const ImDrawData& drawData, bool force)
+{
+	uint64_t hash = HashDrawData(drawData);
+	bool render = force || m_Damaged || hash != m_LastHash || m_RenderedFrames == 0;
+	m_LastHash = hash;
+	m_LastRendered = render;
+	m_Damaged = false;
+	if (render)
+	{
+		m_LastRenderTime = std::chrono::steady_clock::now();
+		m_RenderedFrames++;
+	}
+	else
+		m_SkippedFrames++;
+	return render;
+}
+
+uint64_t FrameSkipper::HashDrawData(const ImDrawData& drawData)
+{
+	float display[6] = { drawData.DisplayPos.x, drawData.DisplayPos.y, drawData.DisplaySize.x, drawData.DisplaySize.y,
+		drawData.FramebufferScale.x, drawData.FramebufferScale.y };
+	uint64_t hash = HashBytes(0xcbf29ce484222325ull, display, sizeof(display));
+	for (int n = 0; n < drawData.CmdListsCount; n++)
+	{
+		const ImDrawList* list = drawData.CmdLists[n];
+		hash = HashBytes(hash, list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+		hash = HashBytes(hash, list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx));
+		//not the whole command, its callback data may point at anything
+		for (const ImDrawCmd& command : list->CmdBuffer)
+		{
+			//plain floats, ImVec4 has a constructor so the struct couldn't be memset
+			struct { float ClipRect[4]; ImTextureID TextureId; const void* UserCallback; unsigned int VtxOffset, IdxOffset, ElemCount; } key;
+			std::memset(&key, 0, sizeof(key)); //the padding is hashed too
+			key.ClipRect[0] = command.ClipRect.x;
+			key.ClipRect[1] = command.ClipRect.y;
+			key.ClipRect[2] = command.ClipRect.z;
+			key.ClipRect[3] = command.ClipRect.w;
+			key.TextureId = command.TextureId;
+			key.UserCallback = (const void*)command.UserCallback;
+			key.VtxOffset = command.VtxOffset;
+			key.IdxOffset = command.IdxOffset;
+			key.ElemCount = command.ElemCount;
+			hash = HashBytes(hash, &key, sizeof(key));
+		}
+	}
+	return hash;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+struct GLFWwindow;
+struct ImDrawData;
+
+//Event driven redraw for tool style sessions: a frame is only rendered and swapped when it would look different from the last one
+//
+//The main loop calls WaitForEvents instead of glfwPollEvents, builds the frame as usual and then asks ShouldRender, which hashes
+//ImGui's draw data and compares it with the frame that was rendered last. The scene isn't in the draw data, so the caller
+//forces frames it changed. After a rendered frame the next one is built without waiting, ImGui takes a frame or two to settle
+//after input (hover highlights, opening windows), and only once a frame comes out identical does the loop block on events.
+//While something animates without input the loop doesn't block, frames come at most MaxAnimationFps times a second.
+//
+//Anything the UI shows about the frames themselves (frame times, GPU timings, frame counts) changes with every frame it measures,
+//so the caller has to hold such readouts still on frames that weren't caused by input (see WaitForEvents), or nothing is ever skipped.
+//Main thread only.
+class FrameSkipper
+{
+public:
+	//takes the window's refresh callback and user pointer, a damaged window is redrawn even when nothing changed
+	//without a window (headless) WaitForEvents never waits and only the skipping is left
+	FrameSkipper(GLFWwindow* window, float maxAnimationFps = 30.0f);
+	~FrameSkipper();
+
+	FrameSkipper(const FrameSkipper&) = delete;
+	FrameSkipper& operator=(const FrameSkipper&) = delete;
+
+	//0 renders animation frames as fast as the swap interval allows
+	inline void SetMaxAnimationFps(float fps) { m_MaxAnimationFps = fps; }
+	inline float GetMaxAnimationFps() const { return m_MaxAnimationFps; }
+
+	//processes events, blocking until there are some when the last frame was skipped and nothing animates
+	//returns true when it waited and input ended the wait, the frames whose readouts may change
+	bool WaitForEvents(bool animating);
+	//after ImGui::Render(), false when the frame can be dropped without rendering or swapping it
+	//force: a change the draw data doesn't show, the scene or the window
+	bool ShouldRender(const ImDrawData& drawData, bool force = false);
+
+	inline unsigned long long GetRenderedFrames() const { return m_RenderedFrames; }
+	inline unsigned long long GetSkippedFrames() const { return m_SkippedFrames; }
+
+	//vertices, indices and draw commands of every list, the display size and framebuffer scale
+	static uint64_t HashDrawData(const ImDrawData& drawData);
+
+private:
+	GLFWwindow* m_Window;
+	float m_MaxAnimationFps;
+
+	uint64_t m_LastHash;
+	bool m_LastRendered;
+	//set by the refresh callback
+	bool m_Damaged;
+	std::chrono::steady_clock::time_point m_LastRenderTime;
+
+	unsigned long long m_RenderedFrames;
+	unsigned long long m_SkippedFrames;
+
+	static void OnRefresh(GLFWwindow* window);
+};
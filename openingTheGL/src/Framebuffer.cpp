@@ -0,0 +1,153 @@
+#include "Framebuffer.h"
+#include "RenderTarget.h"
+#include "Renderer.h"
+
+#include <iostream>
+
+static unsigned int s_DefaultFramebuffer = 0;
+
+Framebuffer::Framebuffer()
+	: m_Depth(nullptr), m_Width(0), m_Height(0)
+{
+	for (auto& color : m_Color)
+		color = nullptr;
+
+	//http://docs.gl/gl4/glGenFramebuffers
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+}
+
+Framebuffer::~Framebuffer()
+{
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+}
+
+void Framebuffer::Attach(unsigned int attachment, const RenderTarget* target)
+{
+	//attaching needs the framebuffer bound, it stays bound afterwards
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+	if (!target)
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, 0));
+	else if (target->IsRenderbuffer())
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, target->GetRendererID()));
+	else
+		GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, target->GetRendererID(), 0));
+}
+
+void Framebuffer::SetColor(unsigned int index, const RenderTarget* target)
+{
+	ASSERT(index < MaxColorAttachments);
+	ASSERT(!target || !target->IsDepth());
+	if (m_Color[index] == target)
+		return;
+
+	Attach(GL_COLOR_ATTACHMENT0 + index, target);
+	m_Color[index] = target;
+
+	//which attachments get written is framebuffer state, so it only changes here and not on every bind
+	GLenum drawBuffers[MaxColorAttachments];
+	for (unsigned int i = 0; i < MaxColorAttachments; i++)
+		drawBuffers[i] = m_Color[i] ? GL_COLOR_ATTACHMENT0 + i : GL_NONE;
+	GLCall(glDrawBuffers(MaxColorAttachments, drawBuffers));
+
+	UpdateSize();
+}
+
+void Framebuffer::SetDepth(const RenderTarget* target)
+{
+	ASSERT(!target || target->IsDepth());
+	if (m_Depth == target)
+		return;
+
+	//a depth-only target has to be detached from the stencil attachment too when it replaces a depth-stencil one
+	if (m_Depth && m_Depth->HasStencil())
+		Attach(GL_DEPTH_STENCIL_ATTACHMENT, nullptr);
+	Attach(target && target->HasStencil() ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, target);
+	m_Depth = target;
+
+	UpdateSize();
+}
+
+void Framebuffer::UpdateSize()
+{
+	m_Width = 0;
+	m_Height = 0;
+	for (const RenderTarget* target : m_Color)
+		if (target)
+		{
+			m_Width = target->GetDesc().Width;
+			m_Height = target->GetDesc().Height;
+			return;
+		}
+	if (m_Depth)
+	{
+		m_Width = m_Depth->GetDesc().Width;
+		m_Height = m_Depth->GetDesc().Height;
+	}
+}
+
+bool Framebuffer::IsComplete() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLenum status;
+	GLCall(status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status == GL_FRAMEBUFFER_COMPLETE)
+		return true;
+
+	//http://docs.gl/gl4/glCheckFramebufferStatus
+	std::cout << "Framebuffer " << m_RendererID << " incomplete: ";
+	switch (status)
+	{
+	case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT: std::cout << "an attachment is not renderable"; break;
+	case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT: std::cout << "no attachments"; break;
+	case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE: std::cout << "attachments have different sample counts"; break;
+	case GL_FRAMEBUFFER_UNSUPPORTED: std::cout << "format combination not supported"; break;
+	default: std::cout << status; break;
+	}
+	std::cout << '\n';
+	return false;
+}
+
+void Framebuffer::Bind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, (GLsizei)m_Width, (GLsizei)m_Height));
+}
+
+void Framebuffer::Unbind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, s_DefaultFramebuffer));
+}
+
+void Framebuffer::BindDefault(unsigned int width, unsigned int height)
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, s_DefaultFramebuffer));
+	GLCall(glViewport(0, 0, (GLsizei)width, (GLsizei)height));
+}
+
+void Framebuffer::SetDefault(unsigned int rendererID)
+{
+	s_DefaultFramebuffer = rendererID;
+}
+
+unsigned int Framebuffer::GetDefault()
+{
+	return s_DefaultFramebuffer;
+}
+
+void Framebuffer::Resolve(const Framebuffer* destination, unsigned int width, unsigned int height) const
+{
+	GLbitfield mask = m_Color[0] ? GL_COLOR_BUFFER_BIT : 0;
+	//the default framebuffer is assumed to have no depth worth keeping
+	if (m_Depth && destination && destination->m_Depth)
+		mask |= GL_DEPTH_BUFFER_BIT | (m_Depth->HasStencil() && destination->m_Depth->HasStencil() ? GL_STENCIL_BUFFER_BIT : 0);
+
+	//depth and stencil can only be copied without filtering, color is filtered when it is scaled
+	bool scaled = width != m_Width || height != m_Height;
+	GLenum filter = scaled && mask == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST;
+
+	//http://docs.gl/gl4/glBlitFramebuffer
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination ? destination->m_RendererID : s_DefaultFramebuffer));
+	GLCall(glBlitFramebuffer(0, 0, (GLint)m_Width, (GLint)m_Height, 0, 0, (GLint)width, (GLint)height, mask, filter));
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+class RenderTarget;
+
+//A framebuffer object, the set of render targets a pass draws into
+//Attachments can be swapped between frames (for example for targets from a RenderTargetPool), the framebuffer itself is kept
+class Framebuffer
+{
+public:
+	static const unsigned int MaxColorAttachments = 4;
+
+	Framebuffer();
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	//nullptr detaches, all attachments need the same size and sample count
+	void SetColor(unsigned int index, const RenderTarget* target);
+	void SetDepth(const RenderTarget* target);
+	//checks the attachments, prints why if they don't work together
+	bool IsComplete() const;
+
+	//binds it for drawing, enables the color attachments and sets the viewport to their size
+	void Bind() const;
+	void Unbind() const;
+	//framebuffer 0 (the window, or whatever was passed to SetDefault) with the given viewport
+	static void BindDefault(unsigned int width, unsigned int height);
+	//headless contexts have no window, their own framebuffer stands in for it
+	static void SetDefault(unsigned int rendererID);
+	static unsigned int GetDefault();
+
+	//copies color (and depth if both have it) into destination, this is also how MSAA gets resolved
+	//nullptr is the default framebuffer, the sizes have to match when the source is multisampled
+	void Resolve(const Framebuffer* destination, unsigned int width, unsigned int height) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+
+private:
+	unsigned int m_RendererID;
+	const RenderTarget* m_Color[MaxColorAttachments];
+	const RenderTarget* m_Depth;
+	unsigned int m_Width;
+	unsigned int m_Height;
+
+	void Attach(unsigned int attachment, const RenderTarget* target);
+	void UpdateSize();
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "BoundingBox.h"
+
+//The six clipping planes of a camera, in world space
+//Each plane is stored as (normal.xyz, distance) with the normal pointing into the frustum,
+//so a point p is inside a plane when dot(normal, p) + distance >= 0
+struct Frustum
+{
+	enum Side { Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+	glm::vec4 Planes[Count];
+
+	Frustum() {}
+
+	//Extracts the planes from a projection * view matrix (Gribb/Hartmann method)
+	//for example: Frustum(proj * view) gives the world space frustum of the camera
+	explicit Frustum(const glm::mat4& viewProjection)
+	{
+		//glm is column major, so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+		glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+		Planes[Left] = row3 + row0;
+		Planes[Right] = row3 - row0;
+		Planes[Bottom] = row3 + row1;
+		Planes[Top] = row3 - row1;
+		Planes[Near] = row3 + row2;
+		Planes[Far] = row3 - row2;
+
+		for (int i = 0; i < Count; i++)
+			Planes[i] /= glm::length(glm::vec3(Planes[i]));
+	}
+
+	//Scalar reference test, the Bvh does the same test on 4/8 boxes at once
+	//Only the corner furthest along the plane normal (the "positive vertex") has to be checked
+	bool Intersects(const BoundingBox& box) const
+	{
+		for (int i = 0; i < Count; i++)
+		{
+			const glm::vec4& p = Planes[i];
+			glm::vec3 positive(p.x > 0.0f ? box.Max.x : box.Min.x,
+				p.y > 0.0f ? box.Max.y : box.Min.y,
+				p.z > 0.0f ? box.Max.z : box.Min.z);
+			if (glm::dot(glm::vec3(p), positive) + p.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,148 @@
+#include "GLDebug.h"
+#include "Renderer.h"
+
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace GLDebug
+{
+	std::atomic<bool> s_CallbackActive(false);
+	thread_local CallSite t_CallSite = { nullptr, nullptr, 0 };
+	thread_local bool t_CallFailed = false;
+
+	static std::atomic<Severity> s_MinSeverity(Severity::Low);
+
+	//the callback can come from any thread, the driver's included
+	static std::mutex s_SeenMutex;
+	static std::unordered_map<uint64_t, unsigned int> s_Seen;
+
+	static Severity ToSeverity(GLenum severity)
+	{
+		switch (severity)
+		{
+		case GL_DEBUG_SEVERITY_HIGH: return Severity::High;
+		case GL_DEBUG_SEVERITY_MEDIUM: return Severity::Medium;
+		case GL_DEBUG_SEVERITY_LOW: return Severity::Low;
+		default: return Severity::Notification;
+		}
+	}
+
+	static const char* SourceName(GLenum source)
+	{
+		switch (source)
+		{
+		case GL_DEBUG_SOURCE_API: return "API";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "Window system";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY: return "Third party";
+		case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+		default: return "Other";
+		}
+	}
+
+	static const char* TypeName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_DEBUG_TYPE_ERROR: return "Error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined behavior";
+		case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+		case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+		case GL_DEBUG_TYPE_MARKER: return "Marker";
+		case GL_DEBUG_TYPE_PUSH_GROUP: return "Push group";
+		case GL_DEBUG_TYPE_POP_GROUP: return "Pop group";
+		default: return "Other";
+		}
+	}
+
+	static void GLAPIENTRY OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei /*length*/, const GLchar* message, const void* /*userParam*/)
+	{
+		if (ToSeverity(severity) < s_MinSeverity.load(std::memory_order_relaxed))
+			return;
+
+		//in synchronous mode this runs inside the failing call, so GLCall can break on it
+		bool error = type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH;
+		if (error)
+			t_CallFailed = true;
+
+		//the same message tends to come every frame, print it the first time and then once per power of ten
+		unsigned int count;
+		{
+			std::lock_guard<std::mutex> lock(s_SeenMutex);
+			count = ++s_Seen[((uint64_t)source << 48) ^ ((uint64_t)type << 32) ^ id];
+		}
+		if (count != 1 && count != 10 && count != 100 && count != 1000 && count % 10000 != 0)
+			return;
+
+		std::cout << "[OpenGL " << TypeName(type) << "] (" << id << ", " << SourceName(source) << "): " << message;
+		if (count > 1)
+			std::cout << " (seen " << count << " times)";
+		if (t_CallSite.Function)
+			std::cout << "\n    in " << t_CallSite.Function << " " << t_CallSite.File << ":" << t_CallSite.Line;
+		std::cout << '\n';
+	}
+
+	bool Init(Severity minSeverity, bool synchronous)
+	{
+		s_MinSeverity = minSeverity;
+
+		//without a debug context drivers are allowed to report nothing at all, better to keep polling then
+		GLint flags = 0;
+		glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+		if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT))
+			return false;
+
+		if (GLEW_KHR_debug || GLEW_VERSION_4_3)
+		{
+			glEnable(GL_DEBUG_OUTPUT);
+			glDebugMessageCallback(OnMessage, nullptr);
+			//skip notifications in the driver already unless they were asked for, some drivers send one for every buffer upload
+			glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, minSeverity == Severity::Notification);
+		}
+		else if (GLEW_ARB_debug_output)
+		{
+			//the ARB version has no notification severity and is always enabled in a debug context
+			glDebugMessageCallbackARB(OnMessage, nullptr);
+		}
+		else
+			return false;
+
+		//clear whatever happened before, from here on the flag is never read again
+		ClearErrors();
+		s_CallbackActive = true;
+		SetSynchronous(synchronous);
+		return true;
+	}
+
+	void SetMinSeverity(Severity severity)
+	{
+		s_MinSeverity = severity;
+	}
+
+	void SetSynchronous(bool synchronous)
+	{
+		if (!IsCallbackActive())
+			return;
+
+		//the enum is the same for KHR_debug and ARB_debug_output
+		if (synchronous)
+			glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		else
+			glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	}
+
+	void ClearErrors()
+	{
+		GLClearError();
+	}
+
+	bool PollErrors()
+	{
+		bool result = GLLogCall(t_CallSite.Function, t_CallSite.File, t_CallSite.Line);
+		t_CallSite.Function = nullptr;
+		return result;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+
+//Reports GL errors and driver warnings through KHR_debug (or ARB_debug_output) instead of calling glGetError around every GL call
+//
+//glGetError makes the driver finish everything queued before it can answer, so the old GLCall made debug builds
+//run at a fraction of release speed. With a debug context the driver calls us back instead, and GLCall only remembers
+//which call it is making so the message can point at it.
+//
+//Messages are printed once per (source, type, id), repeats are counted and reported at 10, 100, 1000...
+//By default the driver may report from its own thread some time after the call, enable synchronous mode
+//to get the callback inside the failing call, then the ASSERT in GLCall breaks right on the offending line.
+//
+//Without a debug context or the extensions, GLCall keeps polling glGetError.
+namespace GLDebug
+{
+	enum class Severity : unsigned char
+	{
+		Notification, Low, Medium, High
+	};
+
+	//Call once after glewInit, on the thread that has the context current
+	//returns false if the callback could not be installed, errors are then found with glGetError
+	bool Init(Severity minSeverity = Severity::Low, bool synchronous = false);
+
+	//messages below this are dropped, any thread
+	void SetMinSeverity(Severity severity);
+	//only from the thread that has the context current
+	void SetSynchronous(bool synchronous);
+
+	struct CallSite
+	{
+		const char* Function;
+		const char* File;
+		int Line;
+	};
+
+	extern std::atomic<bool> s_CallbackActive;
+	extern thread_local CallSite t_CallSite;
+	extern thread_local bool t_CallFailed;
+
+	void ClearErrors();
+	bool PollErrors();
+
+	inline bool IsCallbackActive() { return s_CallbackActive.load(std::memory_order_relaxed); }
+
+	//used by GLCall, around the call it wraps
+	inline void BeginCall(const char* function, const char* file, int line)
+	{
+		t_CallSite = { function, file, line };
+		if (IsCallbackActive())
+			t_CallFailed = false;
+		else
+			ClearErrors();
+	}
+
+	//false if the call raised an error, with the callback that is only known here in synchronous mode
+	inline bool EndCall()
+	{
+		if (!IsCallbackActive())
+			return PollErrors();
+
+		t_CallSite.Function = nullptr;
+		return !t_CallFailed;
+	}
+}
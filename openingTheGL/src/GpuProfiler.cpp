@@ -0,0 +1,230 @@
+#include "GpuProfiler.h"
+#include "Renderer.h"
+
+#include <cfloat>
+#include <cstdio>
+#include <fstream>
+#include "imgui/imgui.h"
+
+GpuProfiler::GpuProfiler()
+	: m_Current(0), m_FrameNumber(0), m_Initialized(false), m_DebugGroups(false), m_InFrame(false), m_DroppedFrames(0), m_Paused(false), m_HistoryNext(0)
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	if (!m_Initialized)
+		return;
+
+	for (PendingFrame& frame : m_Frames)
+	{
+		GLCall(glDeleteQueries(1, &frame.ElapsedQuery));
+		GLCall(glDeleteQueries(1, &frame.StartQuery));
+		if (!frame.Queries.empty())
+		{
+			GLCall(glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data()));
+		}
+	}
+}
+
+void GpuProfiler::Initialize()
+{
+	//queries can only be created once a context is current, so this waits for the first frame
+	for (PendingFrame& frame : m_Frames)
+	{
+		GLCall(glGenQueries(1, &frame.ElapsedQuery));
+		GLCall(glGenQueries(1, &frame.StartQuery));
+	}
+	m_DebugGroups = GLEW_KHR_debug || GLEW_VERSION_4_3;
+	m_History.reserve(HistorySize);
+	m_Initialized = true;
+}
+
+unsigned int GpuProfiler::NextQuery(PendingFrame& frame)
+{
+	//the pool only grows, after the first few frames no queries are created anymore
+	if (frame.UsedQueries == frame.Queries.size())
+	{
+		unsigned int first = (unsigned int)frame.Queries.size();
+		frame.Queries.resize(first + 16);
+		GLCall(glGenQueries(16, &frame.Queries[first]));
+	}
+	return frame.Queries[frame.UsedQueries++];
+}
+
+void GpuProfiler::BeginFrame()
+{
+	if (!m_Initialized)
+		Initialize();
+
+	//whatever was recorded in this slot FrameLatency frames ago should be done by now
+	PendingFrame& frame = m_Frames[m_Current];
+	if (frame.Active)
+		Collect(frame);
+
+	frame.Frame = m_FrameNumber;
+	frame.Active = true;
+	frame.UsedQueries = 0;
+	frame.Zones.clear();
+	m_OpenZones.clear();
+	m_InFrame = true;
+
+	GLCall(glQueryCounter(frame.StartQuery, GL_TIMESTAMP));
+	GLCall(glBeginQuery(GL_TIME_ELAPSED, frame.ElapsedQuery));
+}
+
+void GpuProfiler::EndFrame()
+{
+	//zones left open (an early return between Begin and End) are closed here so the frame stays readable
+	while (!m_OpenZones.empty())
+		EndZone();
+
+	GLCall(glEndQuery(GL_TIME_ELAPSED));
+	m_InFrame = false;
+
+	m_Current = (m_Current + 1) % FrameLatency;
+	m_FrameNumber++;
+}
+
+void GpuProfiler::BeginZone(const char* name)
+{
+	if (!m_InFrame)
+		return;
+
+	PendingFrame& frame = m_Frames[m_Current];
+	unsigned int query = NextQuery(frame);
+	GLCall(glQueryCounter(query, GL_TIMESTAMP));
+	m_OpenZones.push_back((unsigned int)frame.Zones.size());
+	frame.Zones.push_back({ name, (unsigned int)m_OpenZones.size() - 1, query, 0 });
+
+	if (m_DebugGroups)
+	{
+		GLCall(glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name));
+	}
+}
+
+void GpuProfiler::EndZone()
+{
+	if (!m_InFrame || m_OpenZones.empty())
+		return;
+
+	if (m_DebugGroups)
+	{
+		GLCall(glPopDebugGroup());
+	}
+
+	PendingFrame& frame = m_Frames[m_Current];
+	unsigned int query = NextQuery(frame);
+	GLCall(glQueryCounter(query, GL_TIMESTAMP));
+	frame.Zones[m_OpenZones.back()].EndQuery = query;
+	m_OpenZones.pop_back();
+}
+
+void GpuProfiler::Collect(PendingFrame& frame)
+{
+	frame.Active = false;
+	if (m_Paused.load(std::memory_order_relaxed))
+		return;
+
+	//the time elapsed query ends after every timestamp of the frame, but results are not guaranteed to land in order, so check the last timestamp too
+	GLint available = 0;
+	GLCall(glGetQueryObjectiv(frame.ElapsedQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+	if (available && frame.UsedQueries > 0)
+	{
+		GLCall(glGetQueryObjectiv(frame.Queries[frame.UsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+	}
+	if (!available)
+	{
+		m_DroppedFrames.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	FrameResult result;
+	result.Frame = frame.Frame;
+
+	GLuint64 elapsed = 0, start = 0;
+	GLCall(glGetQueryObjectui64v(frame.ElapsedQuery, GL_QUERY_RESULT, &elapsed));
+	GLCall(glGetQueryObjectui64v(frame.StartQuery, GL_QUERY_RESULT, &start));
+	result.GpuTime = elapsed / 1000000.0f;
+
+	result.Zones.reserve(frame.Zones.size());
+	for (const PendingZone& zone : frame.Zones)
+	{
+		GLuint64 begin = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(zone.BeginQuery, GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(zone.EndQuery, GL_QUERY_RESULT, &end));
+		result.Zones.push_back({ zone.Name, zone.Depth, (int64_t)(begin - start) / 1000000.0f, (int64_t)(end - begin) / 1000000.0f });
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_History.size() < HistorySize)
+		m_History.push_back(std::move(result));
+	else
+		m_History[m_HistoryNext] = std::move(result);
+	m_HistoryNext = (m_HistoryNext + 1) % HistorySize;
+}
+
+void GpuProfiler::DrawOverlay() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_History.empty())
+	{
+		ImGui::Text("GPU: waiting for the first results");
+		return;
+	}
+
+	//oldest to newest
+	unsigned int count = (unsigned int)m_History.size();
+	unsigned int oldest = count < HistorySize ? 0 : m_HistoryNext;
+	float times[HistorySize];
+	for (unsigned int i = 0; i < count; i++)
+		times[i] = m_History[(oldest + i) % HistorySize].GpuTime;
+
+	const FrameResult& last = m_History[(m_HistoryNext + HistorySize - 1) % HistorySize];
+	char label[64];
+	snprintf(label, sizeof(label), "GPU %.3f ms", last.GpuTime);
+	ImGui::PlotLines("##gpu", times, (int)count, 0, label, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+
+	//every zone of the last frame, with its average over the history next to it
+	for (unsigned int i = 0; i < last.Zones.size(); i++)
+	{
+		const Zone& zone = last.Zones[i];
+		float total = 0.0f;
+		unsigned int samples = 0;
+		for (const FrameResult& frame : m_History)
+			if (i < frame.Zones.size() && frame.Zones[i].Name == zone.Name)
+			{
+				total += frame.Zones[i].Duration;
+				samples++;
+			}
+
+		ImGui::Text("%*s%s", (int)zone.Depth * 2, "", zone.Name);
+		ImGui::SameLine(160.0f);
+		snprintf(label, sizeof(label), "%.3f ms (avg %.3f)", zone.Duration, total / samples);
+		ImGui::ProgressBar(last.GpuTime > 0.0f ? zone.Duration / last.GpuTime : 0.0f, ImVec2(200.0f, 0.0f), label);
+	}
+
+	if (unsigned int dropped = GetDroppedFrames())
+		ImGui::Text("%u frames dropped, results were late", dropped);
+}
+
+bool GpuProfiler::ExportCsv(const std::string& filepath) const
+{
+	std::ofstream stream(filepath);
+	if (!stream)
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	unsigned int count = (unsigned int)m_History.size();
+	unsigned int oldest = count < HistorySize ? 0 : m_HistoryNext;
+
+	stream << "frame,zone,depth,start_ms,duration_ms\n";
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const FrameResult& frame = m_History[(oldest + i) % HistorySize];
+		stream << frame.Frame << ",Frame,0,0," << frame.GpuTime << "\n";
+		for (const Zone& zone : frame.Zones)
+			stream << frame.Frame << "," << zone.Name << "," << zone.Depth + 1 << "," << zone.Start << "," << zone.Duration << "\n";
+	}
+	return (bool)stream;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Measures how long the GPU spends on every part of a frame, with GL timer queries
+//
+//Zones are marked on the GL thread with BeginZone/EndZone (or a GpuZone on the stack) and can be nested.
+//Every zone writes a GL_TIMESTAMP when it begins and ends, and the whole frame is wrapped in a GL_TIME_ELAPSED query.
+//The queries of a frame are only read back FrameLatency frames later, when the GPU is done with them, so the profiler never waits on the GPU.
+//If a frame's results still are not there by then they are dropped instead.
+//
+//Zones also push a KHR_debug group with the same name when the driver has it, so the passes show up in RenderDoc, Nsight, etc.
+class GpuProfiler
+{
+public:
+	static const unsigned int FrameLatency = 4;
+	//completed frames kept for the overlay and the CSV export
+	static const unsigned int HistorySize = 240;
+
+	struct Zone
+	{
+		const char* Name;
+		unsigned int Depth;
+		//in ms, from the start of the frame
+		float Start;
+		float Duration;
+	};
+
+	struct FrameResult
+	{
+		uint64_t Frame;
+		//whole frame, in ms
+		float GpuTime;
+		std::vector<Zone> Zones;
+	};
+
+	GpuProfiler();
+	~GpuProfiler();
+
+	//GL thread, zone names have to outlive the profiler (string literals)
+	void BeginFrame();
+	void EndFrame();
+	void BeginZone(const char* name);
+	void EndZone();
+
+	//any thread
+	//Draws the per zone breakdown of the last completed frame and a graph of the GPU frame time into the current ImGui window
+	void DrawOverlay() const;
+	//one line per zone of every frame in the history: frame, zone, depth, start and duration in ms
+	bool ExportCsv(const std::string& filepath) const;
+	inline unsigned int GetDroppedFrames() const { return m_DroppedFrames.load(std::memory_order_relaxed); }
+	//while paused the frames are still timed but their results are thrown away, the overlay keeps showing what it had
+	inline void SetPaused(bool paused) { m_Paused.store(paused, std::memory_order_relaxed); }
+
+private:
+	struct PendingZone
+	{
+		const char* Name;
+		unsigned int Depth;
+		unsigned int BeginQuery;
+		unsigned int EndQuery;
+	};
+
+	//the queries of one frame, reused every FrameLatency frames
+	struct PendingFrame
+	{
+		uint64_t Frame = 0;
+		bool Active = false;
+		unsigned int ElapsedQuery = 0;
+		unsigned int StartQuery = 0;
+		std::vector<unsigned int> Queries;
+		unsigned int UsedQueries = 0;
+		std::vector<PendingZone> Zones;
+	};
+
+	PendingFrame m_Frames[FrameLatency];
+	unsigned int m_Current;
+	uint64_t m_FrameNumber;
+	bool m_Initialized;
+	bool m_DebugGroups;
+	bool m_InFrame;
+	//zones begun but not ended yet, as indices into the current frame's zones
+	std::vector<unsigned int> m_OpenZones;
+	std::atomic<unsigned int> m_DroppedFrames;
+	std::atomic<bool> m_Paused;
+
+	//the history is written on the GL thread and read from the UI
+	mutable std::mutex m_Mutex;
+	std::vector<FrameResult> m_History;
+	unsigned int m_HistoryNext;
+
+	void Initialize();
+	unsigned int NextQuery(PendingFrame& frame);
+	void Collect(PendingFrame& frame);
+};
+
+//Times the scope it lives in
+class GpuZone
+{
+public:
+	GpuZone(GpuProfiler& profiler, const char* name)
+		: m_Profiler(profiler)
+	{
+		m_Profiler.BeginZone(name);
+	}
+	~GpuZone() { m_Profiler.EndZone(); }
+
+	GpuZone(const GpuZone&) = delete;
+	GpuZone& operator=(const GpuZone&) = delete;
+
+private:
+	GpuProfiler& m_Profiler;
+};
@@ -0,0 +1,202 @@
+#include "HeadlessContext.h"
+#include "Renderer.h"
+
+#include <fstream>
+#include <iostream>
+
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+HeadlessContext::HeadlessContext()
+	: m_Width(0), m_Height(0),
+#ifdef HEADLESS_EGL
+	m_Display(nullptr), m_Context(nullptr)
+#else
+	m_Window(nullptr)
+#endif
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	//the GL objects go first, while the context is still there
+	m_Framebuffer.reset();
+	m_ColorTarget.reset();
+	m_DepthTarget.reset();
+	DestroyContext();
+}
+
+#ifdef HEADLESS_EGL
+
+bool HeadlessContext::CreateContext()
+{
+	//the surfaceless platform needs no X11, Wayland or DRM device, only Mesa
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	EGLDisplay display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY;
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << "Headless: no EGL display (" << std::hex << eglGetError() << std::dec << ")\n";
+		return false;
+	}
+	m_Display = display;
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cout << "Headless: EGL has no desktop OpenGL\n";
+		return false;
+	}
+
+	//nothing is ever drawn to an EGL surface, so any config will do, or none at all where EGL_KHR_no_config_context is supported (Mesa)
+	EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = EGL_NO_CONFIG_KHR;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+		config = EGL_NO_CONFIG_KHR;
+
+	//same version and profile as the window path asks GLFW for
+	EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef DEBUG
+		EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cout << "Headless: could not create an OpenGL 3.3 core context (" << std::hex << eglGetError() << std::dec << ")\n";
+		return false;
+	}
+	m_Context = context;
+
+	//EGL_KHR_surfaceless_context: current without any surface, the framebuffer object is the only render target
+	if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		std::cout << "Headless: could not make the context current\n";
+		return false;
+	}
+	return true;
+}
+
+void HeadlessContext::DestroyContext()
+{
+	if (!m_Display)
+		return;
+
+	eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (m_Context)
+		eglDestroyContext(m_Display, m_Context);
+	eglTerminate(m_Display);
+	m_Context = nullptr;
+	m_Display = nullptr;
+}
+
+#else
+
+bool HeadlessContext::CreateContext()
+{
+	if (!glfwInit())
+		return false;
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef DEBUG
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	m_Window = glfwCreateWindow((int)m_Width, (int)m_Height, "Headless", NULL, NULL);
+	if (!m_Window)
+	{
+		std::cout << "Headless: could not create a hidden window\n";
+		return false;
+	}
+	glfwMakeContextCurrent(m_Window);
+	return true;
+}
+
+void HeadlessContext::DestroyContext()
+{
+	if (!m_Window)
+		return;
+
+	glfwDestroyWindow(m_Window);
+	m_Window = nullptr;
+}
+
+#endif
+
+bool HeadlessContext::Create(unsigned int width, unsigned int height)
+{
+	m_Width = width;
+	m_Height = height;
+	if (!CreateContext())
+		return false;
+
+	//a GLEW built for GLX finds no GLX display next to an EGL context and says so,
+	//but only after it has loaded the GL functions, which is all we need from it
+	GLenum result = glewInit();
+	if (result != GLEW_OK && result != GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		std::cout << "Headless: glewInit failed: " << glewGetErrorString(result) << '\n';
+		return false;
+	}
+
+	//depth and stencil like a window's default framebuffer
+	m_ColorTarget.reset(new RenderTarget({ width, height, TextureFormat::RGBA8 }));
+	m_DepthTarget.reset(new RenderTarget({ width, height, TextureFormat::Depth24Stencil8 }));
+	m_Framebuffer.reset(new Framebuffer());
+	m_Framebuffer->SetColor(0, m_ColorTarget.get());
+	m_Framebuffer->SetDepth(m_DepthTarget.get());
+	if (!m_Framebuffer->IsComplete())
+		return false;
+
+	Framebuffer::SetDefault(m_Framebuffer->GetRendererID());
+	m_Framebuffer->Bind();
+	return true;
+}
+
+void HeadlessContext::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+	pixels.resize((size_t)m_Width * m_Height * 4);
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffer->GetRendererID()));
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	GLCall(glReadPixels(0, 0, (GLsizei)m_Width, (GLsizei)m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+}
+
+bool HeadlessContext::WritePpm(const std::string& filepath) const
+{
+	std::vector<unsigned char> pixels;
+	ReadPixels(pixels);
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream)
+		return false;
+
+	stream << "P6\n" << m_Width << " " << m_Height << "\n255\n";
+	//GL's first row is the bottom one, PPM starts at the top, and has no alpha
+	std::vector<unsigned char> row(m_Width * 3);
+	for (unsigned int y = m_Height; y-- > 0;)
+	{
+		const unsigned char* source = &pixels[(size_t)y * m_Width * 4];
+		for (unsigned int x = 0; x < m_Width; x++)
+		{
+			row[x * 3 + 0] = source[x * 4 + 0];
+			row[x * 3 + 1] = source[x * 4 + 1];
+			row[x * 3 + 2] = source[x * 4 + 2];
+		}
+		stream.write((const char*)row.data(), row.size());
+	}
+	return (bool)stream;
+}
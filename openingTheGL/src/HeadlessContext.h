@@ -0,0 +1,54 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "RenderTarget.h"
+
+struct GLFWwindow;
+
+//An OpenGL 3.3 core context without a visible window, rendering into an offscreen framebuffer of a fixed size
+//
+//With HEADLESS_EGL defined (Linux, link with -lEGL) the context comes from EGL on Mesa's surfaceless platform,
+//which needs neither a display server nor a GPU, Mesa falls back to llvmpipe when there is none (or with LIBGL_ALWAYS_SOFTWARE=1).
+//Without it a hidden GLFW window is used, that still needs a desktop but nothing shows up on it.
+//
+//The framebuffer has a depth and stencil buffer, like a window's usually does.
+//Create() leaves the context current and the framebuffer bound with the viewport set, so everything drawn after it lands in the framebuffer.
+//It also becomes the default framebuffer (see Framebuffer::SetDefault), for passes that draw into an offscreen target first.
+class HeadlessContext
+{
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	//also initializes GLEW, returns false if there is no context to be had
+	bool Create(unsigned int width, unsigned int height);
+
+	//RGBA8, bottom row first, waits for the GPU to finish
+	void ReadPixels(std::vector<unsigned char>& pixels) const;
+	//binary PPM of the framebuffer, top row first
+	bool WritePpm(const std::string& filepath) const;
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline const Framebuffer& GetFramebuffer() const { return *m_Framebuffer; }
+
+private:
+	unsigned int m_Width;
+	unsigned int m_Height;
+	std::unique_ptr<RenderTarget> m_ColorTarget;
+	std::unique_ptr<RenderTarget> m_DepthTarget;
+	std::unique_ptr<Framebuffer> m_Framebuffer;
+
+#ifdef HEADLESS_EGL
+	void* m_Display;
+	void* m_Context;
+#else
+	GLFWwindow* m_Window;
+#endif
+
+	bool CreateContext();
+	void DestroyContext();
+};
@@ -19,6 +19,7 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	//Fill Buffer with the data
 	//http://docs.gl/gl4/glBufferData
 	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	RenderStats::Add(RenderStats::BufferBytesUploaded, count * sizeof(unsigned int));
 }
 
 IndexBuffer::~IndexBuffer()
@@ -31,6 +32,7 @@ void IndexBuffer::Bind() const
 	//After creating the buffer, u need to select the buffer which is called "Binding" in opengl
 	//http://docs.gl/gl4/glBindBuffer
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	RenderStats::Add(RenderStats::BufferBinds);
 }
 
 void IndexBuffer::Unbind() const
@@ -10,6 +10,7 @@ public:
 	void Unbind() const;
 
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 
 private:
 	unsigned int m_RendererID;
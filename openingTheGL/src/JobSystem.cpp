@@ -0,0 +1,289 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <string>
+
+struct JobSystem::Job
+{
+	std::function<void()> Function;
+	Counter* Signal;
+};
+
+//which worker of which job system the current thread is, threads that are not workers have no owner
+static thread_local JobSystem* t_Owner = nullptr;
+static thread_local unsigned int t_WorkerIndex = 0;
+
+JobSystem::WorkStealingQueue::WorkStealingQueue()
+	: m_Top(0), m_Bottom(0)
+{
+	for (auto& job : m_Jobs)
+		job.store(nullptr, std::memory_order_relaxed);
+}
+
+bool JobSystem::WorkStealingQueue::Push(Job* job)
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed);
+	long long top = m_Top.load(std::memory_order_acquire);
+	if (bottom - top >= Capacity)
+		return false;
+
+	m_Jobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+	//the job has to be visible before the new bottom is
+	m_Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+JobSystem::Job* JobSystem::WorkStealingQueue::Pop()
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	//the new bottom has to be visible to thieves before we read top
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		//empty
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = m_Jobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		//last job, race against the thieves for it
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::WorkStealingQueue::Steal()
+{
+	long long top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = m_Jobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+	//another thief or the owner got it first
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+JobSystem::JobSystem(unsigned int workers)
+	: m_SharedCount(0), m_Pending(0), m_Quit(false)
+{
+	if (workers == 0)
+		workers = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < workers; i++)
+		m_Queues.push_back(new WorkStealingQueue());
+
+	//the creating thread is worker 0
+	t_Owner = this;
+	t_WorkerIndex = 0;
+
+	for (unsigned int i = 1; i < workers; i++)
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Quit = true;
+	}
+	m_WakeUp.notify_all();
+	for (auto& thread : m_Threads)
+		thread.join();
+
+	for (auto queue : m_Queues)
+		delete queue;
+
+	if (t_Owner == this)
+		t_Owner = nullptr;
+}
+
+void JobSystem::Run(std::function<void()> function, Counter* counter, Counter* dependency)
+{
+	Job* job = new Job{ std::move(function), counter };
+	if (counter)
+		counter->Value.fetch_add(1, std::memory_order_relaxed);
+	Enqueue(job, dependency);
+}
+
+void JobSystem::RunBatch(unsigned int count, const std::function<void(unsigned int index)>& function, Counter* counter, Counter* dependency)
+{
+	if (counter)
+		counter->Value.fetch_add((int)count, std::memory_order_relaxed);
+	for (unsigned int i = 0; i < count; i++)
+		Enqueue(new Job{ [function, i]() { function(i); }, counter }, dependency);
+}
+
+void JobSystem::Enqueue(Job* job, Counter* dependency)
+{
+	if (dependency)
+	{
+		//park the job on the dependency, whoever brings it to zero starts the job
+		std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+		if (!dependency->IsDone())
+		{
+			dependency->m_Continuations.push_back(job);
+			return;
+		}
+	}
+
+	Submit(job);
+}
+
+void JobSystem::Submit(Job* job)
+{
+	m_Pending.fetch_add(1, std::memory_order_release);
+
+	if (t_Owner != this || !m_Queues[t_WorkerIndex]->Push(job))
+	{
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		m_SharedQueue.push_back(job);
+		m_SharedCount.fetch_add(1, std::memory_order_release);
+	}
+
+	//taking the lock makes sure a worker that is about to sleep sees m_Pending first
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_WakeUp.notify_one();
+}
+
+JobSystem::Job* JobSystem::FindJob(unsigned int worker)
+{
+	//own deque first, then the shared queue, then steal, starting from the next worker so thieves spread out
+	Job* job = worker < m_Queues.size() ? m_Queues[worker]->Pop() : nullptr;
+
+	if (!job && m_SharedCount.load(std::memory_order_acquire) > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_SharedMutex);
+		if (!m_SharedQueue.empty())
+		{
+			job = m_SharedQueue.back();
+			m_SharedQueue.pop_back();
+			m_SharedCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	unsigned int count = (unsigned int)m_Queues.size();
+	for (unsigned int i = 1; !job && i <= count; i++)
+	{
+		unsigned int victim = (worker + i) % count;
+		if (victim != worker)
+			job = m_Queues[victim]->Steal();
+	}
+
+	if (job)
+		m_Pending.fetch_sub(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	{
+		PROFILE_SCOPE("Job");
+		job->Function();
+	}
+
+	Counter* counter = job->Signal;
+	delete job;
+
+	if (!counter)
+		return;
+
+	//decrement under the lock, so a job parked on this counter in Run() can't be missed,
+	//and so Wait() can't return (and the counter go out of scope) while we still use it
+	std::vector<Job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		if (counter->Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			continuations.swap(counter->m_Continuations);
+	}
+
+	//the counter is done, start everything that waited on it
+	for (Job* continuation : continuations)
+		Submit(continuation);
+}
+
+void JobSystem::WorkerLoop(unsigned int worker)
+{
+	t_Owner = this;
+	t_WorkerIndex = worker;
+	PROFILE_THREAD("Worker " + std::to_string(worker));
+
+	while (true)
+	{
+		if (Job* job = FindJob(worker))
+		{
+			Execute(job);
+			continue;
+		}
+
+		//spin a little before going to sleep, new jobs usually come in bursts
+		bool found = false;
+		for (int spin = 0; spin < 64 && !found; spin++)
+		{
+			std::this_thread::yield();
+			found = m_Pending.load(std::memory_order_acquire) > 0;
+		}
+		if (found)
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_WakeUp.wait(lock, [this]() { return m_Quit || m_Pending.load(std::memory_order_acquire) > 0; });
+		if (m_Quit)
+			return;
+	}
+}
+
+void JobSystem::Wait(Counter& counter)
+{
+	//a thread that is not one of our workers can still help through the shared queue,
+	//it just has no deque of its own
+	unsigned int worker = t_Owner == this ? t_WorkerIndex : (unsigned int)m_Queues.size();
+
+	while (!counter.IsDone())
+	{
+		if (Job* job = FindJob(worker))
+			Execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	//the job that finished the counter may still be holding its lock
+	std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int grain, const std::function<void(unsigned int first, unsigned int end)>& function)
+{
+	if (count == 0)
+		return;
+
+	grain = std::max(1u, grain);
+	//run it right here when there is only one chunk or one worker, no need to go through the queues
+	//still chunk by chunk, a callee may size things by grain
+	if (count <= grain || m_Queues.size() == 1)
+	{
+		for (unsigned int first = 0; first < count; first += grain)
+			function(first, std::min(count, first + grain));
+		return;
+	}
+
+	Counter counter;
+	for (unsigned int first = 0; first < count; first += grain)
+	{
+		unsigned int end = std::min(count, first + grain);
+		Run([&function, first, end]() { function(first, end); }, &counter);
+	}
+	Wait(counter);
+}
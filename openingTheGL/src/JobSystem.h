@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Shared execution layer of the engine: culling, transform updates, asset decoding and command building all run as jobs here
+//
+//Every worker owns a work-stealing deque: it pushes and pops jobs at the bottom of its own deque (newest first, cache friendly),
+//and when it runs out of work it steals the oldest job from the top of another worker's deque.
+//The thread that creates the JobSystem is worker 0, it runs jobs while it waits on a counter instead of blocking.
+//Other threads (i.e the render thread) can submit jobs too, those go through a shared queue.
+class JobSystem
+{
+	struct Job;
+
+public:
+	//Counts the unfinished jobs attached to it, Wait() on it or use it as the dependency of another job
+	//Only let a counter go out of scope after Wait() on it has returned
+	struct Counter
+	{
+		std::atomic<int> Value;
+		Counter() : Value(0) {}
+		inline bool IsDone() const { return Value.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		//jobs to start once Value drops to zero
+		std::mutex m_Mutex;
+		std::vector<Job*> m_Continuations;
+	};
+
+	//workers: total threads including the calling one, 0 picks one per hardware thread
+	JobSystem(unsigned int workers = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	//Queues a job, "counter" (if any) is incremented now and decremented when the job has run
+	//A job with a dependency only starts once that counter is done
+	void Run(std::function<void()> function, Counter* counter = nullptr, Counter* dependency = nullptr);
+	//Queues function(0) to function(count - 1) as count jobs, the counter goes up by count before the first one is queued,
+	//so it can't drop to zero while the batch is still being queued and start its dependants early
+	void RunBatch(unsigned int count, const std::function<void(unsigned int index)>& function, Counter* counter = nullptr, Counter* dependency = nullptr);
+
+	//Runs other jobs until the counter drops to zero
+	void Wait(Counter& counter);
+
+	//Calls function(first, end) over [0, count) in chunks of "grain" items spread over all workers, and returns when all are done
+	//every chunk is at most grain items, also when they all run on the calling thread
+	void ParallelFor(unsigned int count, unsigned int grain, const std::function<void(unsigned int first, unsigned int end)>& function);
+
+	inline unsigned int GetWorkerCount() const { return (unsigned int)m_Queues.size(); }
+
+private:
+	//A fixed size Chase-Lev deque, only the owner pushes and pops, anyone can steal
+	class WorkStealingQueue
+	{
+	public:
+		static const long long Capacity = 4096;
+
+		WorkStealingQueue();
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+
+	private:
+		std::atomic<long long> m_Top;
+		std::atomic<long long> m_Bottom;
+		std::atomic<Job*> m_Jobs[Capacity];
+	};
+
+	std::vector<WorkStealingQueue*> m_Queues;
+	std::vector<std::thread> m_Threads;
+
+	//jobs submitted from threads that are not workers, or when a worker's deque is full
+	std::mutex m_SharedMutex;
+	std::vector<Job*> m_SharedQueue;
+	std::atomic<int> m_SharedCount;
+
+	//sleeping workers wait here, m_Pending is the number of queued jobs not taken yet
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+	std::atomic<int> m_Pending;
+	std::atomic<bool> m_Quit;
+
+	//submits the job now, or parks it on the dependency when that isn't done yet
+	void Enqueue(Job* job, Counter* dependency);
+	void Submit(Job* job);
+	Job* FindJob(unsigned int worker);
+	void Execute(Job* job);
+	void WorkerLoop(unsigned int worker);
+};
@@ -0,0 +1,276 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Renderer.h"
+#include "Simd.h"
+#include "VertexBufferLayout.h"
+
+//the same hash as the update shaders, so a respawn looks the same on either side
+static uint32_t Hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+static float Random(uint32_t& seed)
+{
+	seed = Hash(seed);
+	return (seed >> 8) / 16777216.0f;
+}
+
+ParticleSystem::ParticleSystem(unsigned int count, const Settings& settings, const std::string& shaderDirectory)
+	: m_Count(std::max(1u, count)), m_Settings(settings), m_Mode(UpdateMode::TransformFeedback), m_Current(0), m_CpuValid(true)
+{
+	m_RenderShader = std::make_unique<Shader>(shaderDirectory + "Particles.shader");
+	m_UpdateShader = std::make_unique<Shader>(shaderDirectory + "ParticleUpdate.shader", std::vector<std::string>{ "o_PositionVelocity", "o_State" });
+	if (IsComputeSupported())
+	{
+		m_ComputeShader = std::make_unique<Shader>(shaderDirectory + "ParticleUpdateCompute.shader");
+		//a driver can report the extensions and still not compile the shader, Compute then falls back like it's unsupported
+		if (!m_ComputeShader->IsValid())
+			m_ComputeShader.reset();
+	}
+
+	m_PositionX.resize(m_Count);
+	m_PositionY.resize(m_Count);
+	m_VelocityX.resize(m_Count);
+	m_VelocityY.resize(m_Count);
+	m_Age.resize(m_Count);
+	m_Lifetime.resize(m_Count);
+	m_Seed.resize(m_Count);
+	m_Staging.resize(m_Count);
+
+	//spawned, then moved on by a random part of their lifetime
+	for (unsigned int i = 0; i < m_Count; i++)
+	{
+		m_Seed[i] = Hash(i + 1) & 0xffffff;
+		Respawn(i);
+		uint32_t seed = Hash(m_Seed[i] ^ 0x5bd1e995u);
+		float age = Random(seed) * m_Lifetime[i];
+		m_PositionX[i] += (m_VelocityX[i] + 0.5f * m_Settings.Gravity.x * age) * age;
+		m_PositionY[i] += (m_VelocityY[i] + 0.5f * m_Settings.Gravity.y * age) * age;
+		m_VelocityX[i] += m_Settings.Gravity.x * age;
+		m_VelocityY[i] += m_Settings.Gravity.y * age;
+		m_Age[i] = age;
+		Pack(i);
+	}
+
+	VertexBufferLayout layout;
+	layout.Push<float>(4);
+	layout.Push<float>(4);
+	unsigned int size = (unsigned int)(m_Count * sizeof(Particle));
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		m_Buffers[i] = std::make_unique<VertexBuffer>(size);
+		m_Buffers[i]->SetSubData(0, m_Staging.data(), size);
+		m_UpdateArrays[i] = std::make_unique<VertexArray>();
+		m_UpdateArrays[i]->AddBuffer(*m_Buffers[i], layout);
+		m_RenderArrays[i] = std::make_unique<VertexArray>();
+		m_RenderArrays[i]->AddBuffer(*m_Buffers[i], layout, 1);
+	}
+}
+
+ParticleSystem::~ParticleSystem()
+{
+}
+
+ParticleSystem::Settings ParticleSystem::DefaultSettings()
+{
+	return { glm::vec2(0.0f), glm::vec2(0.0f, -1.0f), 1.0f, 1.0f, 3.0f, 0.01f };
+}
+
+bool ParticleSystem::IsComputeSupported()
+{
+	return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+}
+
+ParticleSystem::UpdateMode ParticleSystem::SetUpdateMode(UpdateMode mode)
+{
+	if (mode == UpdateMode::Compute && !m_ComputeShader)
+		mode = UpdateMode::TransformFeedback;
+	m_Mode = mode;
+	return m_Mode;
+}
+
+void ParticleSystem::SetUpdateUniforms(Shader& shader, float deltaTime)
+{
+	shader.Bind();
+	shader.SetUniform1f("u_DeltaTime", deltaTime);
+	shader.SetUniform2f("u_Emitter", m_Settings.Emitter.x, m_Settings.Emitter.y);
+	shader.SetUniform2f("u_Gravity", m_Settings.Gravity.x, m_Settings.Gravity.y);
+	shader.SetUniform1f("u_Speed", m_Settings.Speed);
+	shader.SetUniform2f("u_Lifetime", m_Settings.MinLifetime, m_Settings.MaxLifetime);
+}
+
+void ParticleSystem::Update(float deltaTime)
+{
+	if (m_Mode == UpdateMode::Cpu)
+	{
+		UpdateCpu(deltaTime);
+		return;
+	}
+	m_CpuValid = false;
+
+	if (m_Mode == UpdateMode::Compute)
+	{
+		SetUpdateUniforms(*m_ComputeShader, deltaTime);
+		m_ComputeShader->SetUniform1i("u_Count", (int)m_Count);
+		//http://docs.gl/gl4/glDispatchCompute
+		GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_Buffers[m_Current]->GetRendererID()));
+		GLCall(glDispatchCompute((m_Count + 255) / 256, 1, 1));
+		GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0));
+		//the writes have to be visible to the draw (and the next compute or transform feedback update, or a read back) that use the buffer next,
+		//storage buffer writes aren't coherent, the next dispatch reading this buffer needs its own bit
+		//http://docs.gl/gl4/glMemoryBarrier
+		GLCall(glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+		return;
+	}
+
+	//a point per particle, nothing rasterized, the vertex shader outputs go into the other buffer
+	//http://docs.gl/gl4/glBeginTransformFeedback
+	unsigned int next = m_Current ^ 1;
+	SetUpdateUniforms(*m_UpdateShader, deltaTime);
+	m_UpdateArrays[m_Current]->Bind();
+	GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_Buffers[next]->GetRendererID()));
+	GLCall(glEnable(GL_RASTERIZER_DISCARD));
+	GLCall(glBeginTransformFeedback(GL_POINTS));
+	GLCall(glDrawArrays(GL_POINTS, 0, m_Count));
+	GLCall(glEndTransformFeedback());
+	GLCall(glDisable(GL_RASTERIZER_DISCARD));
+	//a buffer still bound for transform feedback can't be drawn from
+	GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0));
+	RenderStats::Add(RenderStats::DrawCalls);
+	m_Current = next;
+}
+
+void ParticleSystem::UpdateCpu(float deltaTime)
+{
+	if (!m_CpuValid)
+		ReadBack();
+
+	unsigned int i = 0;
+#ifdef SIMD_SSE
+	__m128 dt = _mm_set1_ps(deltaTime);
+	__m128 gravityX = _mm_set1_ps(m_Settings.Gravity.x * deltaTime);
+	__m128 gravityY = _mm_set1_ps(m_Settings.Gravity.y * deltaTime);
+	for (; i + 4 <= m_Count; i += 4)
+	{
+		__m128 age = _mm_add_ps(_mm_loadu_ps(&m_Age[i]), dt);
+		__m128 lifetime = _mm_loadu_ps(&m_Lifetime[i]);
+		__m128 velocityX = _mm_add_ps(_mm_loadu_ps(&m_VelocityX[i]), gravityX);
+		__m128 velocityY = _mm_add_ps(_mm_loadu_ps(&m_VelocityY[i]), gravityY);
+		__m128 positionX = _mm_add_ps(_mm_loadu_ps(&m_PositionX[i]), _mm_mul_ps(velocityX, dt));
+		__m128 positionY = _mm_add_ps(_mm_loadu_ps(&m_PositionY[i]), _mm_mul_ps(velocityY, dt));
+		_mm_storeu_ps(&m_Age[i], age);
+		_mm_storeu_ps(&m_VelocityX[i], velocityX);
+		_mm_storeu_ps(&m_VelocityY[i], velocityY);
+		_mm_storeu_ps(&m_PositionX[i], positionX);
+		_mm_storeu_ps(&m_PositionY[i], positionY);
+
+		//the few that died overwrite what was just stored
+		int dead = _mm_movemask_ps(_mm_cmpge_ps(age, lifetime));
+		if (dead)
+		{
+			for (unsigned int lane = 0; lane < 4; lane++)
+			{
+				if (dead & (1 << lane))
+					Respawn(i + lane);
+			}
+			for (unsigned int lane = 0; lane < 4; lane++)
+				Pack(i + lane);
+			continue;
+		}
+
+		//SoA to the buffer's AoS: the rows of the 4x4 transposes are whole particles
+		__m128 seed = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)&m_Seed[i]));
+		__m128 unused = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(positionX, positionY, velocityX, velocityY);
+		_MM_TRANSPOSE4_PS(age, lifetime, seed, unused);
+		Particle* out = &m_Staging[i];
+		_mm_storeu_ps(&out[0].PositionVelocity.x, positionX);
+		_mm_storeu_ps(&out[0].State.x, age);
+		_mm_storeu_ps(&out[1].PositionVelocity.x, positionY);
+		_mm_storeu_ps(&out[1].State.x, lifetime);
+		_mm_storeu_ps(&out[2].PositionVelocity.x, velocityX);
+		_mm_storeu_ps(&out[2].State.x, seed);
+		_mm_storeu_ps(&out[3].PositionVelocity.x, velocityY);
+		_mm_storeu_ps(&out[3].State.x, unused);
+	}
+#endif
+	for (; i < m_Count; i++)
+	{
+		m_Age[i] += deltaTime;
+		if (m_Age[i] >= m_Lifetime[i])
+			Respawn(i);
+		else
+		{
+			m_VelocityX[i] += m_Settings.Gravity.x * deltaTime;
+			m_VelocityY[i] += m_Settings.Gravity.y * deltaTime;
+			m_PositionX[i] += m_VelocityX[i] * deltaTime;
+			m_PositionY[i] += m_VelocityY[i] * deltaTime;
+		}
+		Pack(i);
+	}
+
+	//the round trip the GPU modes don't have
+	m_Buffers[m_Current]->SetData(m_Staging.data(), (unsigned int)(m_Count * sizeof(Particle)));
+}
+
+void ParticleSystem::Respawn(unsigned int i)
+{
+	uint32_t seed = m_Seed[i];
+	float angle = Random(seed) * 6.2831853f;
+	float speed = m_Settings.Speed * (0.25f + 0.75f * Random(seed));
+	float t = Random(seed);
+	m_Lifetime[i] = m_Settings.MinLifetime + (m_Settings.MaxLifetime - m_Settings.MinLifetime) * t;
+	m_PositionX[i] = m_Settings.Emitter.x;
+	m_PositionY[i] = m_Settings.Emitter.y;
+	m_VelocityX[i] = std::cos(angle) * speed;
+	m_VelocityY[i] = std::sin(angle) * speed;
+	m_Age[i] = 0.0f;
+	//below 2^24 so it stays exact as a float in the buffer
+	m_Seed[i] = seed & 0xffffff;
+}
+
+void ParticleSystem::Pack(unsigned int i)
+{
+	m_Staging[i].PositionVelocity = glm::vec4(m_PositionX[i], m_PositionY[i], m_VelocityX[i], m_VelocityY[i]);
+	m_Staging[i].State = glm::vec4(m_Age[i], m_Lifetime[i], (float)m_Seed[i], 0.0f);
+}
+
+void ParticleSystem::ReadBack()
+{
+	//http://docs.gl/gl4/glGetBufferSubData
+	m_Buffers[m_Current]->Bind();
+	GLCall(glGetBufferSubData(GL_ARRAY_BUFFER, 0, m_Count * sizeof(Particle), m_Staging.data()));
+	for (unsigned int i = 0; i < m_Count; i++)
+	{
+		const Particle& particle = m_Staging[i];
+		m_PositionX[i] = particle.PositionVelocity.x;
+		m_PositionY[i] = particle.PositionVelocity.y;
+		m_VelocityX[i] = particle.PositionVelocity.z;
+		m_VelocityY[i] = particle.PositionVelocity.w;
+		m_Age[i] = particle.State.x;
+		m_Lifetime[i] = particle.State.y;
+		m_Seed[i] = (uint32_t)particle.State.z;
+	}
+	m_CpuValid = true;
+}
+
+void ParticleSystem::Draw(const glm::mat4& viewProjection)
+{
+	m_RenderShader->Bind();
+	m_RenderShader->SetUniformMat4f("u_ViewProjection", viewProjection);
+	m_RenderShader->SetUniform1f("u_Size", m_Settings.Size);
+	m_RenderArrays[m_Current]->Bind();
+	//http://docs.gl/gl4/glDrawArraysInstanced
+	GLCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_Count));
+	RenderStats::Add(RenderStats::DrawCalls);
+	RenderStats::Add(RenderStats::Triangles, (uint64_t)m_Count * 2);
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class Shader;
+class VertexArray;
+class VertexBuffer;
+
+//A 2D particle fountain whose particles live in GPU buffers, simulated and drawn there without coming back to the CPU
+//
+//A particle is 32 bytes: position and velocity, then age, lifetime and the seed of its next respawn. Particles that
+//outlive their lifetime start again at the emitter in a random direction, the rest fall with gravity.
+//The update is one of
+//	TransformFeedback: GL 3.3, a vertex shader reads one buffer and transform feedback writes the other, they swap every update
+//	Compute: GL 4.3 or ARB_compute_shader + ARB_shader_storage_buffer_object, a compute shader updates the current buffer in place
+//	Cpu: SoA arrays (4 particles at a time with SSE), uploaded to the current buffer every update, what the GPU paths are compared with
+//Draw is one instanced triangle strip over the current buffer, a particle per instance.
+//Like SpriteRenderer it expects alpha blending to be enabled.
+class ParticleSystem
+{
+public:
+	enum class UpdateMode
+	{
+		TransformFeedback, Compute, Cpu
+	};
+
+	struct Settings
+	{
+		glm::vec2 Emitter;
+		glm::vec2 Gravity;
+		//the fastest a particle leaves the emitter, the slowest is a quarter of that
+		float Speed;
+		float MinLifetime, MaxLifetime;
+		//radius of a new particle in world units, it shrinks to half of that
+		float Size;
+	};
+
+	//GL thread, the particles start part way through their lives so there is no first burst
+	ParticleSystem(unsigned int count, const Settings& settings = DefaultSettings(), const std::string& shaderDirectory = "res/shaders/");
+	~ParticleSystem();
+
+	static Settings DefaultSettings();
+	//compute shaders and shader storage buffers, on the current context
+	static bool IsComputeSupported();
+
+	//Compute falls back to TransformFeedback when it is not supported or its shader didn't build, returns the mode that is used
+	UpdateMode SetUpdateMode(UpdateMode mode);
+	inline UpdateMode GetUpdateMode() const { return m_Mode; }
+
+	//takes effect for particles as they respawn
+	inline Settings& GetSettings() { return m_Settings; }
+	inline unsigned int GetCount() const { return m_Count; }
+
+	//GL thread
+	void Update(float deltaTime);
+	void Draw(const glm::mat4& viewProjection);
+
+private:
+	struct Particle
+	{
+		glm::vec4 PositionVelocity;
+		//age, lifetime, seed, unused
+		glm::vec4 State;
+	};
+
+	unsigned int m_Count;
+	Settings m_Settings;
+	UpdateMode m_Mode;
+
+	std::unique_ptr<Shader> m_RenderShader;
+	std::unique_ptr<Shader> m_UpdateShader;
+	//only made when compute shaders are supported
+	std::unique_ptr<Shader> m_ComputeShader;
+
+	//the same two buffers as update input (a particle per vertex) and as draw input (a particle per instance)
+	std::unique_ptr<VertexBuffer> m_Buffers[2];
+	std::unique_ptr<VertexArray> m_UpdateArrays[2];
+	std::unique_ptr<VertexArray> m_RenderArrays[2];
+	//the buffer with the latest particles
+	unsigned int m_Current;
+
+	//Cpu mode, valid while the GPU hasn't updated the particles since
+	std::vector<float> m_PositionX, m_PositionY, m_VelocityX, m_VelocityY, m_Age, m_Lifetime;
+	std::vector<uint32_t> m_Seed;
+	std::vector<Particle> m_Staging;
+	bool m_CpuValid;
+
+	void SetUpdateUniforms(Shader& shader, float deltaTime);
+	void UpdateCpu(float deltaTime);
+	void Respawn(unsigned int i);
+	void Pack(unsigned int i);
+	//copies the current buffer into the SoA arrays, after a GPU update
+	void ReadBack();
+};
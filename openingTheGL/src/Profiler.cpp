@@ -0,0 +1,115 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler
+{
+	//every ring ever created, kept after their thread exits so its events can still be exported
+	static std::mutex s_BuffersMutex;
+	static std::vector<std::unique_ptr<ThreadBuffer>> s_Buffers;
+
+	//a pair of readings taken at startup, compared with a pair taken at export to turn ticks into microseconds
+	static const uint64_t s_StartTicks = Now();
+	static const std::chrono::steady_clock::time_point s_StartTime = std::chrono::steady_clock::now();
+
+	static thread_local ThreadBuffer* t_Buffer = nullptr;
+
+	ThreadBuffer& GetThreadBuffer()
+	{
+		if (!t_Buffer)
+		{
+			std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+			buffer->Head.store(0, std::memory_order_relaxed);
+
+			std::lock_guard<std::mutex> lock(s_BuffersMutex);
+			buffer->ThreadID = (unsigned int)s_Buffers.size();
+			buffer->Name = "Thread " + std::to_string(buffer->ThreadID);
+			t_Buffer = buffer.get();
+			s_Buffers.push_back(std::move(buffer));
+		}
+		return *t_Buffer;
+	}
+
+	void SetThreadName(const std::string& name)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		buffer.Name = name;
+	}
+
+	static void WriteString(std::ofstream& stream, const char* text)
+	{
+		stream << '"';
+		for (; *text; text++)
+		{
+			if (*text == '"' || *text == '\\')
+				stream << '\\';
+			stream << *text;
+		}
+		stream << '"';
+	}
+
+	bool ExportChromeTrace(const std::string& filepath)
+	{
+		std::ofstream stream(filepath);
+		if (!stream)
+			return false;
+
+		uint64_t endTicks = Now();
+		double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_StartTime).count();
+		double usPerTick = endTicks > s_StartTicks ? elapsedUs / (double)(endTicks - s_StartTicks) : 0.0;
+
+		struct Copy
+		{
+			const char* Name;
+			uint64_t Begin;
+			uint64_t End;
+		};
+		std::vector<Copy> events;
+
+		//microseconds with ns digits, the default precision would turn long captures into exponents
+		stream << std::fixed << std::setprecision(3);
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		for (const auto& buffer : s_Buffers)
+		{
+			stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->ThreadID << ",\"args\":{\"name\":";
+			WriteString(stream, buffer->Name.c_str());
+			stream << "}}";
+			first = false;
+
+			//copy the ring, then keep only what the thread can't have overwritten meanwhile,
+			//the slot of event i is reused while Head == i + EventsPerThread, before that event is published
+			uint64_t head = buffer->Head.load(std::memory_order_acquire);
+			uint64_t begin = head > EventsPerThread ? head - EventsPerThread : 0;
+			events.clear();
+			for (uint64_t i = begin; i < head; i++)
+			{
+				const Event& event = buffer->Events[i % EventsPerThread];
+				events.push_back({ event.Name.load(std::memory_order_relaxed), event.Begin.load(std::memory_order_relaxed), event.End.load(std::memory_order_relaxed) });
+			}
+			uint64_t newHead = buffer->Head.load(std::memory_order_acquire);
+			uint64_t firstValid = newHead + 1 > EventsPerThread ? newHead + 1 - EventsPerThread : 0;
+
+			for (uint64_t i = firstValid > begin ? firstValid : begin; i < head; i++)
+			{
+				const Copy& event = events[(size_t)(i - begin)];
+				stream << ",\n{\"name\":";
+				WriteString(stream, event.Name);
+				stream << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->ThreadID
+					<< ",\"ts\":" << (double)(event.Begin - s_StartTicks) * usPerTick
+					<< ",\"dur\":" << (double)(event.End - event.Begin) * usPerTick << "}";
+			}
+		}
+
+		stream << "\n]}\n";
+		return (bool)stream;
+	}
+}
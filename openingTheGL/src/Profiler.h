@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_RDTSC 1
+#else
+#include <chrono>
+#endif
+
+//CPU side instrumentation, turned on by defining PROFILING (set for Debug|Win32 in the project, Release builds ship without it)
+//
+//PROFILE_SCOPE("name") times the enclosing scope, PROFILE_FUNCTION() uses the function name.
+//Every zone is written when it ends as one fixed size event into a ring buffer owned by the thread,
+//so recording never locks or allocates, it is two timestamps and a few stores.
+//Each ring keeps the last EventsPerThread zones of its thread, Profiler::ExportChromeTrace writes them all as
+//Chrome trace_event JSON, open it in Perfetto (ui.perfetto.dev) or chrome://tracing.
+//
+//Without PROFILING the macros expand to nothing.
+namespace Profiler
+{
+	static const unsigned int EventsPerThread = 1 << 16;
+
+	//rdtsc where there is one, it does not serialize but zones are far longer than what it can reorder
+	inline uint64_t Now()
+	{
+#ifdef PROFILER_RDTSC
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
+	//fields are relaxed atomics, so the exporter can read a ring while its thread keeps writing (plain stores on x86)
+	struct Event
+	{
+		std::atomic<const char*> Name;
+		std::atomic<uint64_t> Begin;
+		std::atomic<uint64_t> End;
+	};
+
+	struct ThreadBuffer
+	{
+		Event Events[EventsPerThread];
+		//total events written, the ring position is Head % EventsPerThread
+		std::atomic<uint64_t> Head;
+		unsigned int ThreadID;
+		std::string Name;
+	};
+
+	//the calling thread's ring, created the first time the thread records something
+	ThreadBuffer& GetThreadBuffer();
+
+	inline void Record(const char* name, uint64_t begin, uint64_t end)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+		Event& event = buffer.Events[head % EventsPerThread];
+		event.Name.store(name, std::memory_order_relaxed);
+		event.Begin.store(begin, std::memory_order_relaxed);
+		event.End.store(end, std::memory_order_relaxed);
+		buffer.Head.store(head + 1, std::memory_order_release);
+	}
+
+	//shown as the track name in the trace
+	void SetThreadName(const std::string& name);
+
+	//Safe while other threads keep recording, events they overwrite during the export are left out
+	bool ExportChromeTrace(const std::string& filepath);
+
+	class Scope
+	{
+	public:
+		//name has to outlive the profiler (string literals, __FUNCTION__)
+		Scope(const char* name)
+			: m_Name(name), m_Begin(Now())
+		{
+		}
+		~Scope() { Record(m_Name, m_Begin, Now()); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* m_Name;
+		uint64_t m_Begin;
+	};
+}
+
+#ifdef PROFILING
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ::Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_THREAD(name) ::Profiler::SetThreadName(name)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(name)
+
+#endif // PROFILING
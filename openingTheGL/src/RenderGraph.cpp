@@ -0,0 +1,408 @@
+#include "RenderGraph.h"
+#include "Framebuffer.h"
+#include "GpuProfiler.h"
+#include "RenderTargetPool.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+static const char* GetFormatName(TextureFormat format)
+{
+	switch (format)
+	{
+	case TextureFormat::RGBA8: return "RGBA8";
+	case TextureFormat::RGB10A2: return "RGB10A2";
+	case TextureFormat::R11G11B10F: return "R11G11B10F";
+	case TextureFormat::RGBA16F: return "RGBA16F";
+	case TextureFormat::Depth24Stencil8: return "Depth24Stencil8";
+	case TextureFormat::Depth32F: return "Depth32F";
+	}
+	return "?";
+}
+
+static bool Contains(const std::vector<RenderGraph::Resource>& resources, RenderGraph::Resource resource)
+{
+	return std::find(resources.begin(), resources.end(), resource) != resources.end();
+}
+
+static unsigned long long GetSizeInBytes(const RenderTargetDesc& desc)
+{
+	return (unsigned long long)desc.Width * desc.Height * desc.Samples * RenderTarget::GetBytesPerPixel(desc.Format);
+}
+
+RenderGraph::Resource RenderGraph::Builder::Create(const char* name, const RenderTargetDesc& desc)
+{
+	ResourceNode node = {};
+	node.Name = name;
+	node.Desc = desc;
+	m_Graph.m_Resources.push_back(node);
+	return (Resource)m_Graph.m_Resources.size() - 1;
+}
+
+void RenderGraph::Builder::Read(Resource resource)
+{
+	ASSERT(resource < m_Graph.m_Resources.size());
+	std::vector<Resource>& reads = m_Graph.m_Passes[m_Pass].Reads;
+	if (!Contains(reads, resource))
+		reads.push_back(resource);
+}
+
+void RenderGraph::Builder::Write(Resource resource)
+{
+	ASSERT(resource < m_Graph.m_Resources.size());
+	std::vector<Resource>& writes = m_Graph.m_Passes[m_Pass].Writes;
+	if (!Contains(writes, resource))
+		writes.push_back(resource);
+}
+
+void RenderGraph::Builder::SetSideEffect()
+{
+	m_Graph.m_Passes[m_Pass].SideEffect = true;
+}
+
+const RenderTarget& RenderGraph::Context::GetTarget(Resource resource) const
+{
+	const ResourceNode& node = m_Graph.m_Resources[resource];
+	//only transient targets have one, and only while a pass that declared them runs
+	ASSERT(node.Target);
+	return *node.Target;
+}
+
+Framebuffer& RenderGraph::Context::GetScratchFramebuffer() const
+{
+	if (!m_Graph.m_ScratchFramebuffer)
+		m_Graph.m_ScratchFramebuffer.reset(new Framebuffer());
+	return *m_Graph.m_ScratchFramebuffer;
+}
+
+RenderGraph::RenderGraph()
+	: m_PassCount(0), m_Width(0), m_Height(0), m_Stats(), m_Initialized(false), m_CanInvalidate(false)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+}
+
+void RenderGraph::Reset(unsigned int width, unsigned int height)
+{
+	m_Width = width;
+	m_Height = height;
+	m_PassCount = 0;
+	m_Resources.clear();
+
+	//resource 0, the only one that is not transient
+	ResourceNode backbuffer = {};
+	backbuffer.Name = "Backbuffer";
+	backbuffer.Desc = { width, height, TextureFormat::RGBA8 };
+	backbuffer.Imported = true;
+	m_Resources.push_back(backbuffer);
+}
+
+void RenderGraph::AddPass(const char* name, const std::function<void(Builder&)>& setup, const std::function<void(Context&)>& execute)
+{
+	if (m_PassCount == m_Passes.size())
+		m_Passes.emplace_back();
+
+	PassNode& pass = m_Passes[m_PassCount];
+	pass.Name = name;
+	pass.Execute = execute;
+	pass.Reads.clear();
+	pass.Writes.clear();
+	pass.SideEffect = false;
+	pass.Culled = false;
+
+	Builder builder(*this, m_PassCount);
+	m_PassCount++;
+	setup(builder);
+}
+
+void RenderGraph::Compile()
+{
+	PROFILE_FUNCTION();
+
+	//walking backwards, a pass is needed when it writes something a pass after it needs,
+	//and then everything it reads is needed too. The backbuffer is what the frame is for.
+	std::vector<bool> needed(m_Resources.size(), false);
+	needed[GetBackbuffer()] = true;
+	m_Stats = MemoryStats();
+
+	for (unsigned int i = m_PassCount; i-- > 0;)
+	{
+		PassNode& pass = m_Passes[i];
+		bool keep = pass.SideEffect;
+		for (Resource resource : pass.Writes)
+			keep = keep || needed[resource];
+
+		pass.Culled = !keep;
+		if (!keep)
+		{
+			m_Stats.CulledPasses++;
+			continue;
+		}
+		for (Resource resource : pass.Reads)
+			needed[resource] = true;
+	}
+
+	for (ResourceNode& node : m_Resources)
+	{
+		node.FirstUse = -1;
+		node.LastUse = -1;
+		node.Physical = -1;
+		node.Target = nullptr;
+		node.AttachedTo = nullptr;
+	}
+
+	//lifetimes only count the passes that survived
+	for (unsigned int i = 0; i < m_PassCount; i++)
+	{
+		const PassNode& pass = m_Passes[i];
+		if (pass.Culled)
+			continue;
+
+		for (const std::vector<Resource>* list : { &pass.Reads, &pass.Writes })
+			for (Resource resource : *list)
+			{
+				ResourceNode& node = m_Resources[resource];
+				if (node.FirstUse < 0)
+					node.FirstUse = (int)i;
+				node.LastUse = (int)i;
+			}
+	}
+
+	//plays the pool's part ahead of time: a target is taken at its first use and returned after its last,
+	//a later target with the same description gets a returned one instead of new memory
+	struct Allocation
+	{
+		RenderTargetDesc Desc;
+		bool InUse;
+	};
+	std::vector<Allocation> allocations;
+	for (unsigned int i = 0; i < m_PassCount; i++)
+	{
+		for (ResourceNode& node : m_Resources)
+		{
+			if (node.Imported || node.FirstUse != (int)i)
+				continue;
+
+			m_Stats.TransientCount++;
+			m_Stats.PeakWithoutAliasing += GetSizeInBytes(node.Desc);
+			for (unsigned int a = 0; a < allocations.size() && node.Physical < 0; a++)
+				if (!allocations[a].InUse && allocations[a].Desc == node.Desc)
+					node.Physical = (int)a;
+
+			if (node.Physical < 0)
+			{
+				node.Physical = (int)allocations.size();
+				allocations.push_back({ node.Desc, false });
+				m_Stats.PeakAliased += GetSizeInBytes(node.Desc);
+			}
+			allocations[node.Physical].InUse = true;
+		}
+
+		for (const ResourceNode& node : m_Resources)
+			if (!node.Imported && node.LastUse == (int)i)
+				allocations[node.Physical].InUse = false;
+	}
+	m_Stats.PhysicalCount = (unsigned int)allocations.size();
+}
+
+Framebuffer* RenderGraph::BindPassFramebuffer(PassNode& pass, unsigned int& framebufferCount)
+{
+	if (pass.Writes.empty())
+		return nullptr;
+
+	if (Contains(pass.Writes, GetBackbuffer()))
+	{
+		//the default framebuffer can't be mixed with targets of our own
+		ASSERT(pass.Writes.size() == 1);
+		Framebuffer::BindDefault(m_Width, m_Height);
+		return nullptr;
+	}
+
+	if (framebufferCount == m_Framebuffers.size())
+		m_Framebuffers.emplace_back(new Framebuffer());
+	Framebuffer& framebuffer = *m_Framebuffers[framebufferCount++];
+
+	unsigned int color = 0;
+	const RenderTarget* depth = nullptr;
+	for (Resource resource : pass.Writes)
+	{
+		ResourceNode& node = m_Resources[resource];
+		if (node.Target->IsDepth())
+		{
+			ASSERT(!depth);
+			depth = node.Target;
+			node.Attachment = node.Target->HasStencil() ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		}
+		else
+		{
+			ASSERT(color < Framebuffer::MaxColorAttachments);
+			framebuffer.SetColor(color, node.Target);
+			node.Attachment = GL_COLOR_ATTACHMENT0 + color;
+			color++;
+		}
+		node.AttachedTo = &framebuffer;
+	}
+	for (; color < Framebuffer::MaxColorAttachments; color++)
+		framebuffer.SetColor(color, nullptr);
+	framebuffer.SetDepth(depth);
+
+#ifdef DEBUG
+	ASSERT(framebuffer.IsComplete());
+#endif
+	framebuffer.Bind();
+	return &framebuffer;
+}
+
+void RenderGraph::Invalidate(Framebuffer& framebuffer, unsigned int count, const unsigned int* attachments) const
+{
+	if (!m_CanInvalidate || count == 0)
+		return;
+
+	//http://docs.gl/gl4/glInvalidateFramebuffer
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.GetRendererID()));
+	GLCall(glInvalidateFramebuffer(GL_FRAMEBUFFER, (GLsizei)count, attachments));
+}
+
+void RenderGraph::Execute(RenderTargetPool& pool, GpuProfiler* profiler)
+{
+	PROFILE_FUNCTION();
+	if (!m_Initialized)
+	{
+		//core since 4.3, the context asks for 3.3 so it depends on the driver
+		m_CanInvalidate = GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata;
+		m_Initialized = true;
+	}
+
+	Context context(*this, m_Width, m_Height);
+	unsigned int framebufferCount = 0;
+	unsigned int attachments[Framebuffer::MaxColorAttachments + 1];
+
+	for (unsigned int i = 0; i < m_PassCount; i++)
+	{
+		PassNode& pass = m_Passes[i];
+		if (pass.Culled)
+			continue;
+
+		for (const std::vector<Resource>* list : { &pass.Reads, &pass.Writes })
+			for (Resource resource : *list)
+			{
+				ResourceNode& node = m_Resources[resource];
+				if (!node.Imported && !node.Target)
+					node.Target = &pool.Acquire(node.Desc);
+			}
+
+		Framebuffer* framebuffer = BindPassFramebuffer(pass, framebufferCount);
+		context.m_Framebuffer = framebuffer;
+
+		//whatever a pooled target held before is garbage to this pass unless it reads it, so the GPU doesn't need to load it
+		if (framebuffer)
+		{
+			unsigned int count = 0;
+			for (Resource resource : pass.Writes)
+			{
+				const ResourceNode& node = m_Resources[resource];
+				if (node.FirstUse == (int)i && !Contains(pass.Reads, resource))
+					attachments[count++] = node.Attachment;
+			}
+			Invalidate(*framebuffer, count, attachments);
+		}
+
+		{
+			PROFILE_SCOPE(pass.Name);
+			if (profiler)
+				profiler->BeginZone(pass.Name);
+			pass.Execute(context);
+			if (profiler)
+				profiler->EndZone();
+		}
+
+		//targets nobody reads anymore: their contents don't have to be written back (depth after the scene, MSAA after the resolve)
+		//and the memory goes back to the pool for the passes after this one
+		for (const std::vector<Resource>* list : { &pass.Reads, &pass.Writes })
+			for (Resource resource : *list)
+			{
+				ResourceNode& node = m_Resources[resource];
+				if (node.Imported || node.LastUse != (int)i || !node.Target)
+					continue;
+
+				if (node.AttachedTo)
+					Invalidate(*node.AttachedTo, 1, &node.Attachment);
+				pool.Release(*node.Target);
+				node.Target = nullptr;
+			}
+	}
+
+	//a pooled target can be freed and another one created at the same address, attachments must not outlive the frame
+	for (unsigned int i = 0; i < framebufferCount; i++)
+	{
+		for (unsigned int color = 0; color < Framebuffer::MaxColorAttachments; color++)
+			m_Framebuffers[i]->SetColor(color, nullptr);
+		m_Framebuffers[i]->SetDepth(nullptr);
+	}
+	if (m_ScratchFramebuffer)
+	{
+		for (unsigned int color = 0; color < Framebuffer::MaxColorAttachments; color++)
+			m_ScratchFramebuffer->SetColor(color, nullptr);
+		m_ScratchFramebuffer->SetDepth(nullptr);
+	}
+	Framebuffer::BindDefault(m_Width, m_Height);
+}
+
+void RenderGraph::Dump(std::ostream& stream) const
+{
+	auto megabytes = [](unsigned long long bytes) { return bytes / (1024.0 * 1024.0); };
+	std::ios::fmtflags flags = stream.flags();
+	std::streamsize precision = stream.precision();
+	stream << std::fixed << std::setprecision(1);
+
+	stream << "Render graph: " << m_PassCount << " passes, " << m_Stats.CulledPasses << " culled\n";
+	for (unsigned int i = 0; i < m_PassCount; i++)
+	{
+		const PassNode& pass = m_Passes[i];
+		stream << "  " << std::setw(2) << i << " " << std::left << std::setw(16) << pass.Name << std::right;
+		if (pass.Culled)
+			stream << " (culled)";
+		if (pass.SideEffect)
+			stream << " (side effect)";
+		if (!pass.Reads.empty())
+		{
+			stream << " reads";
+			for (Resource resource : pass.Reads)
+				stream << " " << m_Resources[resource].Name;
+		}
+		if (!pass.Writes.empty())
+		{
+			stream << " writes";
+			for (Resource resource : pass.Writes)
+				stream << " " << m_Resources[resource].Name;
+		}
+		stream << '\n';
+	}
+
+	stream << "Transient targets:\n";
+	for (const ResourceNode& node : m_Resources)
+	{
+		if (node.Imported)
+			continue;
+
+		stream << "  " << std::left << std::setw(20) << node.Name << std::right << " "
+			<< node.Desc.Width << "x" << node.Desc.Height << " " << GetFormatName(node.Desc.Format);
+		if (node.Desc.Samples > 1)
+			stream << " x" << node.Desc.Samples;
+		if (node.FirstUse < 0)
+			stream << "  unused\n";
+		else
+			stream << "  passes " << node.FirstUse << "-" << node.LastUse << "  allocation " << node.Physical
+				<< "  " << megabytes(GetSizeInBytes(node.Desc)) << " MB\n";
+	}
+
+	stream << "Peak transient memory: " << megabytes(m_Stats.PeakAliased) << " MB with aliasing ("
+		<< m_Stats.PhysicalCount << " allocations), " << megabytes(m_Stats.PeakWithoutAliasing) << " MB without ("
+		<< m_Stats.TransientCount << " targets)\n";
+	stream.flags(flags);
+	stream.precision(precision);
+}
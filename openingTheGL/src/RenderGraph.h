@@ -0,0 +1,145 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "RenderTarget.h"
+
+class Framebuffer;
+class GpuProfiler;
+class RenderTargetPool;
+
+//Builds a frame out of passes that say which render targets they read and write, instead of ordering draws and targets by hand
+//
+//Every frame: Reset(), AddPass() for every pass in the order they should run, Compile(), Execute().
+//- Passes run in the order they were added, but only if something needs what they write: a pass is kept when it writes
+//  the backbuffer, is marked as having side effects, or writes a target that a later kept pass reads. Everything else is culled.
+//- Transient targets (Create) only live from the first to the last kept pass that uses them. They are taken from the
+//  RenderTargetPool at their first use and given back after their last, so targets with the same description whose lifetimes
+//  don't overlap end up sharing one GPU allocation (GL can't alias different textures in the same memory, this is the closest thing).
+//- Contents nobody will read again are thrown away with glInvalidateFramebuffer (GL 4.3 / ARB_invalidate_subdata),
+//  so tiled and bandwidth limited GPUs don't have to write them back or load them first.
+//
+//Names of passes and targets have to outlive the graph (string literals), they end up in the GPU profiler too.
+//GL thread only.
+class RenderGraph
+{
+public:
+	typedef unsigned int Resource;
+	static const Resource InvalidResource = 0xFFFFFFFF;
+
+	class Builder
+	{
+	public:
+		//a target that only exists for this frame
+		Resource Create(const char* name, const RenderTargetDesc& desc);
+		//sampled by the pass
+		void Read(Resource resource);
+		//drawn into by the pass, a pass writes either the backbuffer or up to 4 color targets and a depth target
+		void Write(Resource resource);
+		//keeps the pass even if nothing reads what it writes (readbacks, queries, ...)
+		void SetSideEffect();
+
+	private:
+		friend class RenderGraph;
+		Builder(RenderGraph& graph, unsigned int pass) : m_Graph(graph), m_Pass(pass) {}
+		RenderGraph& m_Graph;
+		unsigned int m_Pass;
+	};
+
+	class Context
+	{
+	public:
+		//the target behind a resource the pass reads or writes
+		const RenderTarget& GetTarget(Resource resource) const;
+		//a framebuffer free to use for blits (resolves, copies), attachments are the pass' business
+		Framebuffer& GetScratchFramebuffer() const;
+		//the framebuffer with what the pass writes attached, nullptr when it writes the backbuffer (or nothing)
+		inline Framebuffer* GetFramebuffer() const { return m_Framebuffer; }
+		inline unsigned int GetWidth() const { return m_Width; }
+		inline unsigned int GetHeight() const { return m_Height; }
+
+	private:
+		friend class RenderGraph;
+		Context(RenderGraph& graph, unsigned int width, unsigned int height) : m_Graph(graph), m_Framebuffer(nullptr), m_Width(width), m_Height(height) {}
+		RenderGraph& m_Graph;
+		Framebuffer* m_Framebuffer;
+		unsigned int m_Width;
+		unsigned int m_Height;
+	};
+
+	struct MemoryStats
+	{
+		//bytes the transient targets take when targets whose lifetimes don't overlap share an allocation
+		unsigned long long PeakAliased;
+		//what it would be if every transient target had its own memory for the whole frame
+		unsigned long long PeakWithoutAliasing;
+		unsigned int TransientCount;
+		//distinct allocations once lifetimes are taken into account
+		unsigned int PhysicalCount;
+		unsigned int CulledPasses;
+	};
+
+	RenderGraph();
+	~RenderGraph();
+
+	//starts a new frame, the backbuffer (default framebuffer) has the given size
+	void Reset(unsigned int width, unsigned int height);
+	Resource GetBackbuffer() const { return 0; }
+
+	void AddPass(const char* name, const std::function<void(Builder&)>& setup, const std::function<void(Context&)>& execute);
+
+	void Compile();
+	//optionally with a GPU profiler zone around every pass
+	void Execute(RenderTargetPool& pool, GpuProfiler* profiler = nullptr);
+
+	inline const MemoryStats& GetMemoryStats() const { return m_Stats; }
+	//passes, what was culled, and every transient target with its lifetime and the allocation it got
+	void Dump(std::ostream& stream) const;
+
+private:
+	struct ResourceNode
+	{
+		const char* Name;
+		RenderTargetDesc Desc;
+		bool Imported;
+		//first and last kept pass that uses it
+		int FirstUse;
+		int LastUse;
+		//index of the allocation it shares with other resources, from Compile()
+		int Physical;
+		//while executing
+		const RenderTarget* Target;
+		//the pass framebuffer it was last drawn into, and as which attachment
+		Framebuffer* AttachedTo;
+		unsigned int Attachment;
+	};
+
+	struct PassNode
+	{
+		const char* Name;
+		std::function<void(Context&)> Execute;
+		std::vector<Resource> Reads;
+		std::vector<Resource> Writes;
+		bool SideEffect;
+		bool Culled;
+	};
+
+	std::vector<ResourceNode> m_Resources;
+	//only the first m_PassCount are this frame's, the rest keep their vectors' memory for the next frames
+	std::vector<PassNode> m_Passes;
+	unsigned int m_PassCount;
+	unsigned int m_Width;
+	unsigned int m_Height;
+	MemoryStats m_Stats;
+	bool m_Initialized;
+	bool m_CanInvalidate;
+
+	//kept between frames, one per pass position, the attachments change but the objects stay
+	std::vector<std::unique_ptr<Framebuffer>> m_Framebuffers;
+	std::unique_ptr<Framebuffer> m_ScratchFramebuffer;
+
+	Framebuffer* BindPassFramebuffer(PassNode& pass, unsigned int& framebufferCount);
+	void Invalidate(Framebuffer& framebuffer, unsigned int count, const unsigned int* attachments) const;
+};
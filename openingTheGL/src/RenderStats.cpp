@@ -0,0 +1,110 @@
+#include "RenderStats.h"
+
+#include <mutex>
+#include "imgui/imgui.h"
+
+namespace RenderStats
+{
+	std::atomic<uint64_t> s_Current[CounterCount];
+
+	//the last HistorySize frames, written by EndFrame and read from the UI
+	static std::mutex s_HistoryMutex;
+	static FrameStats s_History[HistorySize];
+	static unsigned int s_HistoryCount = 0;
+	static unsigned int s_HistoryNext = 0;
+
+	void EndFrame()
+	{
+		FrameStats frame;
+		for (unsigned int i = 0; i < CounterCount; i++)
+			frame.Values[i] = s_Current[i].exchange(0, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(s_HistoryMutex);
+		s_History[s_HistoryNext] = frame;
+		s_HistoryNext = (s_HistoryNext + 1) % HistorySize;
+		if (s_HistoryCount < HistorySize)
+			s_HistoryCount++;
+	}
+
+	FrameStats GetLastFrame()
+	{
+		std::lock_guard<std::mutex> lock(s_HistoryMutex);
+		if (s_HistoryCount == 0)
+			return FrameStats();
+		return s_History[(s_HistoryNext + HistorySize - 1) % HistorySize];
+	}
+
+	FrameStats GetAverage()
+	{
+		FrameStats average;
+		std::lock_guard<std::mutex> lock(s_HistoryMutex);
+		if (s_HistoryCount == 0)
+			return average;
+
+		for (unsigned int frame = 0; frame < s_HistoryCount; frame++)
+			for (unsigned int i = 0; i < CounterCount; i++)
+				average.Values[i] += s_History[frame].Values[i];
+		for (unsigned int i = 0; i < CounterCount; i++)
+			average.Values[i] /= s_HistoryCount;
+		return average;
+	}
+
+	FrameStats GetPeak()
+	{
+		FrameStats peak;
+		std::lock_guard<std::mutex> lock(s_HistoryMutex);
+		for (unsigned int frame = 0; frame < s_HistoryCount; frame++)
+			for (unsigned int i = 0; i < CounterCount; i++)
+				if (s_History[frame].Values[i] > peak.Values[i])
+					peak.Values[i] = s_History[frame].Values[i];
+		return peak;
+	}
+
+	FrameStats GetCurrentFrame()
+	{
+		FrameStats current;
+		for (unsigned int i = 0; i < CounterCount; i++)
+			current.Values[i] = s_Current[i].load(std::memory_order_relaxed);
+		return current;
+	}
+
+	const char* GetName(Counter counter)
+	{
+		switch (counter)
+		{
+		case DrawCalls: return "Draw calls";
+		case Triangles: return "Triangles";
+		case ProgramBinds: return "Program binds";
+		case VertexArrayBinds: return "Vertex array binds";
+		case BufferBinds: return "Buffer binds";
+		case TextureBinds: return "Texture binds";
+		case UniformUploads: return "Uniform uploads";
+		case BufferBytesUploaded: return "Buffer bytes uploaded";
+		case TextureBytesUploaded: return "Texture bytes uploaded";
+		default: return "";
+		}
+	}
+
+	void DrawPanel()
+	{
+		FrameStats last = GetLastFrame();
+		FrameStats average = GetAverage();
+		FrameStats peak = GetPeak();
+
+		ImGui::Columns(4, "RenderStats");
+		ImGui::Text("Per frame"); ImGui::NextColumn();
+		ImGui::Text("Last"); ImGui::NextColumn();
+		ImGui::Text("Average"); ImGui::NextColumn();
+		ImGui::Text("Peak"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (unsigned int i = 0; i < CounterCount; i++)
+		{
+			Counter counter = (Counter)i;
+			ImGui::Text("%s", GetName(counter)); ImGui::NextColumn();
+			ImGui::Text("%llu", (unsigned long long)last[counter]); ImGui::NextColumn();
+			ImGui::Text("%llu", (unsigned long long)average[counter]); ImGui::NextColumn();
+			ImGui::Text("%llu", (unsigned long long)peak[counter]); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+}
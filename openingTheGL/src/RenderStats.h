@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+//Counts what the renderer does every frame: draws, triangles, state changes and uploads
+//
+//Renderer, Shader, Texture and the buffer classes add to the counters of the current frame as they talk to GL,
+//EndFrame() closes the frame and keeps it in a short history for the averages and peaks.
+//Counting is a relaxed load and store, only the thread that owns the GL context adds, so it costs about as much as a plain increment.
+//
+//The results can be read from any thread, for tests or the ImGui panel.
+namespace RenderStats
+{
+	enum Counter : unsigned int
+	{
+		DrawCalls,
+		Triangles,
+		ProgramBinds,
+		VertexArrayBinds,
+		BufferBinds,
+		TextureBinds,
+		UniformUploads,
+		BufferBytesUploaded,
+		TextureBytesUploaded,
+		CounterCount
+	};
+
+	//frames the averages and peaks are taken over
+	static const unsigned int HistorySize = 120;
+
+	struct FrameStats
+	{
+		uint64_t Values[CounterCount] = {};
+
+		inline uint64_t operator[](Counter counter) const { return Values[counter]; }
+	};
+
+	extern std::atomic<uint64_t> s_Current[CounterCount];
+
+	//GL thread
+	inline void Add(Counter counter, uint64_t amount = 1)
+	{
+		s_Current[counter].store(s_Current[counter].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+	//call after the swap, starts counting the next frame
+	void EndFrame();
+
+	//any thread
+	FrameStats GetLastFrame();
+	//averages are rounded down
+	FrameStats GetAverage();
+	FrameStats GetPeak();
+	//counted since the last EndFrame, things like uploads done at load time show up here before the first frame ends
+	FrameStats GetCurrentFrame();
+	const char* GetName(Counter counter);
+
+	//a table with the last frame, average and peak of every counter, into the current ImGui window
+	void DrawPanel();
+}
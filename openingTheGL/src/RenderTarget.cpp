@@ -0,0 +1,93 @@
+#include "RenderTarget.h"
+#include "Renderer.h"
+
+struct FormatInfo
+{
+	GLenum InternalFormat;
+	//what glTexImage2D wants for a texture that starts out empty
+	GLenum Format;
+	GLenum Type;
+	unsigned int BytesPerPixel;
+};
+
+static FormatInfo GetFormatInfo(TextureFormat format)
+{
+	switch (format)
+	{
+	case TextureFormat::RGBA8: return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+	case TextureFormat::RGB10A2: return { GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, 4 };
+	case TextureFormat::R11G11B10F: return { GL_R11F_G11F_B10F, GL_RGB, GL_UNSIGNED_INT_10F_11F_11F_REV, 4 };
+	case TextureFormat::RGBA16F: return { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8 };
+	case TextureFormat::Depth24Stencil8: return { GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, 4 };
+	case TextureFormat::Depth32F: return { GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, 4 };
+	}
+	ASSERT(false);
+	return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+}
+
+RenderTarget::RenderTarget(const RenderTargetDesc& desc)
+	: m_RendererID(0), m_Desc(desc)
+{
+	FormatInfo info = GetFormatInfo(desc.Format);
+
+	if (IsRenderbuffer())
+	{
+		//http://docs.gl/gl4/glRenderbufferStorageMultisample
+		GLCall(glGenRenderbuffers(1, &m_RendererID));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_RendererID));
+		GLCall(glRenderbufferStorageMultisample(GL_RENDERBUFFER, (GLsizei)desc.Samples, info.InternalFormat, (GLsizei)desc.Width, (GLsizei)desc.Height));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+		return;
+	}
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+
+	//no mipmaps, render targets are drawn at one size, linear for passes that sample them scaled, clamped so nothing bleeds in from the other edge
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+
+	//nullptr data: only allocates, nothing is uploaded
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, info.InternalFormat, (GLsizei)desc.Width, (GLsizei)desc.Height, 0, info.Format, info.Type, nullptr));
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+RenderTarget::~RenderTarget()
+{
+	if (IsRenderbuffer())
+		GLCall(glDeleteRenderbuffers(1, &m_RendererID));
+	else
+		GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void RenderTarget::Bind(unsigned int slot) const
+{
+	ASSERT(!IsRenderbuffer());
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Add(RenderStats::TextureBinds);
+}
+
+bool RenderTarget::IsDepth() const
+{
+	return m_Desc.Format == TextureFormat::Depth24Stencil8 || m_Desc.Format == TextureFormat::Depth32F;
+}
+
+bool RenderTarget::HasStencil() const
+{
+	return m_Desc.Format == TextureFormat::Depth24Stencil8;
+}
+
+unsigned long long RenderTarget::GetSizeInBytes() const
+{
+	return (unsigned long long)m_Desc.Width * m_Desc.Height * GetBytesPerPixel(m_Desc.Format) * m_Desc.Samples;
+}
+
+unsigned int RenderTarget::GetBytesPerPixel(TextureFormat format)
+{
+	return GetFormatInfo(format).BytesPerPixel;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+enum class TextureFormat : unsigned char
+{
+	RGBA8,
+	//10 bits per color channel for the same memory as RGBA8, 2 bit alpha
+	RGB10A2,
+	//HDR color without alpha in 32 bits, unsigned
+	R11G11B10F,
+	RGBA16F,
+	Depth24Stencil8,
+	Depth32F
+};
+
+struct RenderTargetDesc
+{
+	unsigned int Width;
+	unsigned int Height;
+	TextureFormat Format;
+	//more than 1 for MSAA, resolve it into a single sampled target to read from it
+	unsigned int Samples = 1;
+
+	inline bool operator==(const RenderTargetDesc& other) const
+	{
+		return Width == other.Width && Height == other.Height && Format == other.Format && Samples == other.Samples;
+	}
+	inline bool operator!=(const RenderTargetDesc& other) const { return !(*this == other); }
+};
+
+//GPU memory that a Framebuffer can draw into
+//A single sampled target is a texture, so a later pass can sample it,
+//a multisampled one is a renderbuffer since it is only ever drawn to and resolved
+class RenderTarget
+{
+public:
+	RenderTarget(const RenderTargetDesc& desc);
+	~RenderTarget();
+
+	RenderTarget(const RenderTarget&) = delete;
+	RenderTarget& operator=(const RenderTarget&) = delete;
+
+	//binds the texture to a slot, only for single sampled targets
+	void Bind(unsigned int slot = 0) const;
+
+	inline const RenderTargetDesc& GetDesc() const { return m_Desc; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsRenderbuffer() const { return m_Desc.Samples > 1; }
+	bool IsDepth() const;
+	bool HasStencil() const;
+	//an estimate, drivers add their own padding and compression
+	unsigned long long GetSizeInBytes() const;
+
+	static unsigned int GetBytesPerPixel(TextureFormat format);
+
+private:
+	unsigned int m_RendererID;
+	RenderTargetDesc m_Desc;
+};
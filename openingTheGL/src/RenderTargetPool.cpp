@@ -0,0 +1,61 @@
+#include "RenderTargetPool.h"
+#include "Renderer.h"
+
+#include <algorithm>
+
+RenderTargetPool::RenderTargetPool()
+	: m_Frame(0), m_CreatedCount(0)
+{
+}
+
+RenderTarget& RenderTargetPool::Acquire(const RenderTargetDesc& desc)
+{
+	//there are only ever a handful of targets, a linear search is cheaper than hashing the description
+	for (Entry& entry : m_Entries)
+		if (!entry.InUse && entry.Target->GetDesc() == desc)
+		{
+			entry.InUse = true;
+			entry.LastUsedFrame = m_Frame;
+			return *entry.Target;
+		}
+
+	m_Entries.push_back({ std::unique_ptr<RenderTarget>(new RenderTarget(desc)), true, m_Frame });
+	m_CreatedCount++;
+	return *m_Entries.back().Target;
+}
+
+void RenderTargetPool::Release(const RenderTarget& target)
+{
+	for (Entry& entry : m_Entries)
+		if (entry.Target.get() == &target)
+		{
+			ASSERT(entry.InUse);
+			entry.InUse = false;
+			return;
+		}
+	//not one of ours
+	ASSERT(false);
+}
+
+void RenderTargetPool::EndFrame()
+{
+	m_Frame++;
+	m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(), [this](const Entry& entry) {
+		return !entry.InUse && m_Frame - entry.LastUsedFrame > FramesBeforeEviction;
+	}), m_Entries.end());
+}
+
+void RenderTargetPool::Trim()
+{
+	m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(), [](const Entry& entry) {
+		return !entry.InUse;
+	}), m_Entries.end());
+}
+
+unsigned long long RenderTargetPool::GetSizeInBytes() const
+{
+	unsigned long long size = 0;
+	for (const Entry& entry : m_Entries)
+		size += entry.Target->GetSizeInBytes();
+	return size;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "RenderTarget.h"
+
+//Hands out render targets for passes that only need them for part of a frame (MSAA buffers, blur ping-pong, ...)
+//
+//Acquire() gives back a free target with exactly the same description if there is one and only creates a new one otherwise,
+//Release() makes it available to the next pass, in this frame or a later one. So after the first frame nothing is allocated
+//unless the descriptions change (a resize), and targets nobody asked for in a while are freed by EndFrame().
+//
+//Only from the thread that owns the GL context.
+class RenderTargetPool
+{
+public:
+	//unused targets are freed after this many frames
+	static const unsigned int FramesBeforeEviction = 8;
+
+	RenderTargetPool();
+
+	RenderTarget& Acquire(const RenderTargetDesc& desc);
+	void Release(const RenderTarget& target);
+	//call once per frame, frees targets that were not acquired in the last FramesBeforeEviction frames
+	void EndFrame();
+	//frees every target that is not in use
+	void Trim();
+
+	inline unsigned int GetTargetCount() const { return (unsigned int)m_Entries.size(); }
+	//targets created since the pool was made, stops growing once the passes are the same every frame
+	inline unsigned int GetCreatedCount() const { return m_CreatedCount; }
+	unsigned long long GetSizeInBytes() const;
+
+private:
+	struct Entry
+	{
+		std::unique_ptr<RenderTarget> Target;
+		bool InUse;
+		unsigned long long LastUsedFrame;
+	};
+
+	std::vector<Entry> m_Entries;
+	unsigned long long m_Frame;
+	unsigned int m_CreatedCount;
+};
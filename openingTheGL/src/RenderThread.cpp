@@ -0,0 +1,382 @@
+#include "RenderThread.h"
+#include "Framebuffer.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include "imgui/imgui_impl_opengl3.h"
+
+//spin for a bit, then give the core away, used by both sides when the other one is behind
+static void Backoff(unsigned int& spins)
+{
+	if (spins++ < 64)
+		std::this_thread::yield();
+	else
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+//running average, so the numbers shown in the UI don't flicker every frame
+static void Accumulate(std::atomic<float>& average, float value)
+{
+	average.store(average.load(std::memory_order_relaxed) * 0.95f + value * 0.05f, std::memory_order_relaxed);
+}
+
+//capture.y4m -> capture_2.y4m
+static std::string GetNumberedFile(const std::string& filepath, unsigned int number)
+{
+	size_t dot = filepath.find_last_of('.');
+	size_t separator = filepath.find_last_of("/\\");
+	if (dot == std::string::npos || (separator != std::string::npos && dot < separator))
+		dot = filepath.size();
+	return filepath.substr(0, dot) + "_" + std::to_string(number) + filepath.substr(dot);
+}
+
+RenderThread::RenderThread(GLFWwindow* window, Renderer& renderer, unsigned int framesInFlight)
+	: m_Window(window), m_Renderer(renderer), m_Current(0), m_ReuseCurrent(false), m_Pacer(window), m_Quit(false), m_Latency(0.0f), m_RenderTime(0.0f), m_PooledTargets(0), m_PooledBytes(0),
+	m_TransientBytes(0), m_TransientBytesWithoutAliasing(0), m_DumpGraph(false),
+	m_FrameNumber(0), m_CapturedBefore(0), m_DroppedBefore(0), m_CapturedFrames(0), m_DroppedCaptureFrames(0), m_CaptureFiles(0)
+{
+	m_Readback.SetCallback([this](const unsigned char* pixels, unsigned int width, unsigned int height, unsigned long long) {
+		m_VideoWriter.Write(pixels, width, height);
+	});
+	m_FramesInFlight = framesInFlight < 2 ? 2 : (framesInFlight > MaxFramesInFlight ? MaxFramesInFlight : framesInFlight);
+	for (unsigned int i = 0; i < m_FramesInFlight; i++)
+		m_Free.Push(i);
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+	//the frames still in flight belong in the file too
+	m_Readback.Flush();
+	m_VideoWriter.Close();
+
+	for (auto& frame : m_Frames)
+		for (ImDrawList* list : frame.DrawLists)
+			IM_DELETE(list);
+}
+
+void RenderThread::Start()
+{
+	//headless contexts are not GLFW's to hand over, they always render inline
+	if (IsRunning() || !m_Window)
+		return;
+
+	//a context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	m_Quit = false;
+	m_Thread = std::thread(&RenderThread::Loop, this);
+}
+
+void RenderThread::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	m_Quit.store(true, std::memory_order_release);
+	m_Thread.join();
+	glfwMakeContextCurrent(m_Window);
+}
+
+FrameData& RenderThread::BeginFrame()
+{
+	PROFILE_SCOPE("WaitForFreeFrame");
+	if (m_ReuseCurrent)
+	{
+		m_ReuseCurrent = false;
+		m_Frames[m_Current].AfterSkip = true;
+		return m_Frames[m_Current];
+	}
+	unsigned int spins = 0;
+	while (!m_Free.Pop(m_Current))
+		Backoff(spins);
+
+	m_Frames[m_Current].AfterSkip = false;
+	return m_Frames[m_Current];
+}
+
+void RenderThread::EndFrame()
+{
+	PROFILE_FUNCTION();
+	FrameData& frame = m_Frames[m_Current];
+	CopyDrawData(ImGui::GetDrawData(), frame);
+
+	if (!IsRunning())
+	{
+		Render(frame);
+		m_Free.Push(m_Current);
+		return;
+	}
+
+	//there are never more frames than queue slots, so this can't fail
+	m_Submitted.Push(m_Current);
+}
+
+void RenderThread::SkipFrame()
+{
+	//the render side never saw it, so the next BeginFrame hands out the same frame again
+	//(pushing it back onto m_Free would make this a second producer of that queue)
+	m_ReuseCurrent = true;
+}
+
+void RenderThread::CopyDrawData(const ImDrawData* source, FrameData& frame)
+{
+	frame.DrawData = *source;
+
+	//keep the ImDrawList objects around, copying into them reuses their buffers instead of allocating every frame
+	while (frame.DrawLists.Size < source->CmdListsCount)
+		frame.DrawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+
+	for (int i = 0; i < source->CmdListsCount; i++)
+	{
+		const ImDrawList* from = source->CmdLists[i];
+		ImDrawList* to = frame.DrawLists[i];
+		to->CmdBuffer = from->CmdBuffer;
+		to->IdxBuffer = from->IdxBuffer;
+		to->VtxBuffer = from->VtxBuffer;
+		to->Flags = from->Flags;
+	}
+	frame.DrawData.CmdLists = frame.DrawLists.Data;
+}
+
+void RenderThread::Loop()
+{
+	glfwMakeContextCurrent(m_Window);
+	PROFILE_THREAD("Render");
+
+	unsigned int spins = 0;
+	while (true)
+	{
+		unsigned int index;
+		if (m_Submitted.Pop(index))
+		{
+			Render(m_Frames[index]);
+			m_Free.Push(index);
+			spins = 0;
+			continue;
+		}
+
+		if (m_Quit.load(std::memory_order_acquire))
+		{
+			//anything pushed before the quit flag is visible now, draw it before leaving
+			while (m_Submitted.Pop(index))
+			{
+				Render(m_Frames[index]);
+				m_Free.Push(index);
+			}
+			break;
+		}
+
+		Backoff(spins);
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::Render(FrameData& frame)
+{
+	PROFILE_FUNCTION();
+	auto start = std::chrono::steady_clock::now();
+
+	m_Pacer.SetSettings(frame.Pacing);
+	m_Profiler.BeginFrame();
+	m_Readback.Poll();
+	UpdateCapture(frame);
+	BuildGraph(frame);
+	m_Graph.Compile();
+	m_Graph.Execute(m_TargetPool, &m_Profiler);
+	m_Profiler.EndFrame();
+
+	/* Swap front and back buffers */
+	if (m_Window)
+	{
+		PROFILE_SCOPE("Swap");
+		GLCall(glfwSwapBuffers(m_Window));
+	}
+	//submission and latency end at the swap, what the pacer waits after it is neither
+	auto end = std::chrono::steady_clock::now();
+	m_Pacer.EndFrame(frame.InputTime, frame.AfterSkip);
+
+	RenderStats::EndFrame();
+	m_TargetPool.EndFrame();
+	m_PooledTargets.store(m_TargetPool.GetTargetCount(), std::memory_order_relaxed);
+	m_PooledBytes.store(m_TargetPool.GetSizeInBytes(), std::memory_order_relaxed);
+	m_TransientBytes.store(m_Graph.GetMemoryStats().PeakAliased, std::memory_order_relaxed);
+	m_TransientBytesWithoutAliasing.store(m_Graph.GetMemoryStats().PeakWithoutAliasing, std::memory_order_relaxed);
+	if (m_DumpGraph.exchange(false, std::memory_order_relaxed))
+		m_Graph.Dump(std::cout);
+	m_CapturedFrames.store(m_CapturedBefore + m_VideoWriter.GetWrittenFrames(), std::memory_order_relaxed);
+	m_DroppedCaptureFrames.store(m_DroppedBefore + m_VideoWriter.GetDroppedFrames(), std::memory_order_relaxed);
+	m_FrameNumber++;
+
+	Accumulate(m_RenderTime, std::chrono::duration<float, std::milli>(end - start).count());
+	Accumulate(m_Latency, std::chrono::duration<float, std::milli>(end - frame.InputTime).count());
+}
+
+void RenderThread::BuildGraph(FrameData& frame)
+{
+	m_Graph.Reset(frame.Width, frame.Height);
+	RenderGraph::Resource backbuffer = m_Graph.GetBackbuffer();
+
+	//with MSAA the scene goes into a multisampled target first and is resolved into the default framebuffer after
+	//with blur passes it ends up in a target of its own (resolved into one with MSAA), the last blur pass writes the default framebuffer
+	bool msaa = frame.Samples > 1 && frame.Width > 0 && frame.Height > 0;
+	bool blur = frame.BlurPasses > 0 && frame.Width > 0 && frame.Height > 0;
+	RenderTargetDesc colorDesc = { frame.Width, frame.Height, TextureFormat::RGBA8 };
+	RenderGraph::Resource scene = backbuffer;
+	RenderGraph::Resource sceneColor = backbuffer;
+
+	//the default framebuffer brings its own depth buffer, a target of our own needs one with the same sample count
+	m_Graph.AddPass("Scene", [&](RenderGraph::Builder& builder) {
+		if (msaa)
+		{
+			scene = builder.Create("SceneColorMSAA", { frame.Width, frame.Height, TextureFormat::RGBA8, frame.Samples });
+			if (frame.DepthTest)
+				builder.Write(builder.Create("SceneDepthMSAA", { frame.Width, frame.Height, TextureFormat::Depth24Stencil8, frame.Samples }));
+		}
+		else if (blur)
+		{
+			scene = sceneColor = builder.Create("SceneColor", colorDesc);
+			if (frame.DepthTest)
+				builder.Write(builder.Create("SceneDepth", { frame.Width, frame.Height, TextureFormat::Depth24Stencil8 }));
+		}
+		builder.Write(scene);
+	}, [this, &frame](RenderGraph::Context&) {
+		m_Renderer.SetDepthTest(frame.DepthTest);
+		m_Renderer.SetDepthPrepass(frame.DepthPrepass);
+		m_Renderer.Clear();
+		m_Renderer.Submit(frame.CommandLists);
+	});
+
+	if (msaa)
+	{
+		m_Graph.AddPass("Resolve", [&](RenderGraph::Builder& builder) {
+			builder.Read(scene);
+			if (blur)
+				sceneColor = builder.Create("SceneColor", colorDesc);
+			builder.Write(sceneColor);
+		}, [scene](RenderGraph::Context& context) {
+			Framebuffer& framebuffer = context.GetScratchFramebuffer();
+			framebuffer.SetColor(0, &context.GetTarget(scene));
+			framebuffer.Resolve(context.GetFramebuffer(), context.GetWidth(), context.GetHeight());
+			if (context.GetFramebuffer())
+				context.GetFramebuffer()->Bind();
+			else
+				Framebuffer::BindDefault(context.GetWidth(), context.GetHeight());
+		});
+	}
+
+	//every pass reads the target the one before it wrote, a target is free again once the pass after it has read it,
+	//so from the third target on the pool hands back the memory of the one two passes earlier (see RenderGraph::Dump)
+	RenderGraph::Resource source = sceneColor;
+	for (unsigned int i = 0; blur && i < frame.BlurPasses * 2; i++)
+	{
+		bool horizontal = i % 2 == 0;
+		bool last = i + 1 == frame.BlurPasses * 2;
+		RenderGraph::Resource blurred = backbuffer;
+		m_Graph.AddPass(horizontal ? "BlurHorizontal" : "BlurVertical", [&](RenderGraph::Builder& builder) {
+			builder.Read(source);
+			if (!last)
+				blurred = builder.Create(horizontal ? "BlurredHorizontal" : "BlurredVertical", colorDesc);
+			builder.Write(blurred);
+		}, [this, source, horizontal](RenderGraph::Context& context) {
+			DrawBlur(context.GetTarget(source), horizontal);
+		});
+		source = blurred;
+	}
+
+	m_Graph.AddPass("ImGui", [&](RenderGraph::Builder& builder) {
+		builder.Write(backbuffer);
+	}, [&frame](RenderGraph::Context&) {
+		ImGui_ImplOpenGL3_NewFrame();
+		ImGui_ImplOpenGL3_RenderDrawData(&frame.DrawData);
+	});
+
+	//nothing in the graph reads what this produces, it is kept for its side effect
+	if (m_VideoWriter.IsOpen())
+	{
+		m_Graph.AddPass("Capture", [&](RenderGraph::Builder& builder) {
+			builder.Read(backbuffer);
+			builder.SetSideEffect();
+		}, [this](RenderGraph::Context& context) {
+			m_Readback.Read(Framebuffer::GetDefault(), context.GetWidth(), context.GetHeight(), m_FrameNumber);
+		});
+	}
+}
+
+void RenderThread::DrawBlur(const RenderTarget& source, bool horizontal)
+{
+	if (!m_BlurShader)
+	{
+		m_BlurShader.reset(new Shader("res/shaders/Blur.shader"));
+		//core profile draws need a vertex array, even one without attributes
+		m_FullscreenVA.reset(new VertexArray());
+		m_BlurShader->Bind();
+		m_BlurShader->SetUniform1i("u_Texture", 1);
+	}
+
+	//unit 0 is left to the texture the scene draws with, see the state ImGui leaves
+	source.Bind(1);
+	m_BlurShader->Bind();
+	const RenderTargetDesc& desc = source.GetDesc();
+	m_BlurShader->SetUniform2f("u_Step", horizontal ? 1.0f / desc.Width : 0.0f, horizontal ? 0.0f : 1.0f / desc.Height);
+	m_FullscreenVA->Bind();
+
+	//every pixel is written, nothing to blend with
+	GLCall(glDisable(GL_BLEND));
+	GLCall(glDrawArrays(GL_TRIANGLES, 0, 3));
+	RenderStats::Add(RenderStats::DrawCalls);
+	GLCall(glEnable(GL_BLEND));
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCall(glActiveTexture(GL_TEXTURE0));
+}
+
+void RenderThread::UpdateCapture(const FrameData& frame)
+{
+	bool capturing = m_VideoWriter.IsOpen();
+	if (frame.CaptureFile.empty())
+		m_CaptureFile.clear();
+	//a video has one size, after a resize the recording goes on in a new file
+	bool resized = capturing && (frame.Width != m_VideoWriter.GetWidth() || frame.Height != m_VideoWriter.GetHeight());
+	if (!resized && (frame.CaptureFile.empty() ? !capturing : capturing && frame.CaptureFile == m_CaptureFile))
+		return;
+	//don't try again every frame, and there is nothing to record while the window is minimized
+	if (!capturing && (frame.CaptureFile == m_FailedCaptureFile || frame.Width == 0 || frame.Height == 0))
+		return;
+
+	//finish the old file with every frame that was already read for it
+	m_Readback.Flush();
+	bool continuing = !frame.CaptureFile.empty() && frame.CaptureFile == m_CaptureFile;
+	if (!continuing)
+	{
+		m_CapturedBefore = 0;
+		m_DroppedBefore = 0;
+		m_CaptureFiles.store(0, std::memory_order_relaxed);
+	}
+	else if (capturing)
+	{
+		m_CapturedBefore += m_VideoWriter.GetWrittenFrames();
+		m_DroppedBefore += m_VideoWriter.GetDroppedFrames();
+	}
+	m_VideoWriter.Close();
+	m_FailedCaptureFile.clear();
+	m_CaptureFile = frame.CaptureFile;
+	if (frame.CaptureFile.empty() || frame.Width == 0 || frame.Height == 0)
+		return;
+
+	unsigned int files = m_CaptureFiles.load(std::memory_order_relaxed) + 1;
+	std::string filepath = files > 1 ? GetNumberedFile(frame.CaptureFile, files) : frame.CaptureFile;
+	if (!m_VideoWriter.Open(filepath, frame.Width, frame.Height, !frame.CaptureEveryFrame))
+	{
+		m_FailedCaptureFile = frame.CaptureFile;
+		m_CaptureFile.clear();
+		return;
+	}
+	m_CaptureFiles.store(files, std::memory_order_relaxed);
+	if (files > 1)
+		std::cout << "Capture: frames are " << frame.Width << "x" << frame.Height << " now, recording on in " << filepath << '\n';
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AsyncReadback.h"
+#include "CommandList.h"
+#include "FramePacer.h"
+#include "GpuProfiler.h"
+#include "RenderGraph.h"
+#include "RenderTargetPool.h"
+#include "SpscQueue.h"
+#include "VideoWriter.h"
+#include "imgui/imgui.h"
+
+struct GLFWwindow;
+class Renderer;
+class RenderTarget;
+class Shader;
+class VertexArray;
+
+//Everything needed to draw one frame, filled in by the game thread and read by the render thread
+struct FrameData
+{
+	std::vector<CommandList> CommandLists;
+	//a copy of ImGui's draw lists, ImGui reuses its own buffers as soon as the next ImGui::NewFrame() starts
+	ImDrawData DrawData;
+	ImVector<ImDrawList*> DrawLists;
+	//when the input that this frame reacts to was polled
+	std::chrono::steady_clock::time_point InputTime;
+	//size of the default framebuffer, and the MSAA sample count the scene is drawn with (1 draws straight into it)
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	unsigned int Samples = 1;
+	//depth tested scene, optionally with a depth pre-pass (see Renderer::SetDepthTest)
+	bool DepthTest = false;
+	bool DepthPrepass = false;
+	//post-process blur passes over the scene, each one blurs horizontally and then vertically, 0 for none
+	//from 2 on the targets ping-pong, later passes draw into the memory of earlier ones
+	unsigned int BlurPasses = 0;
+	//every frame is read back and written to this file while it is set, .y4m or raw RGBA (see VideoWriter)
+	std::string CaptureFile;
+	//wait for the file writer instead of dropping frames it can't keep up with, for offline rendering
+	bool CaptureEveryFrame = false;
+	//swap interval, frame rate limit and how far the CPU may run ahead of the GPU
+	FramePacer::Settings Pacing;
+	//set by BeginFrame: the frames before this one were skipped, the time since the last swap isn't a frame interval
+	bool AfterSkip = false;
+};
+
+//Runs GL submission (Renderer, ImGui rendering, swap) on its own thread, so the game thread can build frame N+1
+//while frame N is being submitted. Frames are handed over through a lock-free queue with 2 or 3 frames in flight.
+//
+//When it is not started, EndFrame() renders the frame right away on the calling thread, so the main loop looks the same in both modes.
+//Without a window (headless) it always renders that way and there is nothing to swap.
+//The GL context belongs to the render thread while it runs: Start() takes it from the calling thread and Stop() gives it back.
+class RenderThread
+{
+public:
+	static const unsigned int MaxFramesInFlight = 3;
+
+	RenderThread(GLFWwindow* window, Renderer& renderer, unsigned int framesInFlight = 2);
+	~RenderThread();
+
+	//call from the thread that has the context current
+	void Start();
+	//renders every queued frame, then makes the context current on the calling thread again
+	void Stop();
+	inline bool IsRunning() const { return m_Thread.joinable(); }
+
+	//game thread: the next frame to fill, waits if the render thread is a whole pipeline behind
+	//poll input after this returns and set InputTime, so waiting here doesn't count as latency
+	FrameData& BeginFrame();
+	//game thread: copies ImGui's draw data into the frame and hands it to the render side
+	void EndFrame();
+	//game thread: instead of EndFrame, gives the frame back without rendering or swapping it
+	void SkipFrame();
+
+	//averaged over the last frames, in ms
+	//latency is from polling input to the swap of the frame that used it returning
+	inline float GetLatency() const { return m_Latency.load(std::memory_order_relaxed); }
+	inline float GetRenderTime() const { return m_RenderTime.load(std::memory_order_relaxed); }
+
+	//times the passes of every frame this submits, safe to draw from the game thread
+	inline const GpuProfiler& GetGpuProfiler() const { return m_Profiler; }
+	inline GpuProfiler& GetGpuProfiler() { return m_Profiler; }
+	//jitter, latency to the GPU finishing the frame and the mode that is actually used, safe to read from the game thread
+	inline const FramePacer& GetFramePacer() const { return m_Pacer; }
+	//what the render target pool holds, as of the last frame
+	inline unsigned int GetPooledTargets() const { return m_PooledTargets.load(std::memory_order_relaxed); }
+	inline unsigned long long GetPooledBytes() const { return m_PooledBytes.load(std::memory_order_relaxed); }
+	//transient memory the render graph needs per frame, sharing targets between passes and if every target had its own
+	inline unsigned long long GetTransientBytes() const { return m_TransientBytes.load(std::memory_order_relaxed); }
+	inline unsigned long long GetTransientBytesWithoutAliasing() const { return m_TransientBytesWithoutAliasing.load(std::memory_order_relaxed); }
+	//prints the passes and transient targets of the next frame to stdout
+	inline void RequestGraphDump() { m_DumpGraph.store(true, std::memory_order_relaxed); }
+	//frames written to the capture file, and dropped because the writer couldn't keep up
+	//a resize continues the recording in a new file (capture_2.y4m, capture_3.y4m, ...), the counts are over all of them
+	inline unsigned int GetCapturedFrames() const { return m_CapturedFrames.load(std::memory_order_relaxed); }
+	inline unsigned int GetDroppedCaptureFrames() const { return m_DroppedCaptureFrames.load(std::memory_order_relaxed); }
+	inline unsigned int GetCaptureFiles() const { return m_CaptureFiles.load(std::memory_order_relaxed); }
+
+private:
+	GLFWwindow* m_Window;
+	Renderer& m_Renderer;
+	unsigned int m_FramesInFlight;
+	FrameData m_Frames[MaxFramesInFlight];
+	unsigned int m_Current;
+	//the last frame was skipped, BeginFrame returns it again
+	bool m_ReuseCurrent;
+	//GL thread only, apart from its getters
+	FramePacer m_Pacer;
+
+	//frame indices, game -> render and render -> game
+	SpscQueue<unsigned int, 4> m_Submitted;
+	SpscQueue<unsigned int, 4> m_Free;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Quit;
+	std::atomic<float> m_Latency;
+	std::atomic<float> m_RenderTime;
+	GpuProfiler m_Profiler;
+
+	//GL thread only, rebuilt every frame, its transient targets come from the pool
+	RenderGraph m_Graph;
+	RenderTargetPool m_TargetPool;
+	std::atomic<unsigned int> m_PooledTargets;
+	std::atomic<unsigned long long> m_PooledBytes;
+	std::atomic<unsigned long long> m_TransientBytes;
+	std::atomic<unsigned long long> m_TransientBytesWithoutAliasing;
+	std::atomic<bool> m_DumpGraph;
+	//GL thread only, created with the first blur pass
+	std::unique_ptr<Shader> m_BlurShader;
+	std::unique_ptr<VertexArray> m_FullscreenVA;
+
+	//GL thread only, frames come back a few frames late and go to the writer's thread from there
+	AsyncReadback m_Readback;
+	VideoWriter m_VideoWriter;
+	unsigned long long m_FrameNumber;
+	std::string m_FailedCaptureFile;
+	//the file the recording was started with, and the frames of its earlier files
+	std::string m_CaptureFile;
+	unsigned int m_CapturedBefore;
+	unsigned int m_DroppedBefore;
+	std::atomic<unsigned int> m_CapturedFrames;
+	std::atomic<unsigned int> m_DroppedCaptureFrames;
+	std::atomic<unsigned int> m_CaptureFiles;
+
+	void Loop();
+	void Render(FrameData& frame);
+	void BuildGraph(FrameData& frame);
+	//draws source blurred along one axis into whatever is bound, over the whole viewport
+	void DrawBlur(const RenderTarget& source, bool horizontal);
+	void UpdateCapture(const FrameData& frame);
+	void CopyDrawData(const ImDrawData* source, FrameData& frame);
+};
@@ -1,4 +1,5 @@
 #include "Renderer.h"
+#include <algorithm>
 #include <iostream>
 
 void GLClearError()
@@ -8,7 +9,7 @@ void GLClearError()
 
 bool GLLogCall(const char* function, const char* file, int line) {
 	while (GLenum error = glGetError()) {
-		std::cout << "[OpenGL Error] (" << error << "): " << function << " " << file << ":" << line << std::endl;
+		std::cout << "[OpenGL Error] (" << error << "): " << function << " " << file << ":" << line << '\n';
 		return false;
 	}
 	return true;
@@ -26,11 +27,141 @@ void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader&
 	// specifies multiple geometric primitives with very few subroutine calls.
 	// http://docs.gl/gl4/glDrawElements
 	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+	RenderStats::Add(RenderStats::DrawCalls);
+	RenderStats::Add(RenderStats::Triangles, ib.GetCount() / 3);
+}
+
+void Renderer::Submit(const std::vector<CommandList>& lists)
+{
+	//merge every list into one order, ties keep the recording order (list, then draw) so the result does not depend on thread timing
+	m_SubmitOrder.clear();
+	for (unsigned int list = 0; list < lists.size(); list++)
+	{
+		const auto& draws = lists[list].GetDraws();
+		for (unsigned int draw = 0; draw < draws.size(); draw++)
+			m_SubmitOrder.push_back({ draws[draw].SortKey, list, draw });
+	}
+	std::sort(m_SubmitOrder.begin(), m_SubmitOrder.end(), [](const SubmitEntry& a, const SubmitEntry& b) {
+		if (a.SortKey != b.SortKey) return a.SortKey < b.SortKey;
+		if (a.List != b.List) return a.List < b.List;
+		return a.Draw < b.Draw;
+	});
+
+	if (!m_DepthTest)
+	{
+		Replay(lists, 0, m_SubmitOrder.size(), false, false);
+		return;
+	}
+
+	//GL_LEQUAL in both modes: of the draws at the same depth the last one in key order wins, like without depth testing,
+	//and the color pass after a pre-pass shades the surfaces that wrote the depth
+	//http://docs.gl/gl4/glDepthFunc
+	GLCall(glEnable(GL_DEPTH_TEST));
+	GLCall(glDepthFunc(GL_LEQUAL));
+	if (!m_DepthPrepass)
+		Replay(lists, 0, m_SubmitOrder.size(), false, true);
+	else
+	{
+		//one layer at a time, so a layer's transparent draws are only hidden by the layers up to it,
+		//the same image as without the pre-pass
+		for (size_t begin = 0; begin < m_SubmitOrder.size();)
+		{
+			size_t end = begin + 1;
+			while (end < m_SubmitOrder.size() && CommandList::GetLayer(m_SubmitOrder[end].SortKey) == CommandList::GetLayer(m_SubmitOrder[begin].SortKey))
+				end++;
+			GLCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+			Replay(lists, begin, end, true, true);
+			//the depth buffer holds the nearest opaque surfaces now, the color pass shades exactly those
+			GLCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+			Replay(lists, begin, end, false, true);
+			begin = end;
+		}
+	}
+
+	GLCall(glDepthMask(GL_TRUE));
+	GLCall(glDepthFunc(GL_LESS));
+	GLCall(glDisable(GL_DEPTH_TEST));
+}
+
+void Renderer::Replay(const std::vector<CommandList>& lists, size_t begin, size_t end, bool depthOnly, bool depthTest)
+{
+	const Shader* boundShader = nullptr;
+	const VertexArray* boundVA = nullptr;
+	const IndexBuffer* boundIB = nullptr;
+	//after a pre-pass the opaque draws don't need to write depth again, it is already there
+	bool depthWrite = depthOnly || !m_DepthPrepass;
+	if (depthTest)
+		GLCall(glDepthMask(depthWrite ? GL_TRUE : GL_FALSE));
+
+	for (size_t i = begin; i < end; i++)
+	{
+		const SubmitEntry& entry = m_SubmitOrder[i];
+		const CommandList& list = lists[entry.List];
+		const CommandList::DrawCommand& draw = list.GetDraws()[entry.Draw];
+
+		//the keys put every transparent draw of a layer after its opaque ones
+		if (depthTest && CommandList::IsTransparent(draw.SortKey))
+		{
+			if (depthOnly)
+				continue;
+			if (depthWrite)
+			{
+				GLCall(glDepthMask(GL_FALSE));
+				depthWrite = false;
+			}
+		}
+		else if (depthTest && !depthWrite && !m_DepthPrepass)
+		{
+			//the next layer's opaque draws
+			GLCall(glDepthMask(GL_TRUE));
+			depthWrite = true;
+		}
+
+		if (draw.Program != boundShader)
+		{
+			draw.Program->Bind();
+			boundShader = draw.Program;
+		}
+		if (draw.VA != boundVA)
+		{
+			draw.VA->Bind();
+			boundVA = draw.VA;
+			//the element buffer binding is part of the vertex array state
+			boundIB = nullptr;
+		}
+		if (draw.IB != boundIB)
+		{
+			draw.IB->Bind();
+			boundIB = draw.IB;
+		}
+
+		//upload the uniforms recorded for this draw
+		const float* data = list.GetUniformData().data();
+		for (unsigned int i = draw.FirstUniform; i < draw.FirstUniform + draw.UniformCount; i++)
+		{
+			const CommandList::UniformCommand& uniform = list.GetUniforms()[i];
+			const float* value = data + uniform.Offset;
+			switch (uniform.Type)
+			{
+			case CommandList::UniformType::Int: GLCall(glUniform1i(uniform.Location, *(const int*)value)); break;
+			case CommandList::UniformType::Float: GLCall(glUniform1f(uniform.Location, *value)); break;
+			case CommandList::UniformType::Vec4: GLCall(glUniform4f(uniform.Location, value[0], value[1], value[2], value[3])); break;
+			case CommandList::UniformType::Mat4: GLCall(glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, value)); break;
+			}
+		}
+		RenderStats::Add(RenderStats::UniformUploads, draw.UniformCount);
+
+		GLCall(glDrawElements(GL_TRIANGLES, draw.IB->GetCount(), GL_UNSIGNED_INT, nullptr));
+		RenderStats::Add(RenderStats::DrawCalls);
+		RenderStats::Add(RenderStats::Triangles, draw.IB->GetCount() / 3);
+	}
 }
 
 void Renderer::Clear() const
 {
 	/* Render here */
 	//http://docs.gl/gl4/glClear
-	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+	//depth is only cleared where writing it is allowed
+	GLCall(glDepthMask(GL_TRUE));
+	GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 }
@@ -5,9 +5,26 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "CommandList.h"
+#include "GLDebug.h"
+#include "RenderStats.h"
+
+//Stops in the debugger, __debugbreak only exists on MSVC
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(__GNUC__) && !defined(_WIN32)
+#include <csignal>
+#define DEBUG_BREAK() raise(SIGTRAP)
+#elif defined(__GNUC__)
+#define DEBUG_BREAK() __builtin_trap()
+#else
+#include <cstdlib>
+#define DEBUG_BREAK() abort()
+#endif
 
 //A macro for assertion, to add a breakpoint when error is thrown
-#define ASSERT(x) if (!(x))  __debugbreak();
+//wrapped in do/while so it is one statement, also after an if without braces
+#define ASSERT(x) do { if (!(x)) DEBUG_BREAK(); } while (0)
 
 //__INTELLISENSE__ forces intelliSense to not to consider the lines within,
 //This is necessary because the intelliSense messes up when used with the glCall preprocessor macro
@@ -19,15 +36,18 @@
 
 #ifdef DEBUG
 
-//A macro that adds a before and after functions for function x, I.e in our case, call Clear error before x and then calls GllogCall after x
-//in GLLogCall(#x, __FILE__, __LINE__):
+//A macro that adds a before and after functions for function x, I.e in our case, GLDebug::BeginCall before x and then GLDebug::EndCall after x
+//in GLDebug::BeginCall(#x, __FILE__, __LINE__):
 //"#x" is name/string of the function x, __File__ gives the file name current function is running and __line_ gives current line of execution
 //"\" specifies the compiler to ignore the new line character
 //
 //This GLCall() macro will be added to every single opengl call we are doing in this function so that every time there is an error,in the call, we can get a stack trace and a breakpoint, Helps in debugging
-#define GLCall(x) GLClearError();\
+//With the debug output callback (see GLDebug.h) it only records the call site, otherwise it clears and polls glGetError around x
+#define GLCall(x) do {\
+		GLDebug::BeginCall(#x, __FILE__, __LINE__);\
 		x;\
-		ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+		ASSERT(GLDebug::EndCall());\
+	} while (0)
 
 #else
 #define GLCall(x) x
@@ -39,11 +59,43 @@
 
 #endif // !_INTELLISENSE_
 
+//the glGetError fallback of GLCall, when there is no debug output
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
 
 class Renderer {
 public:
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	//color and depth
 	void Clear() const;
+
+	//Merges command lists recorded on any thread and replays them in sort key order
+	//Must be called on the thread that owns the GL context, binds are skipped when consecutive draws share them
+	void Submit(const std::vector<CommandList>& lists);
+
+	//Depth testing in Submit, off by default (draws just land in key order). Needs a framebuffer with depth.
+	//Opaque draws test and write depth, front to back within their shader and mesh (see CommandList::MakeSortKey),
+	//transparent ones are tested against them but write nothing, back to front. Depth testing is off again after Submit.
+	inline void SetDepthTest(bool enabled) { m_DepthTest = enabled; }
+	//with depth testing: every opaque draw of a layer goes once without color first, so the color pass only shades the nearest
+	//surface of every pixel, whatever order the draws come in. Layer by layer, so the image is the same as without it.
+	//Costs the vertex work twice.
+	inline void SetDepthPrepass(bool enabled) { m_DepthPrepass = enabled; }
+	inline bool IsDepthTestEnabled() const { return m_DepthTest; }
+	inline bool IsDepthPrepassEnabled() const { return m_DepthPrepass; }
+
+private:
+	struct SubmitEntry
+	{
+		uint64_t SortKey;
+		unsigned int List;
+		unsigned int Draw;
+	};
+	//reused every frame so merging does not allocate
+	std::vector<SubmitEntry> m_SubmitOrder;
+	bool m_DepthTest = false;
+	bool m_DepthPrepass = false;
+
+	//draws m_SubmitOrder[begin, end), only the opaque draws when depthOnly, with depth writes off for the transparent ones when depthTest
+	void Replay(const std::vector<CommandList>& lists, size_t begin, size_t end, bool depthOnly, bool depthTest);
 };
@@ -0,0 +1,225 @@
+#include "SdfFont.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "Renderer.h"
+
+#include "imgui/imgui.h"
+
+//ImGui compiles stb_truetype static into imgui_draw.cpp, so this file has its own private copy of the implementation
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imgui/imstb_truetype.h"
+
+SdfFont::SdfFont(unsigned int atlasSize, unsigned int glyphSize)
+	: m_AtlasSize((std::max(64u, atlasSize) + 3) & ~3u), m_GlyphSize(std::max(8u, glyphSize)), m_Padding(std::max(2, (int)m_GlyphSize / 8)),
+	m_Scale(0.0f), m_LineHeight(1.0f), m_HasKerning(false), m_ShelfY(0), m_ShelfHeight(0), m_ShelfX(0), m_Full(false),
+	m_DirtyBegin(0), m_DirtyEnd(0), m_RendererID(0)
+{
+	std::fill(m_Direct, m_Direct + DirectGlyphs, -1);
+	m_Atlas.assign((size_t)m_AtlasSize * m_AtlasSize, 0);
+}
+
+SdfFont::~SdfFont()
+{
+	if (m_RendererID)
+		GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+bool SdfFont::Load(const std::string& path)
+{
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "SdfFont: can't open " << path << '\n';
+		return false;
+	}
+	m_FontData.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	if (!Init())
+	{
+		std::cout << "SdfFont: " << path << " is not a font stb_truetype can read\n";
+		return false;
+	}
+	return true;
+}
+
+bool SdfFont::LoadDefault()
+{
+	//ImGui keeps the decompressed TTF of its built in font in the atlas config, no context is needed for that
+	ImFontAtlas atlas;
+	atlas.AddFontDefault();
+	const ImFontConfig& config = atlas.ConfigData.back();
+	const unsigned char* data = (const unsigned char*)config.FontData;
+	m_FontData.assign(data, data + config.FontDataSize);
+	return Init();
+}
+
+bool SdfFont::Init()
+{
+	//loading again starts from an empty atlas
+	m_Font.reset();
+	m_Glyphs.clear();
+	m_Lookup.clear();
+	std::fill(m_Direct, m_Direct + DirectGlyphs, -1);
+	m_DirectKerning.assign(DirectGlyphs * DirectGlyphs, NAN);
+	std::fill(m_Atlas.begin(), m_Atlas.end(), 0);
+	m_ShelfY = m_ShelfHeight = m_ShelfX = 0;
+	m_Full = false;
+	m_DirtyBegin = 0;
+	m_DirtyEnd = m_AtlasSize;
+
+	auto font = std::make_unique<stbtt_fontinfo>();
+	int offset = m_FontData.empty() ? -1 : stbtt_GetFontOffsetForIndex(m_FontData.data(), 0);
+	if (offset < 0 || !stbtt_InitFont(font.get(), m_FontData.data(), offset))
+		return false;
+	m_Font = std::move(font);
+
+	m_Scale = stbtt_ScaleForPixelHeight(m_Font.get(), (float)m_GlyphSize);
+	int ascent, descent, lineGap;
+	stbtt_GetFontVMetrics(m_Font.get(), &ascent, &descent, &lineGap);
+	m_LineHeight = (ascent - descent + lineGap) * m_Scale / m_GlyphSize;
+	m_HasKerning = m_Font->kern != 0 || m_Font->gpos != 0;
+	return true;
+}
+
+const SdfFont::Glyph& SdfFont::GetGlyph(unsigned int codepoint)
+{
+	if (codepoint < DirectGlyphs)
+	{
+		if (m_Direct[codepoint] < 0)
+			m_Direct[codepoint] = AddGlyph(codepoint);
+		return m_Glyphs[m_Direct[codepoint]];
+	}
+
+	auto found = m_Lookup.find(codepoint);
+	if (found != m_Lookup.end())
+		return m_Glyphs[found->second];
+	int glyph = AddGlyph(codepoint);
+	m_Lookup[codepoint] = glyph;
+	return m_Glyphs[glyph];
+}
+
+float SdfFont::GetKerning(unsigned int left, unsigned int right)
+{
+	if (!m_HasKerning)
+		return 0.0f;
+
+	float* cached = left < DirectGlyphs && right < DirectGlyphs ? &m_DirectKerning[left * DirectGlyphs + right] : nullptr;
+	if (cached && !std::isnan(*cached))
+		return *cached;
+
+	int leftIndex = GetGlyph(left).Index;
+	int rightIndex = GetGlyph(right).Index;
+	float kerning = stbtt_GetGlyphKernAdvance(m_Font.get(), leftIndex, rightIndex) * m_Scale / m_GlyphSize;
+	if (cached)
+		*cached = kerning;
+	return kerning;
+}
+
+int SdfFont::AddGlyph(unsigned int codepoint)
+{
+	Glyph glyph = { 0, 0.0f, glm::vec4(0.0f), glm::vec4(0.0f) };
+	if (m_Font)
+	{
+		//codepoints the font doesn't have get glyph 0, the "missing" box
+		glyph.Index = stbtt_FindGlyphIndex(m_Font.get(), (int)codepoint);
+		int advance, leftBearing;
+		stbtt_GetGlyphHMetrics(m_Font.get(), glyph.Index, &advance, &leftBearing);
+		glyph.Advance = advance * m_Scale / m_GlyphSize;
+
+		//128 on the outline, 0 and 255 at m_Padding pixels out and in
+		int width = 0, height = 0, xoff = 0, yoff = 0;
+		unsigned char* field = stbtt_GetGlyphSDF(m_Font.get(), m_Scale, glyph.Index, m_Padding, 128, 128.0f / m_Padding, &width, &height, &xoff, &yoff);
+		unsigned int x, y;
+		if (field && Pack(width, height, x, y))
+		{
+			for (int row = 0; row < height; row++)
+				memcpy(&m_Atlas[(size_t)(y + row) * m_AtlasSize + x], field + row * width, width);
+			if (m_DirtyEnd <= m_DirtyBegin)
+			{
+				m_DirtyBegin = y;
+				m_DirtyEnd = y + height;
+			}
+			else
+			{
+				m_DirtyBegin = std::min(m_DirtyBegin, y);
+				m_DirtyEnd = std::max(m_DirtyEnd, y + height);
+			}
+
+			//stb_truetype's y goes down, ours up
+			float size = (float)m_GlyphSize;
+			glyph.Bounds = glm::vec4(xoff / size, -(yoff + height) / size, (xoff + width) / size, -yoff / size);
+			glyph.UV = glm::vec4(x, y, x + width, y + height) / (float)m_AtlasSize;
+		}
+		if (field)
+			stbtt_FreeSDF(field, nullptr);
+	}
+
+	m_Glyphs.push_back(glyph);
+	return (int)m_Glyphs.size() - 1;
+}
+
+bool SdfFont::Pack(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y)
+{
+	if (m_Full)
+		return false;
+
+	//a pixel between glyphs so linear filtering doesn't pick up the neighbour
+	if (m_ShelfX + width > m_AtlasSize)
+	{
+		m_ShelfY += m_ShelfHeight + 1;
+		m_ShelfX = 0;
+		m_ShelfHeight = 0;
+	}
+	if (width > m_AtlasSize || m_ShelfY + height > m_AtlasSize)
+	{
+		std::cout << "SdfFont: the " << m_AtlasSize << "x" << m_AtlasSize << " atlas is full after " << m_Glyphs.size() << " glyphs, the rest are left out\n";
+		m_Full = true;
+		return false;
+	}
+
+	x = m_ShelfX;
+	y = m_ShelfY;
+	m_ShelfX += width + 1;
+	m_ShelfHeight = std::max(m_ShelfHeight, height);
+	return true;
+}
+
+void SdfFont::Upload()
+{
+	if (!m_RendererID)
+	{
+		GLCall(glGenTextures(1, &m_RendererID));
+		GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+		//linear filtering of a distance field is what keeps the outline smooth when it is scaled up
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+		//rows are a multiple of 4 bytes, the default unpack alignment is fine
+		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_AtlasSize, m_AtlasSize, 0, GL_RED, GL_UNSIGNED_BYTE, m_Atlas.data()));
+		RenderStats::Add(RenderStats::TextureBytesUploaded, m_Atlas.size());
+		m_DirtyBegin = m_DirtyEnd = 0;
+		return;
+	}
+	if (m_DirtyEnd <= m_DirtyBegin)
+		return;
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_DirtyBegin, m_AtlasSize, m_DirtyEnd - m_DirtyBegin, GL_RED, GL_UNSIGNED_BYTE,
+		&m_Atlas[(size_t)m_DirtyBegin * m_AtlasSize]));
+	RenderStats::Add(RenderStats::TextureBytesUploaded, (uint64_t)(m_DirtyEnd - m_DirtyBegin) * m_AtlasSize);
+	m_DirtyBegin = m_DirtyEnd = 0;
+}
+
+void SdfFont::Bind(unsigned int slot) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Add(RenderStats::TextureBinds);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct stbtt_fontinfo;
+
+//A TrueType font as a signed distance field glyph atlas, for text that is drawn at any size (see TextRenderer)
+//
+//Every glyph is rasterized once by stb_truetype (the copy vendored with ImGui) as a distance field, at glyphSize pixels
+//from ascent to descent (what ImGui calls the font size), 0.5 on the outline. Scaled up or down, the shader keeps the edge
+//one screen pixel wide, so one atlas stays crisp at every size.
+//Glyphs are added the first time they are asked for, packed in shelves into a single channel atlas; the rows that changed
+//are uploaded by Upload(), so new glyphs cost nothing until then. A full atlas logs once, further glyphs are drawn as empty.
+//
+//Sizes and positions of glyphs are in font size units (1 is the font size), y up, relative to the pen on the baseline.
+class SdfFont
+{
+public:
+	struct Glyph
+	{
+		int Index;
+		float Advance;
+		//x0, y0, x1, y1 of the quad, 0 wide for glyphs without an outline (space)
+		glm::vec4 Bounds;
+		//u0, v0, u1, v1 in the atlas, v0 goes with y1 (the top)
+		glm::vec4 UV;
+	};
+
+	//atlasSize pixels square (rounded up to a multiple of 4), glyphSize is the font size the distance fields are made at
+	SdfFont(unsigned int atlasSize = 1024, unsigned int glyphSize = 48);
+	~SdfFont();
+
+	SdfFont(const SdfFont&) = delete;
+	SdfFont& operator=(const SdfFont&) = delete;
+
+	//a .ttf or .otf file, returns false if it can't be read or isn't a font
+	bool Load(const std::string& path);
+	//ProggyClean, the font ImGui has built in
+	bool LoadDefault();
+	inline bool IsLoaded() const { return m_Font != nullptr; }
+
+	//adds the glyph to the atlas the first time, any thread but one at a time
+	//the reference is good until a glyph is added, copy it to keep it longer
+	const Glyph& GetGlyph(unsigned int codepoint);
+	//extra advance between two codepoints, pairs of ASCII characters are looked up once and kept
+	float GetKerning(unsigned int left, unsigned int right);
+	//baseline to baseline
+	inline float GetLineHeight() const { return m_LineHeight; }
+
+	//GL thread: creates the texture on first use and uploads the rows new glyphs went into
+	void Upload();
+	void Bind(unsigned int slot = 0) const;
+
+	inline unsigned int GetGlyphCount() const { return (unsigned int)m_Glyphs.size(); }
+	inline unsigned int GetAtlasSize() const { return m_AtlasSize; }
+
+private:
+	unsigned int m_AtlasSize;
+	unsigned int m_GlyphSize;
+	//pixels of distance field around the outline
+	int m_Padding;
+
+	std::vector<unsigned char> m_FontData;
+	std::unique_ptr<stbtt_fontinfo> m_Font;
+	float m_Scale;
+	float m_LineHeight;
+
+	//ASCII is looked up directly, the rest through the map
+	static const unsigned int DirectGlyphs = 128;
+	int m_Direct[DirectGlyphs];
+	std::unordered_map<unsigned int, int> m_Lookup;
+	std::vector<Glyph> m_Glyphs;
+	//kerning of ASCII pairs, NaN until asked for, stb_truetype searches the font's tables every time
+	std::vector<float> m_DirectKerning;
+	bool m_HasKerning;
+
+	//the atlas on the CPU, a copy of the texture
+	std::vector<unsigned char> m_Atlas;
+	//shelf packing: the current shelf's top, height and the x where the next glyph goes
+	unsigned int m_ShelfY, m_ShelfHeight, m_ShelfX;
+	bool m_Full;
+	//rows of the atlas that changed since the last Upload, empty when m_DirtyEnd <= m_DirtyBegin
+	unsigned int m_DirtyBegin, m_DirtyEnd;
+	unsigned int m_RendererID;
+
+	bool Init();
+	int AddGlyph(unsigned int codepoint);
+	bool Pack(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+};
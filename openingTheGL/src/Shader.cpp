@@ -3,12 +3,20 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 Shader::Shader(const std::string& filepath)
 	: m_FilePath(filepath), m_RendererID(0)
 {
 	ShaderProgramSource source = ParseShader(filepath);
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	m_RendererID = CreateShader(source, {});
+}
+
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& feedbackVaryings)
+	: m_FilePath(filepath), m_RendererID(0)
+{
+	ShaderProgramSource source = ParseShader(filepath);
+	m_RendererID = CreateShader(source, feedbackVaryings);
 }
 
 Shader::~Shader()
@@ -21,6 +29,7 @@ void Shader::Bind() const
 	//installs the program object specified by program as part of current rendering state.
 	//http://docs.gl/gl4/glUseProgram
 	GLCall(glUseProgram(m_RendererID));
+	RenderStats::Add(RenderStats::ProgramBinds);
 }
 
 void Shader::Unbind() const
@@ -34,11 +43,13 @@ void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2,
 	//which should be a value returned by glGetUniformLocation. glUniform operates on the program object that was made part of current state by calling glUseProgram.
 	//http://docs.gl/gl4/glUniform
 	/*GLCall(*/glUniform4f(GetUniformLocation(name), v0, v1, v2, v3)/*)*/;
+	RenderStats::Add(RenderStats::UniformUploads);
 }
 
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4 matrix)
 {
 	GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+	RenderStats::Add(RenderStats::UniformUploads);
 }
 
 
@@ -46,39 +57,93 @@ void Shader::SetUniformMat4f(const std::string& name, const glm::mat4 matrix)
 void Shader::SetUniform1i(const std::string& name, int value)
 {
 	/*GLCall(*/glUniform1i(GetUniformLocation(name), value)/*)*/;
+	RenderStats::Add(RenderStats::UniformUploads);
 }
 
 void Shader::SetUniform1f(const std::string& name, float value) {
 	/*GLCall(*/glUniform1f(GetUniformLocation(name), value)/*)*/;
+	RenderStats::Add(RenderStats::UniformUploads);
+}
+
+void Shader::SetUniform2f(const std::string& name, float v0, float v1)
+{
+	GLCall(glUniform2f(GetUniformLocation(name), v0, v1));
+	RenderStats::Add(RenderStats::UniformUploads);
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateShader(const ShaderProgramSource& source, const std::vector<std::string>& feedbackVaryings)
 {
 	//glCreateProgram creates an empty program object and returns a non-zero value by which it can be referenced.
 	//A program object is an object to which shader objects can be attached.
 	//http://docs.gl/gl4/glCreateProgram
 	unsigned int program = glCreateProgram();
 
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	//a compute program has nothing else, otherwise the vertex shader and the fragment shader if there is one
+	std::vector<unsigned int> shaders;
+	if (!source.ComputeSource.empty())
+		shaders.push_back(CompileShader(GL_COMPUTE_SHADER, source.ComputeSource));
+	else
+	{
+		shaders.push_back(CompileShader(GL_VERTEX_SHADER, source.VertexSource));
+		if (!source.FragmentSource.empty())
+			shaders.push_back(CompileShader(GL_FRAGMENT_SHADER, source.FragmentSource));
+	}
 
+	//a stage that failed to compile is 0, the program can't link without it
+	bool compiled = true;
 	//Attaches a shader object to a program object
-	GLCall(glAttachShader(program, vs));
-	GLCall(glAttachShader(program, fs));
+	for (unsigned int shader : shaders)
+	{
+		if (shader)
+			GLCall(glAttachShader(program, shader));
+		else
+			compiled = false;
+	}
+
+	//which outputs transform feedback captures has to be known before linking
+	//http://docs.gl/gl4/glTransformFeedbackVaryings
+	if (!feedbackVaryings.empty())
+	{
+		std::vector<const char*> names;
+		for (const std::string& name : feedbackVaryings)
+			names.push_back(name.c_str());
+		GLCall(glTransformFeedbackVaryings(program, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS));
+	}
 
 	//glLinkProgram links the program object specified by program. If any shader objects of type GL_VERTEX_SHADER are attached to program,
 	//they will be used to create an executable that will run on the programmable vertex processor. If any shader objects of type GL_FRAGMENT_SHADER are attached to program,
 	//they will be used to create an executable that will run on the programmable fragment processor.
 	//http://docs.gl/gl4/glLinkProgram
-	GLCall(glLinkProgram(program));
+	int linked = GL_FALSE;
+	if (compiled)
+	{
+		GLCall(glLinkProgram(program));
+		GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	}
+	//a program that didn't compile or link is deleted, see IsValid
+	if (linked == GL_FALSE)
+	{
+		if (compiled)
+		{
+			int length;
+			GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+			std::vector<char> message(length > 0 ? length : 1, '\0');
+			GLCall(glGetProgramInfoLog(program, (GLsizei)message.size(), &length, message.data()));
+			std::cout << "Failed to link " << m_FilePath << '\n' << message.data() << '\n';
+		}
+		for (unsigned int shader : shaders)
+			GLCall(glDeleteShader(shader));
+		GLCall(glDeleteProgram(program));
+		return 0;
+	}
 
 	//checks to see whether the executables contained in program can execute given the current OpenGL state.
 	//http://docs.gl/gl4/glValidateProgram
 	GLCall(glValidateProgram(program));
 
 	//once shaders are compiled and are part of the program, u can use the older shader objects created
-	GLCall(glDeleteShader(vs));
-	GLCall(glDeleteShader(fs));
+	for (unsigned int shader : shaders)
+		GLCall(glDeleteShader(shader));
 
 	return program;
 }
@@ -89,11 +154,11 @@ ShaderProgramSource Shader::ParseShader(const std::string& filePath) {
 
 	enum class ShaderType
 	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
+		NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
 	};
 	ShaderType type = ShaderType::NONE;
 	std::string line;
-	std::stringstream ss[2];
+	std::stringstream ss[3];
 
 	while (getline(stream, line)) {
 		if (line.find("#shader") != std::string::npos) {
@@ -101,6 +166,8 @@ ShaderProgramSource Shader::ParseShader(const std::string& filePath) {
 				type = ShaderType::VERTEX;
 			else if (line.find("fragment") != std::string::npos)
 				type = ShaderType::FRAGMENT;
+			else if (line.find("compute") != std::string::npos)
+				type = ShaderType::COMPUTE;
 		}
 		else if (type != ShaderType::NONE)
 		{
@@ -108,7 +175,7 @@ ShaderProgramSource Shader::ParseShader(const std::string& filePath) {
 		}
 	}
 
-	return { ss[0].str(), ss[1].str() };
+	return { ss[0].str(), ss[1].str(), ss[2].str() };
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
@@ -137,13 +204,13 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	{
 		int length;
 		GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-		//c++ doesn't allow message[length] since length is not a const, hence using _alloc
-		char* message = (char*)_malloca(length * sizeof(char));
+		//c++ doesn't allow message[length] since length is not a const, _malloca would be MSVC only
+		std::vector<char> message(length > 0 ? length : 1, '\0');
 
-		GLCall(glGetShaderInfoLog(id, length, &length, message));
+		GLCall(glGetShaderInfoLog(id, (GLsizei)message.size(), &length, message.data()));
 
-		std::cout << "Failed to compile  " << (type == GL_VERTEX_SHADER ? "Vertex" : "fragment") << "Shader!" << std::endl;
-		std::cout << message << std::endl;
+		std::cout << "Failed to compile  " << (type == GL_VERTEX_SHADER ? "Vertex" : type == GL_COMPUTE_SHADER ? "compute" : "fragment") << "Shader!" << '\n';
+		std::cout << message.data() << '\n';
 
 		GLCall(glDeleteShader(id));
 		return 0;
@@ -159,11 +226,12 @@ int Shader::GetUniformLocation(const std::string& name)
 
 	//returns an integer that represents the location of a specific uniform variable within a program object.
 	//http://docs.gl/gl4/glGetUniformLocation
-	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+	int location;
+	GLCall(location = glGetUniformLocation(m_RendererID, name.c_str()));
 
 	if (location == -1)
-		std::cout << "warning: uniform " << name << " not found" << std::endl;
+		std::cout << "warning: uniform " << name << " not found" << '\n';
 	else
 		m_UniformLocationCache[name] = location;
-	return 0;
+	return location;
 }
\ No newline at end of file
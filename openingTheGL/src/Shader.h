@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include<unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -8,12 +9,17 @@ struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	//a "#shader compute" section, a program is either compute or vertex (+ fragment)
+	std::string ComputeSource;
 };
 
 class Shader
 {
 public:
 	Shader(const std::string& filepath);
+	//the vertex shader outputs named in feedbackVaryings are written interleaved to the transform feedback buffer (GL 3.0)
+	//the file may have no fragment section, the program is then only used with GL_RASTERIZER_DISCARD
+	Shader(const std::string& filepath, const std::vector<std::string>& feedbackVaryings);
 	~Shader();
 
 	void Bind() const;
@@ -22,16 +28,26 @@ public:
 	//set uniforms:
 	void SetUniform1i(const std::string& name, int value);
 	void SetUniform1f(const std::string& name, float value);
+	void SetUniform2f(const std::string& name, float v0, float v1);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
 	void SetUniformMat4f(const std::string& name, const glm::mat4 matrix);
+
+	//location of a uniform, cached after the first lookup
+	//record it once on the GL thread to set the uniform from a CommandList
+	int GetUniformLocation(const std::string& name);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	//false when a stage didn't compile or the program didn't link, the errors are printed
+	inline bool IsValid() const { return m_RendererID != 0; }
+
+	//splits a .shader file into its vertex, fragment and compute source at the "#shader vertex/fragment/compute" lines
+	static ShaderProgramSource ParseShader(const std::string& filePath);
 private:
 
 	unsigned int m_RendererID;
 	std::string m_FilePath;
 	std::unordered_map<std::string, int> m_UniformLocationCache;
 
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	ShaderProgramSource ParseShader(const std::string& filePath);
+	unsigned int CreateShader(const ShaderProgramSource& source, const std::vector<std::string>& feedbackVaryings);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
-	int GetUniformLocation(const std::string& name);
 };
@@ -0,0 +1,25 @@
+#pragma once
+
+//Picks the widest x86 instruction set the compiler is allowed to use for our own SIMD code
+//glm's own GLM_ARCH only enables these when GLM_FORCE_INTRINSICS is set, which changes every glm type, so we detect them here instead
+//MSVC: x64 always has SSE2, /arch:AVX or /arch:AVX2 defines __AVX__ / __AVX2__
+#if defined(__AVX2__)
+	#define SIMD_AVX2 1
+#endif
+
+#if defined(__AVX__)
+	#define SIMD_AVX 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SIMD_SSE 1
+#endif
+
+#if defined(SIMD_AVX)
+	#include <immintrin.h>
+#elif defined(SIMD_SSE)
+	#include <emmintrin.h>
+#endif
+
+//alignas for data that is loaded with aligned SIMD loads
+#define SIMD_ALIGN alignas(32)
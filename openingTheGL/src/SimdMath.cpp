@@ -0,0 +1,492 @@
+#include "SimdMath.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMDMATH_X86 1
+#endif
+
+#ifdef SIMDMATH_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+//MSVC compiles any intrinsic whatever /arch says, it is up to us to only call it on a CPU that has it
+#define SIMDMATH_TARGET(isa)
+#else
+#include <cpuid.h>
+//GCC and Clang only accept an intrinsic in a function compiled for its instruction set, the rest of the file stays at the baseline
+#define SIMDMATH_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace SimdMath {
+
+#ifdef SIMDMATH_X86
+
+	static void Cpuid(int info[4], int leaf, int subleaf)
+	{
+#if defined(_MSC_VER)
+		__cpuidex(info, leaf, subleaf);
+#else
+		__cpuid_count(leaf, subleaf, info[0], info[1], info[2], info[3]);
+#endif
+	}
+
+	//which register states the OS saves on a context switch, AVX registers are useless without that
+	static unsigned long long GetEnabledRegisterStates()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int low, high;
+		__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		return ((unsigned long long)high << 32) | low;
+#endif
+	}
+
+	static Level DetectLevel()
+	{
+		int info[4];
+		Cpuid(info, 0, 0);
+		int maxLeaf = info[0];
+
+		Cpuid(info, 1, 0);
+		bool sse41 = (info[2] & (1 << 19)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool fma = (info[2] & (1 << 12)) != 0;
+		if (!sse41)
+			return Level::Scalar;
+		if (!osxsave || maxLeaf < 7)
+			return Level::SSE41;
+
+		unsigned long long states = GetEnabledRegisterStates();
+		//XMM and YMM, then opmask and the upper ZMM halves
+		bool ymm = (states & 0x6) == 0x6;
+		bool zmm = (states & 0xE6) == 0xE6;
+
+		Cpuid(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		bool avx512f = (info[1] & (1 << 16)) != 0;
+
+		if (avx512f && avx2 && fma && zmm)
+			return Level::AVX512;
+		if (avx2 && fma && ymm)
+			return Level::AVX2;
+		return Level::SSE41;
+	}
+
+#else
+
+	static Level DetectLevel()
+	{
+		return Level::Scalar;
+	}
+
+#endif
+
+	//-1 until the first kernel or GetLevel() runs
+	static std::atomic<int> s_Level(-1);
+
+	Level GetSupportedLevel()
+	{
+		static const Level supported = DetectLevel();
+		return supported;
+	}
+
+	Level GetLevel()
+	{
+		int level = s_Level.load(std::memory_order_relaxed);
+		if (level < 0)
+		{
+			level = (int)GetSupportedLevel();
+			s_Level.store(level, std::memory_order_relaxed);
+		}
+		return (Level)level;
+	}
+
+	void SetLevel(Level level)
+	{
+		if ((int)level > (int)GetSupportedLevel())
+			level = GetSupportedLevel();
+		s_Level.store((int)level, std::memory_order_relaxed);
+	}
+
+	const char* GetLevelName(Level level)
+	{
+		switch (level)
+		{
+		case Level::Scalar: return "Scalar";
+		case Level::SSE41: return "SSE4.1";
+		case Level::AVX2: return "AVX2";
+		case Level::AVX512: return "AVX-512";
+		}
+		return "?";
+	}
+
+	void Pack(const glm::vec4* points, size_t count, Vec4x8* blocks)
+	{
+		for (size_t block = 0; block < GetBlockCount(count); block++)
+			for (size_t lane = 0; lane < 8; lane++)
+			{
+				size_t i = block * 8 + lane;
+				glm::vec4 point = i < count ? points[i] : glm::vec4(0.0f);
+				blocks[block].X[lane] = point.x;
+				blocks[block].Y[lane] = point.y;
+				blocks[block].Z[lane] = point.z;
+				blocks[block].W[lane] = point.w;
+			}
+	}
+
+	void Unpack(const Vec4x8* blocks, size_t count, glm::vec4* points)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const Vec4x8& block = blocks[i / 8];
+			size_t lane = i % 8;
+			points[i] = glm::vec4(block.X[lane], block.Y[lane], block.Z[lane], block.W[lane]);
+		}
+	}
+
+	//Scalar: what glm would do, one point or matrix after the other
+
+	static void TransformPointsScalar(const glm::mat4& m, const Vec4x8* in, Vec4x8* out, size_t blocks)
+	{
+		for (size_t block = 0; block < blocks; block++)
+		{
+			Vec4x8 source = in[block];
+			for (unsigned int lane = 0; lane < 8; lane++)
+			{
+				glm::vec4 point = m * glm::vec4(source.X[lane], source.Y[lane], source.Z[lane], source.W[lane]);
+				out[block].X[lane] = point.x;
+				out[block].Y[lane] = point.y;
+				out[block].Z[lane] = point.z;
+				out[block].W[lane] = point.w;
+			}
+		}
+	}
+
+	static void MultiplyMatricesScalar(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			out[i] = a[i] * b[i];
+	}
+
+#ifdef SIMDMATH_X86
+
+	//SSE4.1: 4 points or one matrix column per register
+
+	//a column of a * b: the columns of a weighted by the 4 values of b's column
+	SIMDMATH_TARGET("sse4.1")
+	static inline __m128 MultiplyColumnSse(__m128 a0, __m128 a1, __m128 a2, __m128 a3, const float* column)
+	{
+		__m128 b = _mm_loadu_ps(column);
+		__m128 result = _mm_mul_ps(a0, _mm_shuffle_ps(b, b, 0x00));
+		result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_shuffle_ps(b, b, 0x55)));
+		result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_shuffle_ps(b, b, 0xAA)));
+		return _mm_add_ps(result, _mm_mul_ps(a3, _mm_shuffle_ps(b, b, 0xFF)));
+	}
+
+	//one row of a block of 8 results: row r is m[0][r] * x + m[1][r] * y + m[2][r] * z + m[3][r] * w
+	SIMDMATH_TARGET("sse4.1")
+	static inline void TransformRowSse(const float (*e)[4], unsigned int r, __m128 x0, __m128 x1, __m128 y0, __m128 y1,
+		__m128 z0, __m128 z1, __m128 w0, __m128 w1, float* row)
+	{
+		__m128 ex = _mm_load_ps(e[r]);
+		__m128 low = _mm_mul_ps(ex, x0);
+		__m128 high = _mm_mul_ps(ex, x1);
+		__m128 ey = _mm_load_ps(e[4 + r]);
+		low = _mm_add_ps(low, _mm_mul_ps(ey, y0));
+		high = _mm_add_ps(high, _mm_mul_ps(ey, y1));
+		__m128 ez = _mm_load_ps(e[8 + r]);
+		low = _mm_add_ps(low, _mm_mul_ps(ez, z0));
+		high = _mm_add_ps(high, _mm_mul_ps(ez, z1));
+		__m128 ew = _mm_load_ps(e[12 + r]);
+		low = _mm_add_ps(low, _mm_mul_ps(ew, w0));
+		high = _mm_add_ps(high, _mm_mul_ps(ew, w1));
+		_mm_storeu_ps(row, low);
+		_mm_storeu_ps(row + 4, high);
+	}
+
+	SIMDMATH_TARGET("sse4.1")
+	static void TransformPointsSse(const glm::mat4& m, const Vec4x8* in, Vec4x8* out, size_t blocks)
+	{
+		//the 16 broadcast elements and a block of inputs don't fit in 16 registers together, broadcasts held in registers
+		//get spilled in the middle of the loop. They are made once into memory instead, and every row loads only its 4.
+		alignas(16) float e[16][4];
+		for (unsigned int i = 0; i < 16; i++)
+			_mm_store_ps(e[i], _mm_set1_ps((&m[0][0])[i]));
+
+		for (size_t block = 0; block < blocks; block++)
+		{
+			//all of the block is read before anything is written, out may be in
+			__m128 x0 = _mm_loadu_ps(in[block].X), x1 = _mm_loadu_ps(in[block].X + 4);
+			__m128 y0 = _mm_loadu_ps(in[block].Y), y1 = _mm_loadu_ps(in[block].Y + 4);
+			__m128 z0 = _mm_loadu_ps(in[block].Z), z1 = _mm_loadu_ps(in[block].Z + 4);
+			__m128 w0 = _mm_loadu_ps(in[block].W), w1 = _mm_loadu_ps(in[block].W + 4);
+			TransformRowSse(e, 0, x0, x1, y0, y1, z0, z1, w0, w1, out[block].X);
+			TransformRowSse(e, 1, x0, x1, y0, y1, z0, z1, w0, w1, out[block].Y);
+			TransformRowSse(e, 2, x0, x1, y0, y1, z0, z1, w0, w1, out[block].Z);
+			TransformRowSse(e, 3, x0, x1, y0, y1, z0, z1, w0, w1, out[block].W);
+		}
+	}
+
+	SIMDMATH_TARGET("sse4.1")
+	static void MultiplyMatricesSse(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const float* left = &a[i][0][0];
+			const float* right = &b[i][0][0];
+			__m128 a0 = _mm_loadu_ps(left);
+			__m128 a1 = _mm_loadu_ps(left + 4);
+			__m128 a2 = _mm_loadu_ps(left + 8);
+			__m128 a3 = _mm_loadu_ps(left + 12);
+			//all of b is read before anything is written, out may be a or b
+			__m128 c0 = MultiplyColumnSse(a0, a1, a2, a3, right);
+			__m128 c1 = MultiplyColumnSse(a0, a1, a2, a3, right + 4);
+			__m128 c2 = MultiplyColumnSse(a0, a1, a2, a3, right + 8);
+			__m128 c3 = MultiplyColumnSse(a0, a1, a2, a3, right + 12);
+			float* result = &out[i][0][0];
+			_mm_storeu_ps(result, c0);
+			_mm_storeu_ps(result + 4, c1);
+			_mm_storeu_ps(result + 8, c2);
+			_mm_storeu_ps(result + 12, c3);
+		}
+	}
+
+	SIMDMATH_TARGET("sse4.1")
+	static void ComputeMvpsSse(const glm::mat4& viewProjection, const glm::mat4* models, glm::mat4* out, size_t count)
+	{
+		const float* left = &viewProjection[0][0];
+		__m128 a0 = _mm_loadu_ps(left);
+		__m128 a1 = _mm_loadu_ps(left + 4);
+		__m128 a2 = _mm_loadu_ps(left + 8);
+		__m128 a3 = _mm_loadu_ps(left + 12);
+		for (size_t i = 0; i < count; i++)
+		{
+			const float* right = &models[i][0][0];
+			__m128 c0 = MultiplyColumnSse(a0, a1, a2, a3, right);
+			__m128 c1 = MultiplyColumnSse(a0, a1, a2, a3, right + 4);
+			__m128 c2 = MultiplyColumnSse(a0, a1, a2, a3, right + 8);
+			__m128 c3 = MultiplyColumnSse(a0, a1, a2, a3, right + 12);
+			float* result = &out[i][0][0];
+			_mm_storeu_ps(result, c0);
+			_mm_storeu_ps(result + 4, c1);
+			_mm_storeu_ps(result + 8, c2);
+			_mm_storeu_ps(result + 12, c3);
+		}
+	}
+
+	//AVX2 + FMA: a whole block of 8 points, or two matrix columns, per register
+
+	//two columns of a * b at once: a's columns are in both halves, the halves pick their weights from b's columns j and j + 1
+	SIMDMATH_TARGET("avx2,fma")
+	static inline __m256 MultiplyColumnPairAvx(__m256 a0, __m256 a1, __m256 a2, __m256 a3, const float* columns)
+	{
+		__m256 b = _mm256_loadu_ps(columns);
+		__m256 result = _mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00));
+		result = _mm256_fmadd_ps(a1, _mm256_permute_ps(b, 0x55), result);
+		result = _mm256_fmadd_ps(a2, _mm256_permute_ps(b, 0xAA), result);
+		return _mm256_fmadd_ps(a3, _mm256_permute_ps(b, 0xFF), result);
+	}
+
+	SIMDMATH_TARGET("avx2,fma")
+	static void TransformPointsAvx2(const glm::mat4& m, const Vec4x8* in, Vec4x8* out, size_t blocks)
+	{
+		__m256 e[16];
+		for (unsigned int i = 0; i < 16; i++)
+			e[i] = _mm256_set1_ps((&m[0][0])[i]);
+
+		for (size_t block = 0; block < blocks; block++)
+		{
+			__m256 x = _mm256_loadu_ps(in[block].X);
+			__m256 y = _mm256_loadu_ps(in[block].Y);
+			__m256 z = _mm256_loadu_ps(in[block].Z);
+			__m256 w = _mm256_loadu_ps(in[block].W);
+			float* rows[4] = { out[block].X, out[block].Y, out[block].Z, out[block].W };
+			for (unsigned int r = 0; r < 4; r++)
+			{
+				__m256 result = _mm256_mul_ps(e[r], x);
+				result = _mm256_fmadd_ps(e[4 + r], y, result);
+				result = _mm256_fmadd_ps(e[8 + r], z, result);
+				result = _mm256_fmadd_ps(e[12 + r], w, result);
+				_mm256_storeu_ps(rows[r], result);
+			}
+		}
+	}
+
+	SIMDMATH_TARGET("avx2,fma")
+	static void MultiplyMatricesAvx2(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const float* left = &a[i][0][0];
+			const float* right = &b[i][0][0];
+			__m256 a0 = _mm256_broadcast_ps((const __m128*)left);
+			__m256 a1 = _mm256_broadcast_ps((const __m128*)(left + 4));
+			__m256 a2 = _mm256_broadcast_ps((const __m128*)(left + 8));
+			__m256 a3 = _mm256_broadcast_ps((const __m128*)(left + 12));
+			__m256 c01 = MultiplyColumnPairAvx(a0, a1, a2, a3, right);
+			__m256 c23 = MultiplyColumnPairAvx(a0, a1, a2, a3, right + 8);
+			float* result = &out[i][0][0];
+			_mm256_storeu_ps(result, c01);
+			_mm256_storeu_ps(result + 8, c23);
+		}
+	}
+
+	SIMDMATH_TARGET("avx2,fma")
+	static void ComputeMvpsAvx2(const glm::mat4& viewProjection, const glm::mat4* models, glm::mat4* out, size_t count)
+	{
+		const float* left = &viewProjection[0][0];
+		__m256 a0 = _mm256_broadcast_ps((const __m128*)left);
+		__m256 a1 = _mm256_broadcast_ps((const __m128*)(left + 4));
+		__m256 a2 = _mm256_broadcast_ps((const __m128*)(left + 8));
+		__m256 a3 = _mm256_broadcast_ps((const __m128*)(left + 12));
+		for (size_t i = 0; i < count; i++)
+		{
+			const float* right = &models[i][0][0];
+			__m256 c01 = MultiplyColumnPairAvx(a0, a1, a2, a3, right);
+			__m256 c23 = MultiplyColumnPairAvx(a0, a1, a2, a3, right + 8);
+			float* result = &out[i][0][0];
+			_mm256_storeu_ps(result, c01);
+			_mm256_storeu_ps(result + 8, c23);
+		}
+	}
+
+	//AVX-512: two blocks of points, or a whole matrix, per register
+	//the zero masked forms with every lane set compile to the plain instructions, GCC 12's unmasked ones pass an
+	//_mm512_undefined_* vector as their merge source and -Wall reports it as used uninitialized
+
+	//all 4 columns of a * b at once, a's columns are repeated in every 128 bit lane
+	SIMDMATH_TARGET("avx512f,avx2,fma")
+	static inline __m512 MultiplyMatrixAvx512(__m512 a0, __m512 a1, __m512 a2, __m512 a3, const float* right)
+	{
+		__m512 b = _mm512_loadu_ps(right);
+		__m512 result = _mm512_mul_ps(a0, _mm512_maskz_permute_ps(0xFFFF, b, 0x00));
+		result = _mm512_fmadd_ps(a1, _mm512_maskz_permute_ps(0xFFFF, b, 0x55), result);
+		result = _mm512_fmadd_ps(a2, _mm512_maskz_permute_ps(0xFFFF, b, 0xAA), result);
+		return _mm512_fmadd_ps(a3, _mm512_maskz_permute_ps(0xFFFF, b, 0xFF), result);
+	}
+
+	//the same component of two consecutive blocks in one register, insertf32x8 would need AVX512DQ
+	SIMDMATH_TARGET("avx512f,avx2,fma")
+	static inline __m512 LoadPairAvx512(const float* first, const float* second)
+	{
+		//zero extended, not a cast that leaves the upper half undefined until the insert
+		__m512d low = _mm512_maskz_insertf64x4(0xFF, _mm512_setzero_pd(), _mm256_castps_pd(_mm256_loadu_ps(first)), 0);
+		return _mm512_castpd_ps(_mm512_maskz_insertf64x4(0xFF, low, _mm256_castps_pd(_mm256_loadu_ps(second)), 1));
+	}
+
+	SIMDMATH_TARGET("avx512f,avx2,fma")
+	static inline void StorePairAvx512(float* first, float* second, __m512 value)
+	{
+		_mm256_storeu_ps(first, _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0x0F, _mm512_castps_pd(value), 0)));
+		_mm256_storeu_ps(second, _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0x0F, _mm512_castps_pd(value), 1)));
+	}
+
+	SIMDMATH_TARGET("avx512f,avx2,fma")
+	static void TransformPointsAvx512(const glm::mat4& m, const Vec4x8* in, Vec4x8* out, size_t blocks)
+	{
+		__m512 e[16];
+		for (unsigned int i = 0; i < 16; i++)
+			e[i] = _mm512_set1_ps((&m[0][0])[i]);
+
+		size_t block = 0;
+		for (; block + 2 <= blocks; block += 2)
+		{
+			const Vec4x8& first = in[block];
+			const Vec4x8& second = in[block + 1];
+			__m512 x = LoadPairAvx512(first.X, second.X);
+			__m512 y = LoadPairAvx512(first.Y, second.Y);
+			__m512 z = LoadPairAvx512(first.Z, second.Z);
+			__m512 w = LoadPairAvx512(first.W, second.W);
+			float* rows[4][2] = {
+				{ out[block].X, out[block + 1].X }, { out[block].Y, out[block + 1].Y },
+				{ out[block].Z, out[block + 1].Z }, { out[block].W, out[block + 1].W }
+			};
+			for (unsigned int r = 0; r < 4; r++)
+			{
+				__m512 result = _mm512_mul_ps(e[r], x);
+				result = _mm512_fmadd_ps(e[4 + r], y, result);
+				result = _mm512_fmadd_ps(e[8 + r], z, result);
+				result = _mm512_fmadd_ps(e[12 + r], w, result);
+				StorePairAvx512(rows[r][0], rows[r][1], result);
+			}
+		}
+		//an odd block out
+		if (block < blocks)
+			TransformPointsAvx2(m, in + block, out + block, blocks - block);
+	}
+
+	SIMDMATH_TARGET("avx512f,avx2,fma")
+	static void MultiplyMatricesAvx512(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const float* left = &a[i][0][0];
+			__m512 a0 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left));
+			__m512 a1 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left + 4));
+			__m512 a2 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left + 8));
+			__m512 a3 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left + 12));
+			_mm512_storeu_ps(&out[i][0][0], MultiplyMatrixAvx512(a0, a1, a2, a3, &b[i][0][0]));
+		}
+	}
+
+	SIMDMATH_TARGET("avx512f,avx2,fma")
+	static void ComputeMvpsAvx512(const glm::mat4& viewProjection, const glm::mat4* models, glm::mat4* out, size_t count)
+	{
+		const float* left = &viewProjection[0][0];
+		__m512 a0 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left));
+		__m512 a1 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left + 4));
+		__m512 a2 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left + 8));
+		__m512 a3 = _mm512_maskz_broadcast_f32x4(0xFFFF, _mm_loadu_ps(left + 12));
+		for (size_t i = 0; i < count; i++)
+			_mm512_storeu_ps(&out[i][0][0], MultiplyMatrixAvx512(a0, a1, a2, a3, &models[i][0][0]));
+	}
+
+#endif
+
+	void TransformPoints(const glm::mat4& matrix, const Vec4x8* in, Vec4x8* out, size_t blocks)
+	{
+		switch (GetLevel())
+		{
+#ifdef SIMDMATH_X86
+		case Level::AVX512: TransformPointsAvx512(matrix, in, out, blocks); return;
+		case Level::AVX2: TransformPointsAvx2(matrix, in, out, blocks); return;
+		case Level::SSE41: TransformPointsSse(matrix, in, out, blocks); return;
+#endif
+		default: TransformPointsScalar(matrix, in, out, blocks); return;
+		}
+	}
+
+	void MultiplyMatrices(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count)
+	{
+		switch (GetLevel())
+		{
+#ifdef SIMDMATH_X86
+		case Level::AVX512: MultiplyMatricesAvx512(a, b, out, count); return;
+		case Level::AVX2: MultiplyMatricesAvx2(a, b, out, count); return;
+		case Level::SSE41: MultiplyMatricesSse(a, b, out, count); return;
+#endif
+		default: MultiplyMatricesScalar(a, b, out, count); return;
+		}
+	}
+
+	void ComputeMvps(const glm::mat4& viewProjection, const glm::mat4* models, glm::mat4* out, size_t count)
+	{
+		switch (GetLevel())
+		{
+#ifdef SIMDMATH_X86
+		case Level::AVX512: ComputeMvpsAvx512(viewProjection, models, out, count); return;
+		case Level::AVX2: ComputeMvpsAvx2(viewProjection, models, out, count); return;
+		case Level::SSE41: ComputeMvpsSse(viewProjection, models, out, count); return;
+#endif
+		default:
+			for (size_t i = 0; i < count; i++)
+				out[i] = viewProjection * models[i];
+			return;
+		}
+	}
+
+}
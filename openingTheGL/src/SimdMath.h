@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+
+#include "glm/glm.hpp"
+
+//Bulk versions of the glm operations that run once per object or per vertex, 4 to 16 at a time
+//
+//glm (without GLM_FORCE_INTRINSICS, see Simd.h) does one mat4 or vec4 at a time in scalar code. These kernels do the same math
+//for whole arrays with SSE4.1, AVX2 + FMA or AVX-512, picked at runtime from what the CPU supports, so one build runs everywhere
+//and still uses the widest registers there are. Anything that isn't x86, or a CPU without SSE4.1, gets plain C++ loops.
+//
+//Matrices stay glm::mat4 (column major, 16 floats), the kernels work on their columns.
+//Points are stored structure of arrays in blocks of 8 (Vec4x8), so a register holds the same component of 4, 8 or 16 points.
+//FMA rounds differently from a multiply and an add, results can differ from glm in the last bit.
+namespace SimdMath {
+
+	enum class Level
+	{
+		Scalar,
+		SSE41,
+		AVX2,
+		AVX512
+	};
+
+	//the best level this CPU and OS support, detected once
+	Level GetSupportedLevel();
+	//the level the kernels use, the supported one unless it was lowered with SetLevel
+	Level GetLevel();
+	//forces a level for comparisons and testing, anything above GetSupportedLevel() is clamped to it
+	void SetLevel(Level level);
+	const char* GetLevelName(Level level);
+
+	//Lanes points, one array per component
+	template<unsigned int Lanes>
+	struct alignas(Lanes * sizeof(float)) Vec4Wide
+	{
+		float X[Lanes];
+		float Y[Lanes];
+		float Z[Lanes];
+		float W[Lanes];
+	};
+	typedef Vec4Wide<4> Vec4x4;
+	typedef Vec4Wide<8> Vec4x8;
+
+	inline size_t GetBlockCount(size_t points) { return (points + 7) / 8; }
+	//from and to glm::vec4, the lanes of the last block past count are filled with zeros and not written back
+	void Pack(const glm::vec4* points, size_t count, Vec4x8* blocks);
+	void Unpack(const Vec4x8* blocks, size_t count, glm::vec4* points);
+
+	//out[i] = matrix * in[i], for blocks * 8 points, in and out may be the same
+	void TransformPoints(const glm::mat4& matrix, const Vec4x8* in, Vec4x8* out, size_t blocks);
+	//out[i] = a[i] * b[i]
+	void MultiplyMatrices(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count);
+	//out[i] = viewProjection * models[i], the model view projection matrix of every object at once
+	void ComputeMvps(const glm::mat4& viewProjection, const glm::mat4* models, glm::mat4* out, size_t count);
+
+}
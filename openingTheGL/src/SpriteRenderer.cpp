@@ -0,0 +1,169 @@
+#include "SpriteRenderer.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "VertexBufferLayout.h"
+
+SpriteRenderer::SpriteRenderer(unsigned int batchSize, const std::string& shaderPath)
+	: m_BatchSize(std::max(1u, batchSize)), m_ViewProjection(1.0f), m_BatchCount(0)
+{
+	m_Shader = std::make_unique<Shader>(shaderPath);
+	m_VertexBuffer = std::make_unique<VertexBuffer>((unsigned int)(m_BatchSize * 4 * sizeof(SpriteVertex)));
+	m_VertexArray = std::make_unique<VertexArray>();
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(2);
+	layout.Push<unsigned char>(4);
+	m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
+
+	//the same two triangles for every quad, made once for a full batch
+	std::vector<unsigned int> indices(m_BatchSize * 6);
+	for (unsigned int i = 0; i < m_BatchSize; i++)
+	{
+		unsigned int quad[] = { 0, 1, 2, 2, 3, 0 };
+		for (unsigned int j = 0; j < 6; j++)
+			indices[i * 6 + j] = i * 4 + quad[j];
+	}
+	//bound while the vertex array is, so it becomes part of its state
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+
+	m_Vertices.resize(m_BatchSize * 4);
+}
+
+SpriteRenderer::~SpriteRenderer()
+{
+}
+
+void SpriteRenderer::Begin(const glm::mat4& viewProjection)
+{
+	m_ViewProjection = viewProjection;
+	m_Sprites.clear();
+	m_Keys.clear();
+	m_Textures.clear();
+}
+
+void SpriteRenderer::Draw(const Texture& texture, const glm::vec2& position, const glm::vec2& size, float depth, unsigned int layer,
+	const glm::vec4& uv, const glm::vec4& color)
+{
+	glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+	uint32_t packed = (uint32_t)clamped.r | (uint32_t)clamped.g << 8 | (uint32_t)clamped.b << 16 | (uint32_t)clamped.a << 24;
+
+	//farther sprites get smaller keys so they come first
+	uint32_t inverseDepth = 65535u - (uint32_t)(glm::clamp(depth, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	//more than 256 textures in a frame only batch worse, the texture is compared again when drawing
+	uint32_t key = std::min(layer, 255u) << 24 | inverseDepth << 8 | (GetTextureIndex(&texture) & 0xFF);
+
+	m_Keys.push_back((uint64_t)key << 32 | (uint32_t)m_Sprites.size());
+	m_Sprites.push_back({ position, size, uv, packed, &texture });
+}
+
+void SpriteRenderer::End()
+{
+	Sort();
+	Flush();
+}
+
+void SpriteRenderer::Sort()
+{
+	RadixSort(m_Keys, m_SortScratch);
+}
+
+void SpriteRenderer::Flush()
+{
+	m_BatchCount = 0;
+	if (m_Keys.empty())
+		return;
+
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4f("u_ViewProjection", m_ViewProjection);
+	m_Shader->SetUniform1i("u_Texture", 0);
+	m_VertexArray->Bind();
+
+	const Texture* batchTexture = m_Sprites[(uint32_t)m_Keys[0]].SpriteTexture;
+	unsigned int batchCount = 0;
+	for (uint64_t key : m_Keys)
+	{
+		const SpriteData& sprite = m_Sprites[(uint32_t)key];
+		if (sprite.SpriteTexture != batchTexture || batchCount == m_BatchSize)
+		{
+			DrawBatch(batchTexture, batchCount);
+			batchTexture = sprite.SpriteTexture;
+			batchCount = 0;
+		}
+
+		//counter clockwise from the lower left corner, like the index pattern expects
+		SpriteVertex* vertex = &m_Vertices[batchCount * 4];
+		float x0 = sprite.Position.x, y0 = sprite.Position.y;
+		float x1 = x0 + sprite.Size.x, y1 = y0 + sprite.Size.y;
+		vertex[0] = { x0, y0, sprite.UV.x, sprite.UV.y, sprite.Color };
+		vertex[1] = { x1, y0, sprite.UV.z, sprite.UV.y, sprite.Color };
+		vertex[2] = { x1, y1, sprite.UV.z, sprite.UV.w, sprite.Color };
+		vertex[3] = { x0, y1, sprite.UV.x, sprite.UV.w, sprite.Color };
+		batchCount++;
+	}
+	DrawBatch(batchTexture, batchCount);
+}
+
+unsigned int SpriteRenderer::GetTextureIndex(const Texture* texture)
+{
+	//sprites usually come in runs of the same texture, and a frame has few of them
+	if (!m_Textures.empty() && m_Textures.back() == texture)
+		return (unsigned int)m_Textures.size() - 1;
+	auto found = std::find(m_Textures.begin(), m_Textures.end(), texture);
+	if (found != m_Textures.end())
+		return (unsigned int)(found - m_Textures.begin());
+	m_Textures.push_back(texture);
+	return (unsigned int)m_Textures.size() - 1;
+}
+
+void SpriteRenderer::DrawBatch(const Texture* texture, unsigned int spriteCount)
+{
+	if (spriteCount == 0)
+		return;
+
+	texture->Bind(0);
+	m_VertexBuffer->SetData(m_Vertices.data(), (unsigned int)(spriteCount * 4 * sizeof(SpriteVertex)));
+	GLCall(glDrawElements(GL_TRIANGLES, spriteCount * 6, GL_UNSIGNED_INT, nullptr));
+	RenderStats::Add(RenderStats::DrawCalls);
+	RenderStats::Add(RenderStats::Triangles, spriteCount * 2);
+	m_BatchCount++;
+}
+
+void SpriteRenderer::RadixSort(std::vector<uint64_t>& values, std::vector<uint64_t>& scratch)
+{
+	size_t count = values.size();
+	if (count < 2)
+		return;
+	scratch.resize(count);
+
+	//the histograms of all 4 key bytes in one pass over the data
+	size_t histograms[4][256] = {};
+	for (uint64_t value : values)
+		for (unsigned int byte = 0; byte < 4; byte++)
+			histograms[byte][(value >> (32 + byte * 8)) & 0xFF]++;
+
+	for (unsigned int byte = 0; byte < 4; byte++)
+	{
+		size_t* histogram = histograms[byte];
+		//every value has the same byte here (one layer, one texture...), this pass would not move anything
+		if (histogram[(values[0] >> (32 + byte * 8)) & 0xFF] == count)
+			continue;
+
+		//counts to the first output position of every byte value
+		size_t offset = 0;
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			size_t bucket = histogram[i];
+			histogram[i] = offset;
+			offset += bucket;
+		}
+
+		unsigned int shift = 32 + byte * 8;
+		for (uint64_t value : values)
+			scratch[histogram[(value >> shift) & 0xFF]++] = value;
+		values.swap(scratch);
+	}
+}
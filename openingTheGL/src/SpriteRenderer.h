@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class Texture;
+class Shader;
+class VertexArray;
+class VertexBuffer;
+class IndexBuffer;
+
+//Draws textured, tinted quads in batches, sorted back to front so alpha blending is right without a depth buffer
+//
+//Sprites are queued between Begin and End, End sorts them and draws every run of consecutive sprites sharing a texture
+//with one glDrawElements, out of a vertex buffer that is refilled for each batch.
+//The order is: layer (higher layers over lower ones), then depth (1 is farthest and drawn first), then texture, then the order Draw was called in.
+//The sort is an LSD radix sort on a 32 bit key (layer 8, depth 16, texture 8 bits), bytes every sprite has in common are skipped.
+//
+//Sprites on the same layer and depth are grouped by texture so they batch, give overlapping sprites different depths if their order matters.
+//Put many sprites on one atlas Texture with a uv rectangle each: a new texture ends the batch.
+//Expects blending to be enabled (glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)) and texture unit 0 to be free.
+class SpriteRenderer
+{
+public:
+	//batchSize: the most sprites one draw call takes, the vertex buffer holds that many
+	SpriteRenderer(unsigned int batchSize = 16384, const std::string& shaderPath = "res/shaders/Sprite.shader");
+	~SpriteRenderer();
+
+	//starts a new frame of sprites, the previous ones are dropped
+	void Begin(const glm::mat4& viewProjection);
+	//position is the lower left corner, depth is clamped to [0, 1], uv is (u0, v0, u1, v1) of the texture, color tints it
+	void Draw(const Texture& texture, const glm::vec2& position, const glm::vec2& size, float depth, unsigned int layer = 0,
+		const glm::vec4& uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), const glm::vec4& color = glm::vec4(1.0f));
+	//Sort() then Flush()
+	void End();
+
+	//the two halves of End, separate to time them
+	void Sort();
+	//GL thread, draws in the order of the last Sort()
+	void Flush();
+
+	inline unsigned int GetSpriteCount() const { return (unsigned int)m_Sprites.size(); }
+	//draw calls of the last Flush
+	inline unsigned int GetBatchCount() const { return m_BatchCount; }
+
+	//stable sort by the upper 32 bits, up to 4 passes of 8 bits, scratch is swapped in and out of values and ends up holding garbage
+	static void RadixSort(std::vector<uint64_t>& values, std::vector<uint64_t>& scratch);
+
+private:
+	struct SpriteData
+	{
+		glm::vec2 Position;
+		glm::vec2 Size;
+		glm::vec4 UV;
+		uint32_t Color;
+		const Texture* SpriteTexture;
+	};
+
+	struct SpriteVertex
+	{
+		float X, Y;
+		float U, V;
+		//RGBA8, normalized by the vertex layout
+		uint32_t Color;
+	};
+
+	unsigned int m_BatchSize;
+	std::unique_ptr<Shader> m_Shader;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<VertexArray> m_VertexArray;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+	glm::mat4 m_ViewProjection;
+	std::vector<SpriteData> m_Sprites;
+	//sort key in the upper 32 bits, sprite index in the lower ones: sorting them sorts the sprites and keeps them stable
+	std::vector<uint64_t> m_Keys;
+	std::vector<uint64_t> m_SortScratch;
+	std::vector<SpriteVertex> m_Vertices;
+	//textures of this frame, their index goes in the key
+	std::vector<const Texture*> m_Textures;
+	unsigned int m_BatchCount;
+
+	unsigned int GetTextureIndex(const Texture* texture);
+	void DrawBatch(const Texture* texture, unsigned int spriteCount);
+};
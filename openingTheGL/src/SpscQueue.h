@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+
+//Lock-free queue for exactly one producer thread and one consumer thread
+//Capacity has to be a power of two, the queue holds at most Capacity items
+//Head and tail live on their own cache lines so the two threads don't keep stealing the line from each other
+template<typename T, unsigned int Capacity>
+class SpscQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+	SpscQueue()
+		: m_Head(0), m_Tail(0) {}
+
+	//producer only, returns false when full
+	bool Push(const T& item)
+	{
+		unsigned int tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		m_Items[tail & (Capacity - 1)] = item;
+		//publish the item before the new tail
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//consumer only, returns false when empty
+	bool Pop(T& item)
+	{
+		unsigned int head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return false;
+
+		item = m_Items[head & (Capacity - 1)];
+		//hand the slot back to the producer only after the item was read
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	inline bool IsEmpty() const { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+
+private:
+	alignas(64) std::atomic<unsigned int> m_Head;
+	alignas(64) std::atomic<unsigned int> m_Tail;
+	alignas(64) T m_Items[Capacity];
+};
@@ -0,0 +1,153 @@
+#include "TextRenderer.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+#include "SdfFont.h"
+#include "VertexBufferLayout.h"
+
+//the next codepoint of a UTF-8 string, malformed bytes come out as U+FFFD one at a time
+static unsigned int DecodeUtf8(const std::string& text, size_t& i)
+{
+	unsigned char lead = (unsigned char)text[i++];
+	if (lead < 0x80)
+		return lead;
+
+	unsigned int length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+	if (length == 0 || i + length > text.size())
+		return 0xFFFD;
+	unsigned int codepoint = lead & (0x3F >> length);
+	for (unsigned int j = 0; j < length; j++)
+	{
+		unsigned char next = (unsigned char)text[i + j];
+		if ((next & 0xC0) != 0x80)
+			return 0xFFFD;
+		codepoint = codepoint << 6 | (next & 0x3F);
+	}
+	i += length;
+	return codepoint;
+}
+
+TextRenderer::TextRenderer(unsigned int batchSize, const std::string& shaderPath)
+	: m_BatchSize(std::max(1u, batchSize)), m_ViewProjection(1.0f), m_Pending(0), m_Font(nullptr), m_GlyphCount(0), m_BatchCount(0)
+{
+	m_Shader = std::make_unique<Shader>(shaderPath);
+	m_VertexBuffer = std::make_unique<VertexBuffer>((unsigned int)(m_BatchSize * 4 * sizeof(GlyphVertex)));
+	m_VertexArray = std::make_unique<VertexArray>();
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(2);
+	layout.Push<unsigned char>(4);
+	m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
+
+	std::vector<unsigned int> indices(m_BatchSize * 6);
+	for (unsigned int i = 0; i < m_BatchSize; i++)
+	{
+		unsigned int quad[] = { 0, 1, 2, 2, 3, 0 };
+		for (unsigned int j = 0; j < 6; j++)
+			indices[i * 6 + j] = i * 4 + quad[j];
+	}
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+
+	m_Vertices.resize(m_BatchSize * 4);
+}
+
+TextRenderer::~TextRenderer()
+{
+}
+
+void TextRenderer::Begin(const glm::mat4& viewProjection)
+{
+	m_ViewProjection = viewProjection;
+	m_Pending = 0;
+	m_Font = nullptr;
+	m_GlyphCount = 0;
+	m_BatchCount = 0;
+}
+
+float TextRenderer::Draw(SdfFont& font, const std::string& text, const glm::vec2& position, float size, const glm::vec4& color)
+{
+	if (&font != m_Font)
+	{
+		Flush();
+		m_Font = &font;
+	}
+
+	glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+	uint32_t packed = (uint32_t)clamped.r | (uint32_t)clamped.g << 8 | (uint32_t)clamped.b << 16 | (uint32_t)clamped.a << 24;
+
+	glm::vec2 pen = position;
+	float widest = 0.0f;
+	unsigned int previous = 0;
+	bool hasPrevious = false;
+
+	for (size_t i = 0; i < text.size();)
+	{
+		unsigned int codepoint = DecodeUtf8(text, i);
+		if (codepoint == '\n')
+		{
+			widest = std::max(widest, pen.x - position.x);
+			pen = glm::vec2(position.x, pen.y - font.GetLineHeight() * size);
+			hasPrevious = false;
+			continue;
+		}
+		if (codepoint == '\r')
+			continue;
+
+		if (hasPrevious)
+			pen.x += font.GetKerning(previous, codepoint) * size;
+		//after the kerning, it can add glyphs and move this one
+		const SdfFont::Glyph& glyph = font.GetGlyph(codepoint);
+
+		if (glyph.Bounds.z > glyph.Bounds.x)
+		{
+			if (m_Pending == m_BatchSize)
+				Flush();
+
+			float x0 = pen.x + glyph.Bounds.x * size, y0 = pen.y + glyph.Bounds.y * size;
+			float x1 = pen.x + glyph.Bounds.z * size, y1 = pen.y + glyph.Bounds.w * size;
+			//the atlas has the top row of a glyph at v0
+			GlyphVertex* vertex = &m_Vertices[m_Pending * 4];
+			vertex[0] = { x0, y0, glyph.UV.x, glyph.UV.w, packed };
+			vertex[1] = { x1, y0, glyph.UV.z, glyph.UV.w, packed };
+			vertex[2] = { x1, y1, glyph.UV.z, glyph.UV.y, packed };
+			vertex[3] = { x0, y1, glyph.UV.x, glyph.UV.y, packed };
+			m_Pending++;
+			m_GlyphCount++;
+		}
+
+		pen.x += glyph.Advance * size;
+		previous = codepoint;
+		hasPrevious = true;
+	}
+	return std::max(widest, pen.x - position.x);
+}
+
+void TextRenderer::End()
+{
+	Flush();
+	m_Font = nullptr;
+}
+
+void TextRenderer::Flush()
+{
+	if (m_Pending == 0 || !m_Font)
+		return;
+
+	//the glyphs added since the last batch
+	m_Font->Upload();
+	m_Font->Bind(0);
+
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4f("u_ViewProjection", m_ViewProjection);
+	m_Shader->SetUniform1i("u_Atlas", 0);
+	m_VertexArray->Bind();
+	m_VertexBuffer->SetData(m_Vertices.data(), (unsigned int)(m_Pending * 4 * sizeof(GlyphVertex)));
+	GLCall(glDrawElements(GL_TRIANGLES, m_Pending * 6, GL_UNSIGNED_INT, nullptr));
+	RenderStats::Add(RenderStats::DrawCalls);
+	RenderStats::Add(RenderStats::Triangles, m_Pending * 2);
+
+	m_BatchCount++;
+	m_Pending = 0;
+}
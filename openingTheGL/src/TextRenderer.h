@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class SdfFont;
+class Shader;
+class VertexArray;
+class VertexBuffer;
+class IndexBuffer;
+
+//Draws text with SdfFont glyph atlases, as batches of glyph quads out of one dynamic vertex buffer
+//
+//Text is laid out into the batch as Draw is called (UTF-8, kerning, '\n' starts a new line), the batch is drawn
+//when it is full, when the font changes and at End. Glyphs the font doesn't have yet are added to its atlas on the way,
+//and the atlas rows they went into are uploaded before the batch that uses them.
+//Like SpriteRenderer it expects alpha blending to be enabled and texture unit 0 to be free.
+class TextRenderer
+{
+public:
+	//batchSize: the most glyphs one draw call takes
+	TextRenderer(unsigned int batchSize = 16384, const std::string& shaderPath = "res/shaders/Text.shader");
+	~TextRenderer();
+
+	//GL thread, everything between Begin and End
+	void Begin(const glm::mat4& viewProjection);
+	//position is the start of the first baseline, size the font size in world units, returns the width of the widest line
+	float Draw(SdfFont& font, const std::string& text, const glm::vec2& position, float size, const glm::vec4& color = glm::vec4(1.0f));
+	void End();
+
+	//glyph quads and draw calls since Begin
+	inline unsigned int GetGlyphCount() const { return m_GlyphCount; }
+	inline unsigned int GetBatchCount() const { return m_BatchCount; }
+
+private:
+	struct GlyphVertex
+	{
+		float X, Y;
+		float U, V;
+		uint32_t Color;
+	};
+
+	unsigned int m_BatchSize;
+	std::unique_ptr<Shader> m_Shader;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<VertexArray> m_VertexArray;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+	glm::mat4 m_ViewProjection;
+	std::vector<GlyphVertex> m_Vertices;
+	//glyphs in m_Vertices and the font they are from
+	unsigned int m_Pending;
+	SdfFont* m_Font;
+
+	unsigned int m_GlyphCount;
+	unsigned int m_BatchCount;
+
+	void Flush();
+};
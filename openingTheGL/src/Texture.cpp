@@ -26,6 +26,8 @@ Texture::Texture(const std::string& path)
 	//basically loading into opengl, aka gpu mem
 	//http://docs.gl/gl4/glTexImage2D
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+	if (m_LocalBuffer)
+		RenderStats::Add(RenderStats::TextureBytesUploaded, (uint64_t)m_Width * m_Height * 4);
 
 	//unbind texture
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
@@ -47,6 +49,7 @@ void Texture::Bind(unsigned int slot) const
 	//then set the texture to the active slot
 	//use a named texture
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Add(RenderStats::TextureBinds);
 }
 
 void Texture::Unbind() const
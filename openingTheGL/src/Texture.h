@@ -13,6 +13,7 @@ public:
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Width; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 
 private:
 	unsigned int m_RendererID;
@@ -0,0 +1,163 @@
+#include "Tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Renderer.h"
+#include "Texture.h"
+
+Tilemap::Tilemap(unsigned int width, unsigned int height, float tileSize, const std::string& shaderPath)
+	: m_Width(width), m_Height(height), m_ChunksX((width + ChunkSize - 1) / ChunkSize), m_ChunksY((height + ChunkSize - 1) / ChunkSize),
+	m_TileSize(tileSize), m_Tileset(nullptr), m_TilesetColumns(1), m_TilesetRows(1), m_UploadedChunks(0), m_DrawnChunks(0)
+{
+	unsigned int chunkCount = m_ChunksX * m_ChunksY;
+	m_Tiles.assign((size_t)chunkCount * ChunkTiles, 0);
+	m_ChunkTileCounts.assign(chunkCount, 0);
+	m_ChunkDirty.assign(chunkCount, false);
+
+	m_Shader = std::make_unique<Shader>(shaderPath);
+	m_ChunkOriginLocation = m_Shader->GetUniformLocation("u_ChunkOrigin");
+
+	//all empty, uploaded once here so the buffer never holds undefined data
+	m_VertexBuffer = std::make_unique<VertexBuffer>(m_Tiles.data(), (unsigned int)(m_Tiles.size() * sizeof(uint16_t)));
+	//the attribute pointer moves to the drawn chunk every draw, only its format and the divisor are set up here
+	m_VertexArray = std::make_unique<VertexArray>();
+	m_VertexArray->Bind();
+	m_VertexBuffer->Bind();
+	GLCall(glEnableVertexAttribArray(0));
+	GLCall(glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_FALSE, 0, nullptr));
+	//one tile index per instance, not per vertex
+	//http://docs.gl/gl4/glVertexAttribDivisor
+	GLCall(glVertexAttribDivisor(0, 1));
+	m_VertexArray->UnBind();
+}
+
+Tilemap::~Tilemap()
+{
+}
+
+void Tilemap::SetTile(unsigned int x, unsigned int y, uint16_t tile)
+{
+	ASSERT(x < m_Width && y < m_Height);
+	uint16_t& current = m_Tiles[GetTileIndex(x, y)];
+	if (current == tile)
+		return;
+
+	unsigned int chunk = (y / ChunkSize) * m_ChunksX + x / ChunkSize;
+	if (current == 0)
+		m_ChunkTileCounts[chunk]++;
+	else if (tile == 0)
+		m_ChunkTileCounts[chunk]--;
+	current = tile;
+
+	if (!m_ChunkDirty[chunk])
+	{
+		m_ChunkDirty[chunk] = true;
+		m_DirtyChunks.push_back(chunk);
+	}
+}
+
+uint16_t Tilemap::GetTile(unsigned int x, unsigned int y) const
+{
+	ASSERT(x < m_Width && y < m_Height);
+	return m_Tiles[GetTileIndex(x, y)];
+}
+
+void Tilemap::Invalidate()
+{
+	m_DirtyChunks.clear();
+	for (unsigned int chunk = 0; chunk < GetChunkCount(); chunk++)
+	{
+		m_ChunkDirty[chunk] = true;
+		m_DirtyChunks.push_back(chunk);
+	}
+}
+
+void Tilemap::SetTileset(const Texture* texture, unsigned int columns, unsigned int rows)
+{
+	m_Tileset = texture;
+	m_TilesetColumns = std::max(1u, columns);
+	m_TilesetRows = std::max(1u, rows);
+}
+
+void Tilemap::Upload()
+{
+	m_UploadedChunks = (unsigned int)m_DirtyChunks.size();
+	if (m_DirtyChunks.empty())
+		return;
+
+	//chunks next to each other in the buffer go up in one call
+	std::sort(m_DirtyChunks.begin(), m_DirtyChunks.end());
+	const unsigned int chunkBytes = ChunkTiles * sizeof(uint16_t);
+	for (size_t first = 0; first < m_DirtyChunks.size();)
+	{
+		size_t end = first + 1;
+		while (end < m_DirtyChunks.size() && m_DirtyChunks[end] == m_DirtyChunks[end - 1] + 1)
+			end++;
+
+		unsigned int chunk = m_DirtyChunks[first];
+		m_VertexBuffer->SetSubData(chunk * chunkBytes, &m_Tiles[(size_t)chunk * ChunkTiles], (unsigned int)(end - first) * chunkBytes);
+		for (size_t i = first; i < end; i++)
+			m_ChunkDirty[m_DirtyChunks[i]] = false;
+		first = end;
+	}
+	m_DirtyChunks.clear();
+}
+
+void Tilemap::Draw(const glm::mat4& viewProjection)
+{
+	m_DrawnChunks = 0;
+	if (!m_Tileset || GetChunkCount() == 0)
+		return;
+
+	//the world rectangle the camera sees: the corners of clip space taken back through the inverse
+	glm::mat4 inverse = glm::inverse(viewProjection);
+	glm::vec2 viewMin(INFINITY), viewMax(-INFINITY);
+	for (float x : { -1.0f, 1.0f })
+		for (float y : { -1.0f, 1.0f })
+		{
+			glm::vec4 corner = inverse * glm::vec4(x, y, 0.0f, 1.0f);
+			glm::vec2 world = glm::vec2(corner) / corner.w;
+			viewMin = glm::min(viewMin, world);
+			viewMax = glm::max(viewMax, world);
+		}
+
+	float chunkWorldSize = ChunkSize * m_TileSize;
+	glm::vec2 mapSize = glm::vec2(m_ChunksX, m_ChunksY) * chunkWorldSize;
+	if (viewMax.x < 0.0f || viewMax.y < 0.0f || viewMin.x >= mapSize.x || viewMin.y >= mapSize.y)
+		return;
+	unsigned int firstX = (unsigned int)std::max(0.0f, std::floor(viewMin.x / chunkWorldSize));
+	unsigned int firstY = (unsigned int)std::max(0.0f, std::floor(viewMin.y / chunkWorldSize));
+	unsigned int lastX = std::min(m_ChunksX - 1, (unsigned int)std::floor(viewMax.x / chunkWorldSize));
+	unsigned int lastY = std::min(m_ChunksY - 1, (unsigned int)std::floor(viewMax.y / chunkWorldSize));
+
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4f("u_ViewProjection", viewProjection);
+	m_Shader->SetUniform1f("u_TileSize", m_TileSize);
+	m_Shader->SetUniform1i("u_ChunkSize", (int)ChunkSize);
+	m_Shader->SetUniform2f("u_TilesetGrid", (float)m_TilesetColumns, (float)m_TilesetRows);
+	m_Shader->SetUniform1i("u_Texture", 0);
+	m_Tileset->Bind(0);
+	m_VertexArray->Bind();
+	m_VertexBuffer->Bind();
+
+	for (unsigned int chunkY = firstY; chunkY <= lastY; chunkY++)
+		for (unsigned int chunkX = firstX; chunkX <= lastX; chunkX++)
+		{
+			unsigned int chunk = chunkY * m_ChunksX + chunkX;
+			if (m_ChunkTileCounts[chunk] == 0)
+				continue;
+
+			GLCall(glUniform2f(m_ChunkOriginLocation, chunkX * chunkWorldSize, chunkY * chunkWorldSize));
+			//the instances of this draw start at the chunk's tiles
+			uintptr_t offset = (uintptr_t)chunk * ChunkTiles * sizeof(uint16_t);
+			GLCall(glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_FALSE, 0, (const void*)offset));
+			//http://docs.gl/gl4/glDrawArraysInstanced
+			GLCall(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, ChunkTiles));
+			RenderStats::Add(RenderStats::UniformUploads);
+			RenderStats::Add(RenderStats::DrawCalls);
+			RenderStats::Add(RenderStats::Triangles, m_ChunkTileCounts[chunk] * 2);
+			m_DrawnChunks++;
+		}
+}
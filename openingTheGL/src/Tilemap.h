@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class Texture;
+class Shader;
+class VertexArray;
+class VertexBuffer;
+
+//A large grid of tiles from one tileset texture, split in chunks of ChunkSize x ChunkSize tiles
+//
+//All chunks live in one vertex buffer, one 16 bit tile index per tile, drawn as one instanced strip per chunk:
+//the shader makes the quad from the instance number and the chunk origin, so a 4096 x 4096 map is 32 MB on each side.
+//The tiles are stored chunk by chunk on the CPU as well, a changed chunk is uploaded straight from there.
+//
+//SetTile only marks its chunk, Upload sends the marked ones (neighbours in one call) and Draw skips empty chunks and
+//the ones outside the camera. The map starts at world (0, 0) and grows to +x, +y, a tile is tileSize world units wide.
+class Tilemap
+{
+public:
+	static const unsigned int ChunkSize = 32;
+	static const unsigned int ChunkTiles = ChunkSize * ChunkSize;
+
+	//GL thread, width and height in tiles
+	Tilemap(unsigned int width, unsigned int height, float tileSize, const std::string& shaderPath = "res/shaders/Tilemap.shader");
+	~Tilemap();
+
+	//tile 0 is empty, tile 1 is the top left of the tileset, counted row by row
+	void SetTile(unsigned int x, unsigned int y, uint16_t tile);
+	uint16_t GetTile(unsigned int x, unsigned int y) const;
+	//marks every chunk, after filling the whole map for example
+	void Invalidate();
+
+	//columns x rows tiles, not owned
+	void SetTileset(const Texture* texture, unsigned int columns, unsigned int rows);
+
+	//GL thread, uploads the chunks changed since the last call
+	void Upload();
+	//GL thread, draws the chunks overlapping what an orthographic viewProjection sees
+	//call Upload first, chunks that are still marked are drawn with their old tiles
+	void Draw(const glm::mat4& viewProjection);
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetChunkCount() const { return m_ChunksX * m_ChunksY; }
+	//of the last Upload
+	inline unsigned int GetUploadedChunks() const { return m_UploadedChunks; }
+	inline uint64_t GetUploadedBytes() const { return (uint64_t)m_UploadedChunks * ChunkTiles * sizeof(uint16_t); }
+	//of the last Draw
+	inline unsigned int GetDrawnChunks() const { return m_DrawnChunks; }
+
+private:
+	unsigned int m_Width, m_Height;
+	unsigned int m_ChunksX, m_ChunksY;
+	float m_TileSize;
+
+	//chunk after chunk, row by row inside a chunk
+	std::vector<uint16_t> m_Tiles;
+	//tiles that aren't 0, per chunk, empty chunks are not drawn
+	std::vector<uint16_t> m_ChunkTileCounts;
+	std::vector<bool> m_ChunkDirty;
+	std::vector<unsigned int> m_DirtyChunks;
+
+	std::unique_ptr<Shader> m_Shader;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<VertexArray> m_VertexArray;
+	int m_ChunkOriginLocation;
+
+	const Texture* m_Tileset;
+	unsigned int m_TilesetColumns, m_TilesetRows;
+
+	unsigned int m_UploadedChunks;
+	unsigned int m_DrawnChunks;
+
+	inline size_t GetTileIndex(unsigned int x, unsigned int y) const
+	{
+		unsigned int chunk = (y / ChunkSize) * m_ChunksX + x / ChunkSize;
+		return (size_t)chunk * ChunkTiles + (y % ChunkSize) * ChunkSize + x % ChunkSize;
+	}
+};
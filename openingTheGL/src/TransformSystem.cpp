@@ -0,0 +1,166 @@
+#include "TransformSystem.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+TransformSystem::TransformSystem()
+	: m_NeedsSort(false), m_AnyDirty(false), m_ParallelThreshold(8192), m_Jobs(nullptr), m_UpdatedCount(0)
+{
+}
+
+TransformSystem::Handle TransformSystem::Create(Handle parent)
+{
+	Handle handle = (Handle)m_Handles.size();
+	unsigned int index = (unsigned int)m_Parents.size();
+
+	m_Positions.push_back(glm::vec3(0.0f));
+	m_Rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	m_Scales.push_back(glm::vec3(1.0f));
+	m_Parents.push_back(parent == InvalidHandle ? -1 : (int)m_Indices[parent]);
+	m_WorldMatrices.push_back(glm::mat4(1.0f));
+	m_Dirty.push_back(1);
+	m_Updated.push_back(0);
+	m_Indices.push_back(index);
+	m_Handles.push_back(handle);
+
+	//the new node is after its parent but may be on a lower level than the nodes before it
+	m_NeedsSort = true;
+	m_AnyDirty = true;
+	return handle;
+}
+
+void TransformSystem::MarkDirty(Handle handle)
+{
+	m_Dirty[m_Indices[handle]] = 1;
+	m_AnyDirty = true;
+}
+
+void TransformSystem::SetPosition(Handle handle, const glm::vec3& position)
+{
+	m_Positions[m_Indices[handle]] = position;
+	MarkDirty(handle);
+}
+
+void TransformSystem::SetRotation(Handle handle, const glm::quat& rotation)
+{
+	m_Rotations[m_Indices[handle]] = rotation;
+	MarkDirty(handle);
+}
+
+void TransformSystem::SetScale(Handle handle, const glm::vec3& scale)
+{
+	m_Scales[m_Indices[handle]] = scale;
+	MarkDirty(handle);
+}
+
+void TransformSystem::SortByDepth()
+{
+	unsigned int count = GetCount();
+
+	//parents are always stored before their children, so one pass gives every depth
+	std::vector<unsigned int> depths(count);
+	unsigned int maxDepth = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		depths[i] = m_Parents[i] < 0 ? 0 : depths[m_Parents[i]] + 1;
+		maxDepth = std::max(maxDepth, depths[i]);
+	}
+
+	//counting sort by depth, stable so siblings stay next to each other
+	m_LevelStarts.assign(maxDepth + 2, 0);
+	for (unsigned int i = 0; i < count; i++)
+		m_LevelStarts[depths[i] + 1]++;
+	for (unsigned int level = 1; level < m_LevelStarts.size(); level++)
+		m_LevelStarts[level] += m_LevelStarts[level - 1];
+
+	std::vector<unsigned int> newIndices(count);
+	std::vector<unsigned int> next(m_LevelStarts.begin(), m_LevelStarts.end() - 1);
+	for (unsigned int i = 0; i < count; i++)
+		newIndices[i] = next[depths[i]]++;
+
+	//move every array to the new order
+	auto reorder = [&newIndices, count](auto& values)
+	{
+		typename std::remove_reference<decltype(values)>::type sorted(count);
+		for (unsigned int i = 0; i < count; i++)
+			sorted[newIndices[i]] = values[i];
+		values.swap(sorted);
+	};
+	reorder(m_Positions);
+	reorder(m_Rotations);
+	reorder(m_Scales);
+	reorder(m_WorldMatrices);
+	reorder(m_Dirty);
+	reorder(m_Updated);
+	reorder(m_Handles);
+	reorder(m_Parents);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (m_Parents[i] >= 0)
+			m_Parents[i] = (int)newIndices[m_Parents[i]];
+		m_Indices[m_Handles[i]] = i;
+	}
+
+	m_NeedsSort = false;
+}
+
+unsigned int TransformSystem::UpdateRange(unsigned int first, unsigned int end)
+{
+	unsigned int updated = 0;
+	for (unsigned int i = first; i < end; i++)
+	{
+		int parent = m_Parents[i];
+		//the parent is on the level above, so it is already done (m_Updated is set when it moved this frame)
+		if (!m_Dirty[i] && (parent < 0 || !m_Updated[parent]))
+			continue;
+
+		//local matrix = translation * rotation * scale, built directly instead of multiplying three matrices
+		glm::mat4 local = glm::mat4_cast(m_Rotations[i]);
+		local[0] *= m_Scales[i].x;
+		local[1] *= m_Scales[i].y;
+		local[2] *= m_Scales[i].z;
+		local[3] = glm::vec4(m_Positions[i], 1.0f);
+
+		m_WorldMatrices[i] = parent < 0 ? local : m_WorldMatrices[parent] * local;
+		m_Updated[i] = 1;
+		updated++;
+	}
+	return updated;
+}
+
+void TransformSystem::Update()
+{
+	if (m_NeedsSort)
+		SortByDepth();
+
+	unsigned int count = GetCount();
+	memset(m_Updated.data(), 0, count);
+	m_UpdatedCount = 0;
+	if (!m_AnyDirty)
+		return;
+
+	for (unsigned int level = 0; level + 1 < m_LevelStarts.size(); level++)
+	{
+		unsigned int first = m_LevelStarts[level];
+		unsigned int end = m_LevelStarts[level + 1];
+		unsigned int size = end - first;
+
+		if (size < m_ParallelThreshold || !m_Jobs)
+		{
+			m_UpdatedCount += UpdateRange(first, end);
+			continue;
+		}
+
+		//nodes on one level never depend on each other, so the level is split in chunks that run as jobs
+		std::atomic<unsigned int> updated(0);
+		m_Jobs->ParallelFor(size, m_ParallelThreshold / 2, [this, first, &updated](unsigned int chunkFirst, unsigned int chunkEnd) {
+			updated += UpdateRange(first + chunkFirst, first + chunkEnd);
+		});
+		m_UpdatedCount += updated;
+	}
+
+	memset(m_Dirty.data(), 0, count);
+	m_AnyDirty = false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+class JobSystem;
+
+//Stores the transforms of every object in the scene as a structure of arrays, so that updating them
+//streams through memory instead of jumping between objects
+//
+//Nodes are kept sorted by depth in the hierarchy (all roots, then all their children, and so on),
+//so a parent is always updated before its children and every level can be split across threads.
+//Only nodes that were changed, or that have a changed ancestor, get their world matrix recomputed.
+class TransformSystem
+{
+public:
+	//Handles stay valid when the nodes are re-sorted, an index into the arrays does not
+	typedef unsigned int Handle;
+	static const Handle InvalidHandle = 0xFFFFFFFF;
+
+	TransformSystem();
+
+	//Creates a node at the origin, the parent has to exist already
+	Handle Create(Handle parent = InvalidHandle);
+
+	void SetPosition(Handle handle, const glm::vec3& position);
+	void SetRotation(Handle handle, const glm::quat& rotation);
+	void SetScale(Handle handle, const glm::vec3& scale);
+
+	inline const glm::vec3& GetPosition(Handle handle) const { return m_Positions[m_Indices[handle]]; }
+	inline const glm::quat& GetRotation(Handle handle) const { return m_Rotations[m_Indices[handle]]; }
+	inline const glm::vec3& GetScale(Handle handle) const { return m_Scales[m_Indices[handle]]; }
+
+	//world matrix as of the last Update()
+	inline const glm::mat4& GetWorldMatrix(Handle handle) const { return m_WorldMatrices[m_Indices[handle]]; }
+	//true if the world matrix changed in the last Update()
+	inline bool WasUpdated(Handle handle) const { return m_Updated[m_Indices[handle]] != 0; }
+
+	//Recomputes the world matrices of the dirty subtrees
+	void Update();
+
+	//Levels with at least this many nodes are split into jobs, without a job system everything runs on the calling thread
+	inline void SetParallelThreshold(unsigned int nodes) { m_ParallelThreshold = nodes; }
+	inline void SetJobSystem(JobSystem* jobs) { m_Jobs = jobs; }
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Parents.size(); }
+	//number of world matrices recomputed by the last Update()
+	inline unsigned int GetUpdatedCount() const { return m_UpdatedCount; }
+
+private:
+	//local transform
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::quat> m_Rotations;
+	std::vector<glm::vec3> m_Scales;
+	//index of the parent node, -1 for roots
+	std::vector<int> m_Parents;
+	std::vector<glm::mat4> m_WorldMatrices;
+	//set by the setters, cleared by Update()
+	std::vector<unsigned char> m_Dirty;
+	//set by Update() for every node it recomputed, including children of dirty nodes
+	std::vector<unsigned char> m_Updated;
+
+	//handle -> index and index -> handle
+	std::vector<unsigned int> m_Indices;
+	std::vector<Handle> m_Handles;
+
+	//first index of every depth level, with one extra entry for the end
+	std::vector<unsigned int> m_LevelStarts;
+	bool m_NeedsSort;
+	bool m_AnyDirty;
+
+	unsigned int m_ParallelThreshold;
+	JobSystem* m_Jobs;
+	unsigned int m_UpdatedCount;
+
+	void SortByDepth();
+	unsigned int UpdateRange(unsigned int first, unsigned int end);
+	void MarkDirty(Handle handle);
+};
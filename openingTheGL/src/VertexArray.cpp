@@ -13,7 +13,7 @@ VertexArray::~VertexArray()
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor)
 {
 	Bind();
 	vb.Bind();
@@ -35,6 +35,8 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 		//for example: GLCall(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0));
 		//http://docs.gl/gl4/glVertexAttribPointer
 		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
+		if (divisor)
+			GLCall(glVertexAttribDivisor(i, divisor));
 
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
@@ -46,6 +48,7 @@ void VertexArray::Bind() const
 	GLCall(glBindVertexArray(m_RendererID));
 	//after binding the vertex array, in the next set of code you are binding a vertex buffer and defining attributes' structure in the vertex buffer,
 	//Which will in turn be linked to the just created vertex array so that we can eliminate calling vertex attribute setup function every frame
+	RenderStats::Add(RenderStats::VertexArrayBinds);
 }
 
 void VertexArray::UnBind() const
@@ -10,10 +10,13 @@ public:
 	VertexArray();
 	~VertexArray();
 
-	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	//divisor 0: the attributes advance per vertex, 1: per instance of an instanced draw
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor = 0);
 	void Bind() const;
 	void UnBind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
 private:
 	unsigned int m_RendererID;
 };
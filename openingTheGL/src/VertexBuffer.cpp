@@ -2,6 +2,7 @@
 #include "Renderer.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+	: m_Size(size)
 {
 	//create a new buffer in gpu,
 	//ip1: 1 is the number of buffers to create,
@@ -16,6 +17,16 @@ VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 	//Fill Buffer with the data
 	//http://docs.gl/gl4/glBufferData
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	RenderStats::Add(RenderStats::BufferBytesUploaded, size);
+}
+
+VertexBuffer::VertexBuffer(unsigned int size)
+	: m_Size(size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	//no data yet, GL_DYNAMIC_DRAW tells the driver it is rewritten often
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
 }
 
 VertexBuffer::~VertexBuffer()
@@ -28,6 +39,7 @@ void VertexBuffer::Bind() const
 	//After creating the buffer, u need to select the buffer which is called "Binding" in opengl
 	//http://docs.gl/gl4/glBindBuffer
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	RenderStats::Add(RenderStats::BufferBinds);
 }
 
 void VertexBuffer::Unbind() const
@@ -35,4 +47,26 @@ void VertexBuffer::Unbind() const
 	//After creating the buffer, u need to select the buffer which is called "Binding" in opengl
 	//http://docs.gl/gl4/glBindBuffer
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size)
+{
+	ASSERT(size <= m_Size);
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	RenderStats::Add(RenderStats::BufferBinds);
+	//orphan: same size, no data, the draws still using the old storage keep it until they are done
+	GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW));
+	//http://docs.gl/gl4/glBufferSubData
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+	RenderStats::Add(RenderStats::BufferBytesUploaded, size);
+}
+
+void VertexBuffer::SetSubData(unsigned int offset, const void* data, unsigned int size)
+{
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	RenderStats::Add(RenderStats::BufferBinds);
+	//no orphaning here, the data that isn't replaced has to stay
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+	RenderStats::Add(RenderStats::BufferBytesUploaded, size);
+}
@@ -4,11 +4,23 @@ class VertexBuffer
 {
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	//an empty buffer of size bytes for data that changes every frame, filled with SetData
+	explicit VertexBuffer(unsigned int size);
 	~VertexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
 
+	//replaces the first size bytes (at most the size it was made with) and leaves the buffer bound
+	//the old storage is orphaned first, so the driver does not wait for draws that still read it
+	void SetData(const void* data, unsigned int size);
+	//replaces size bytes at offset and keeps the rest, for updating parts of a large buffer (binds it too)
+	void SetSubData(unsigned int offset, const void* data, unsigned int size);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size;
 };
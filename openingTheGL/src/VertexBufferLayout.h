@@ -15,6 +15,7 @@ struct VertexBufferElement
 		case GL_FLOAT: return 4;
 		case GL_UNSIGNED_INT: return 4;
 		case GL_UNSIGNED_BYTE: return 1;
+		case GL_SHORT: return 2;
 		}
 		ASSERT(false);
 		return 0;
@@ -27,27 +28,11 @@ public:
 	VertexBufferLayout()
 		: m_Stride(0) {}
 
+	//only float, unsigned int, unsigned char and short are specialized (below the class, explicit specializations can't be in it outside of MSVC)
 	template<typename T>
 	void Push(unsigned int count) {
-		static_assert(false);
-	}
-
-	template<>
-	void Push<float>(unsigned int count) {
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride +=count *  VertexBufferElement::GetSizeOfType(GL_FLOAT);
-	}
-
-	template<>
-	void Push<unsigned int>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
-	}
-
-	template<>
-	void Push<unsigned char>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+		//depends on T, so it only fires for a type without a specialization
+		static_assert(sizeof(T) == 0, "VertexBufferLayout::Push: unsupported type");
 	}
 
 	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
@@ -56,4 +41,29 @@ public:
 private:
 	std::vector<VertexBufferElement> m_Elements;
 	unsigned int m_Stride;
-};
\ No newline at end of file
+};
+
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count) {
+	m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+	m_Stride +=count *  VertexBufferElement::GetSizeOfType(GL_FLOAT);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count) {
+	m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count) {
+	m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+}
+
+//not normalized, a short of 3 is 3.0 in the shader
+template<>
+inline void VertexBufferLayout::Push<short>(unsigned int count) {
+	m_Elements.push_back({ GL_SHORT, count, GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_SHORT);
+}
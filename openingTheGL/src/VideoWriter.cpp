@@ -0,0 +1,182 @@
+#include "VideoWriter.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+VideoWriter::VideoWriter()
+	: m_Y4m(false), m_DropWhenBusy(true), m_Width(0), m_Height(0), m_Quit(false), m_WrittenFrames(0), m_DroppedFrames(0), m_ReportedWrongSize(false)
+{
+}
+
+VideoWriter::~VideoWriter()
+{
+	Close();
+}
+
+bool VideoWriter::Open(const std::string& filepath, unsigned int width, unsigned int height, bool dropWhenBusy, unsigned int framesPerSecond)
+{
+	Close();
+
+	m_Stream.open(filepath, std::ios::binary);
+	if (!m_Stream)
+	{
+		std::cout << "Could not open " << filepath << " for writing\n";
+		return false;
+	}
+
+	m_Filepath = filepath;
+	m_Width = width;
+	m_Height = height;
+	m_DropWhenBusy = dropWhenBusy;
+	m_Y4m = filepath.size() >= 4 && filepath.compare(filepath.size() - 4, 4, ".y4m") == 0;
+	m_WrittenFrames = 0;
+	m_DroppedFrames = 0;
+	m_ReportedWrongSize = false;
+
+	//https://wiki.multimedia.cx/index.php/YUV4MPEG2, C420jpeg: chroma sits between the 4 pixels it belongs to
+	if (m_Y4m)
+		m_Stream << "YUV4MPEG2 W" << width << " H" << height << " F" << framesPerSecond << ":1 Ip A1:1 C420jpeg\n";
+
+	for (unsigned int i = 0; i < QueueSize; i++)
+	{
+		m_Buffers[i].resize((size_t)width * height * 4);
+		m_Free.Push(i);
+	}
+
+	m_Quit = false;
+	m_Thread = std::thread(&VideoWriter::Loop, this);
+	return true;
+}
+
+void VideoWriter::Close()
+{
+	if (!IsOpen())
+		return;
+
+	m_Quit.store(true, std::memory_order_release);
+	m_Thread.join();
+	m_Stream.close();
+
+	unsigned int index;
+	while (m_Free.Pop(index))
+		;
+}
+
+bool VideoWriter::Write(const unsigned char* pixels, unsigned int width, unsigned int height)
+{
+	if (IsOpen() && (width != m_Width || height != m_Height))
+	{
+		if (!m_ReportedWrongSize)
+			std::cout << "VideoWriter: dropping " << width << "x" << height << " frames, " << m_Filepath << " is " << m_Width << "x" << m_Height << '\n';
+		m_ReportedWrongSize = true;
+		m_DroppedFrames++;
+		return false;
+	}
+
+	unsigned int index;
+	bool free = IsOpen() && m_Free.Pop(index);
+	while (!free && IsOpen() && !m_DropWhenBusy)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		free = m_Free.Pop(index);
+	}
+	if (!free)
+	{
+		m_DroppedFrames++;
+		return false;
+	}
+
+	std::memcpy(m_Buffers[index].data(), pixels, m_Buffers[index].size());
+	m_Filled.Push(index);
+	return true;
+}
+
+void VideoWriter::Loop()
+{
+	PROFILE_THREAD("VideoWriter");
+	while (true)
+	{
+		unsigned int index;
+		if (m_Filled.Pop(index))
+		{
+			WriteFrame(m_Buffers[index]);
+			m_Free.Push(index);
+			continue;
+		}
+
+		//everything written before the quit flag was set is in the queue by now
+		if (m_Quit.load(std::memory_order_acquire))
+		{
+			while (m_Filled.Pop(index))
+			{
+				WriteFrame(m_Buffers[index]);
+				m_Free.Push(index);
+			}
+			break;
+		}
+
+		//at 60 frames per second there is a new one every 16 ms at most, no need to spin for it
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void VideoWriter::WriteFrame(const std::vector<unsigned char>& pixels)
+{
+	PROFILE_FUNCTION();
+	const unsigned int width = m_Width;
+	const unsigned int height = m_Height;
+	//rows are flipped on the way out, files start at the top and GL at the bottom
+	auto pixel = [&](unsigned int x, unsigned int y) { return &pixels[((size_t)(height - 1 - y) * width + x) * 4]; };
+
+	if (!m_Y4m)
+	{
+		for (unsigned int y = 0; y < height; y++)
+			m_Stream.write((const char*)pixel(0, y), (std::streamsize)width * 4);
+		m_WrittenFrames.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	//BT.601 full range (what C420jpeg means), fixed point with 8 bits of fraction
+	unsigned int chromaWidth = (width + 1) / 2;
+	unsigned int chromaHeight = (height + 1) / 2;
+	size_t lumaSize = (size_t)width * height;
+	size_t chromaSize = (size_t)chromaWidth * chromaHeight;
+	m_Output.resize(lumaSize + chromaSize * 2);
+	unsigned char* luma = m_Output.data();
+	unsigned char* cb = luma + lumaSize;
+	unsigned char* cr = cb + chromaSize;
+
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++)
+		{
+			const unsigned char* p = pixel(x, y);
+			luma[(size_t)y * width + x] = (unsigned char)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+		}
+
+	//one chroma sample per 2x2 block, from the average of the block, odd sizes repeat the last row and column
+	for (unsigned int y = 0; y < chromaHeight; y++)
+		for (unsigned int x = 0; x < chromaWidth; x++)
+		{
+			unsigned int x1 = x * 2 + 1 < width ? x * 2 + 1 : x * 2;
+			unsigned int y1 = y * 2 + 1 < height ? y * 2 + 1 : y * 2;
+			const unsigned char* block[4] = { pixel(x * 2, y * 2), pixel(x1, y * 2), pixel(x * 2, y1), pixel(x1, y1) };
+			int r = 0, g = 0, b = 0;
+			for (const unsigned char* p : block)
+			{
+				r += p[0];
+				g += p[1];
+				b += p[2];
+			}
+			//the sums are 4 times the average, which the shift takes care of, pure blue and red round up to 256
+			int u = (-43 * r - 85 * g + 128 * b + 512 + (128 << 10)) >> 10;
+			int v = (128 * r - 107 * g - 21 * b + 512 + (128 << 10)) >> 10;
+			cb[(size_t)y * chromaWidth + x] = (unsigned char)(u > 255 ? 255 : u);
+			cr[(size_t)y * chromaWidth + x] = (unsigned char)(v > 255 ? 255 : v);
+		}
+
+	m_Stream << "FRAME\n";
+	m_Stream.write((const char*)m_Output.data(), (std::streamsize)m_Output.size());
+	m_WrittenFrames.fetch_add(1, std::memory_order_relaxed);
+}
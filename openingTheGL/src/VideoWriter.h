@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SpscQueue.h"
+
+//Streams frames to a file on its own thread, so converting and writing them doesn't take time from the frame
+//
+//A .y4m file is YUV4MPEG2 (4:2:0, what ffmpeg, mpv, x264 etc. read directly), anything else gets the raw RGBA8 frames one after another,
+//top row first: ffmpeg -f rawvideo -pix_fmt rgba -s WxH -r 60 -i capture.raw ...
+//
+//Write() copies the frame into one of QueueSize buffers and returns, when the disk can't keep up and all of them are full the frame is dropped,
+//or with dropWhenBusy off, Write() waits for a buffer (offline rendering, where every frame matters more than the frame rate).
+//Open, Write and Close from one thread.
+class VideoWriter
+{
+public:
+	static const unsigned int QueueSize = 4;
+
+	VideoWriter();
+	~VideoWriter();
+
+	VideoWriter(const VideoWriter&) = delete;
+	VideoWriter& operator=(const VideoWriter&) = delete;
+
+	bool Open(const std::string& filepath, unsigned int width, unsigned int height, bool dropWhenBusy = true, unsigned int framesPerSecond = 60);
+	//writes everything that is queued and closes the file
+	void Close();
+	inline bool IsOpen() const { return m_Thread.joinable(); }
+
+	//RGBA8, bottom row first like glReadPixels returns it, has to be the size given to Open(), other sizes are dropped
+	bool Write(const unsigned char* pixels, unsigned int width, unsigned int height);
+
+	inline const std::string& GetFilepath() const { return m_Filepath; }
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetWrittenFrames() const { return m_WrittenFrames.load(std::memory_order_relaxed); }
+	inline unsigned int GetDroppedFrames() const { return m_DroppedFrames; }
+
+private:
+	std::string m_Filepath;
+	std::ofstream m_Stream;
+	bool m_Y4m;
+	bool m_DropWhenBusy;
+	unsigned int m_Width;
+	unsigned int m_Height;
+
+	//buffer indices, caller -> writer thread and back
+	std::vector<unsigned char> m_Buffers[QueueSize];
+	SpscQueue<unsigned int, QueueSize> m_Filled;
+	SpscQueue<unsigned int, QueueSize> m_Free;
+	//the converted frame, writer thread only
+	std::vector<unsigned char> m_Output;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Quit;
+	std::atomic<unsigned int> m_WrittenFrames;
+	unsigned int m_DroppedFrames;
+	//frames of the wrong size are only reported once per file
+	bool m_ReportedWrongSize;
+
+	void Loop();
+	void WriteFrame(const std::vector<unsigned char>& pixels);
+};